@@ -0,0 +1,1375 @@
+#ifndef __BTREE__
+#define __BTREE__
+
+/*
+
+ -- B 树实现 --
+
+ 每个节点存放多个元素，节点大小约为几个缓存行（默认 256 字节），查找时
+ 每层只碰一个节点，节点内顺序扫描。它是 map/set 的另一种底层实现：把
+ _BTreeTag 传给 map/set 的最后一个模板参数就替换掉红黑树，接口不变
+ （btree_map.hpp、btree_set.hpp 提供别名）。
+
+ 与红黑树的区别：
+ - 元素存放在节点内的数组里，插入删除时会在节点之间挪动，任何插入和
+   删除都会使所有迭代器和引用失效；
+ - 挪动元素时移动构造再析构原元素，要求移动构造不抛异常（编译期检查）。
+   map 的元素是 pair<Key const, T>，键按非 const 移出，见 _BTreeRelocation；
+ - 没有增强策略，也就没有 nth、rank、root_node 这些接口。
+
+*/
+
+#include "_common.hpp"
+#include "_rbtree.hpp"
+#include "_relocate.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// 节点的目标大小（字节），每个节点的槽位数由它和元素大小算出
+template <std::size_t _NodeBytes = 256> struct _BTreeTag {};
+
+// 在节点间挪动元素：移动构造到新位置，原元素随即析构
+template <class _Tp> struct _BTreeRelocation {
+    static constexpr bool _S_nothrow =
+        std::is_nothrow_move_constructible_v<_Tp>;
+
+    static void _S_construct(_Tp *__src, _Tp *__dst) noexcept {
+        ::new (static_cast<void *>(__dst)) _Tp(std::move(*__src));
+    }
+};
+
+// 键是 const，std::move 会选中键的拷贝构造（std::string 键每次挪动都要
+// 深拷贝，还可能抛异常）。原元素马上就要析构，键可以当成非 const 移出
+template <class _Key, class _Mapped>
+struct _BTreeRelocation<std::pair<_Key const, _Mapped>> {
+    using _Pair = std::pair<_Key const, _Mapped>;
+
+    static constexpr bool _S_nothrow =
+        std::is_nothrow_move_constructible_v<_Key> &&
+        std::is_nothrow_move_constructible_v<_Mapped>;
+
+    static void _S_construct(_Pair *__src, _Pair *__dst) noexcept {
+        ::new (static_cast<void *>(__dst))
+            _Pair(std::move(const_cast<_Key &>(__src->first)),
+                  std::move(__src->second));
+    }
+};
+
+template <class _Tp, std::size_t _Slots> struct _BTreeInternal;
+
+template <class _Tp, std::size_t _Slots> struct _BTreeNode {
+    _BTreeNode *_M_parent;
+    std::uint16_t _M_position; // 自己是父节点的第几个子节点
+    std::uint16_t _M_count;
+    bool _M_leaf;
+    alignas(_Tp) unsigned char _M_storage[sizeof(_Tp) * _Slots];
+
+    _Tp *_M_slot(std::size_t __i) noexcept {
+        return reinterpret_cast<_Tp *>(_M_storage) + __i;
+    }
+
+    _Tp const *_M_slot(std::size_t __i) const noexcept {
+        return reinterpret_cast<_Tp const *>(_M_storage) + __i;
+    }
+
+    _BTreeNode *_M_child(std::size_t __i) const noexcept {
+        return static_cast<_BTreeInternal<_Tp, _Slots> const *>(this)
+            ->_M_children[__i];
+    }
+};
+
+// 第 i 个子节点里的元素都排在第 i 个元素之前
+template <class _Tp, std::size_t _Slots>
+struct _BTreeInternal : _BTreeNode<_Tp, _Slots> {
+    _BTreeNode<_Tp, _Slots> *_M_children[_Slots + 1];
+};
+
+// 迭代器是 (节点, 下标)。头结点没有元素、0 号子节点是根，end() 就是
+// (头结点, 0)：从最后一个元素往上走会自然停在这里，从这里往回走会
+// 自然走到最右边的叶子
+template <class _Node> struct _BTreeIteratorBase {
+  protected:
+    _Node *_M_node;
+    std::size_t _M_pos;
+
+    _BTreeIteratorBase(_Node *__node, std::size_t __pos) noexcept
+        : _M_node(__node), _M_pos(__pos) {}
+
+    template <class, class, class, std::size_t> friend struct _BTreeImpl;
+
+    // 下标越过节点末尾时往上找到下一个分隔元素，走到头结点就是 end()
+    void _M_ascend() noexcept {
+        while (_M_pos == _M_node->_M_count && _M_node->_M_parent != nullptr) {
+            _M_pos = _M_node->_M_position;
+            _M_node = _M_node->_M_parent;
+        }
+    }
+
+    void _M_increment() noexcept {
+        if (!_M_node->_M_leaf) {
+            _M_node = _M_node->_M_child(_M_pos + 1);
+            while (!_M_node->_M_leaf) {
+                _M_node = _M_node->_M_child(0);
+            }
+            _M_pos = 0;
+            return;
+        }
+        ++_M_pos;
+        this->_M_ascend();
+    }
+
+    void _M_decrement() noexcept {
+        if (!_M_node->_M_leaf) {
+            _M_node = _M_node->_M_child(_M_pos);
+            while (!_M_node->_M_leaf) {
+                _M_node = _M_node->_M_child(_M_node->_M_count);
+            }
+            _M_pos = _M_node->_M_count - 1;
+            return;
+        }
+        while (_M_pos == 0 && _M_node->_M_parent != nullptr) {
+            _M_pos = _M_node->_M_position;
+            _M_node = _M_node->_M_parent;
+        }
+        // 停在头结点时 _M_pos 为 0，即 rend()
+        if (_M_pos != 0) {
+            --_M_pos;
+        }
+    }
+
+  public:
+    bool operator==(_BTreeIteratorBase const &__that) const noexcept {
+        return _M_node == __that._M_node && _M_pos == __that._M_pos;
+    }
+
+    bool operator!=(_BTreeIteratorBase const &__that) const noexcept {
+        return !(*this == __that);
+    }
+};
+
+template <class _Node, class _Tp, bool _Reverse>
+struct _BTreeIterator : _BTreeIteratorBase<_Node> {
+  protected:
+    using _BTreeIteratorBase<_Node>::_BTreeIteratorBase;
+
+    template <class, class, class, std::size_t> friend struct _BTreeImpl;
+
+    template <class, class, bool> friend struct _BTreeIterator;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::remove_const_t<_Tp>;
+    using difference_type = std::ptrdiff_t;
+    using reference = _Tp &;
+    using pointer = _Tp *;
+
+    _BTreeIterator() noexcept : _BTreeIteratorBase<_Node>(nullptr, 0) {}
+
+    template <class T0 = _Tp>
+    explicit operator std::enable_if_t<
+        std::is_const_v<T0>,
+        _BTreeIterator<_Node, std::remove_const_t<T0>, _Reverse>>()
+        const noexcept {
+        return {this->_M_node, this->_M_pos};
+    }
+
+    template <class T0 = _Tp>
+    operator std::enable_if_t<
+        !std::is_const_v<T0>,
+        _BTreeIterator<_Node, std::add_const_t<T0>, _Reverse>>()
+        const noexcept {
+        return {this->_M_node, this->_M_pos};
+    }
+
+    _BTreeIterator &operator++() noexcept { // ++__it
+        if constexpr (_Reverse) {
+            this->_M_decrement();
+        } else {
+            this->_M_increment();
+        }
+        return *this;
+    }
+
+    _BTreeIterator &operator--() noexcept { // --__it
+        if constexpr (_Reverse) {
+            this->_M_increment();
+        } else {
+            this->_M_decrement();
+        }
+        return *this;
+    }
+
+    _BTreeIterator operator++(int) noexcept { // __it++
+        _BTreeIterator __tmp = *this;
+        ++*this;
+        return __tmp;
+    }
+
+    _BTreeIterator operator--(int) noexcept { // __it--
+        _BTreeIterator __tmp = *this;
+        --*this;
+        return __tmp;
+    }
+
+    _Tp *operator->() const noexcept {
+        assert(this->_M_pos < this->_M_node->_M_count);
+        return this->_M_node->_M_slot(this->_M_pos);
+    }
+
+    _Tp &operator*() const noexcept {
+        assert(this->_M_pos < this->_M_node->_M_count);
+        return *this->_M_node->_M_slot(this->_M_pos);
+    }
+};
+
+// 元素平铺在节点里，extract 时移进单独分配的对象，insert 时再移回节点
+template <class _Tp, class _Alloc, class = void> struct _BTreeNodeHandle {
+  protected:
+    using _Value = std::remove_const_t<_Tp>;
+    using _ValueAlloc =
+        typename std::allocator_traits<_Alloc>::template rebind_alloc<_Value>;
+
+    _Value *_M_value;
+    [[no_unique_address]] _Alloc _M_alloc;
+
+    _BTreeNodeHandle(_Value *__value, _Alloc __alloc) noexcept
+        : _M_value(__value), _M_alloc(__alloc) {}
+
+    void _M_release() noexcept {
+        if (_M_value) {
+            _M_value->~_Value();
+            _ValueAlloc __value_alloc(_M_alloc);
+            std::allocator_traits<_ValueAlloc>::deallocate(__value_alloc,
+                                                           _M_value, 1);
+            _M_value = nullptr;
+        }
+    }
+
+    template <class, class, class, std::size_t> friend struct _BTreeImpl;
+
+  public:
+    _BTreeNodeHandle() noexcept : _M_value(nullptr) {}
+
+    _BTreeNodeHandle(_BTreeNodeHandle &&__that) noexcept
+        : _M_value(__that._M_value), _M_alloc(std::move(__that._M_alloc)) {
+        __that._M_value = nullptr;
+    }
+
+    _BTreeNodeHandle &operator=(_BTreeNodeHandle &&__that) noexcept {
+        std::swap(_M_value, __that._M_value);
+        std::swap(_M_alloc, __that._M_alloc);
+        return *this;
+    }
+
+    bool empty() const noexcept { return _M_value == nullptr; }
+
+    explicit operator bool() const noexcept { return _M_value != nullptr; }
+
+    _Tp &value() const noexcept { return *_M_value; }
+
+    ~_BTreeNodeHandle() noexcept { this->_M_release(); }
+};
+
+template <class _Kv, class _Mv, class _Alloc>
+struct _BTreeNodeHandle<std::pair<_Kv const, _Mv>, _Alloc, void>
+    : _BTreeNodeHandle<std::pair<_Kv const, _Mv>, _Alloc, void *> {
+  protected:
+    using _BTreeNodeHandle<std::pair<_Kv const, _Mv>, _Alloc,
+                           void *>::_BTreeNodeHandle;
+
+    template <class, class, class, std::size_t> friend struct _BTreeImpl;
+
+  public:
+    _BTreeNodeHandle() noexcept = default;
+
+    _Kv const &key() const noexcept { return this->value().first; }
+
+    _Mv &mapped() const noexcept { return this->value().second; }
+};
+
+template <class _Tp, class _Compare, class _Alloc, std::size_t _NodeBytes>
+struct _BTreeImpl {
+  protected:
+    using _Value = std::remove_const_t<_Tp>;
+
+    // 节点头部（父指针、下标、计数）占 16 字节，其余放元素；
+    // 至少 3 个槽位，分裂后两边才都不空
+    static constexpr std::size_t _S_slots =
+        _NodeBytes >= 16 + 3 * sizeof(_Value)
+            ? (_NodeBytes - 16) / sizeof(_Value)
+            : 3;
+    static_assert(_S_slots <= 0xffff, "too many slots per node");
+    static_assert(mstl::is_trivially_relocatable_v<_Value> ||
+                      _BTreeRelocation<_Value>::_S_nothrow,
+                  "B-tree elements must be nothrow move constructible");
+
+    // 非根节点删除后少于这么多元素时，向兄弟借一个或者与兄弟合并
+    static constexpr std::size_t _S_min = (_S_slots - 1) / 2;
+
+    // 小的平凡类型在节点内不提前退出，直接数出比键小的元素个数，循环
+    // 没有分支，编译器可以向量化；其他类型逐个比较，遇到不小于的就停
+    static constexpr bool _S_count_scan =
+        std::is_trivially_copy_constructible_v<_Value> &&
+        std::is_trivially_destructible_v<_Value> && sizeof(_Value) <= 16;
+
+    // 参数恰好是一个 _Value 右值时直接移进节点，否则先构造一个临时值，
+    // 参数引用着树里的元素也不怕节点挪动
+    template <class... _Ts>
+    static constexpr bool _S_is_value =
+        sizeof...(_Ts) == 1 && (std::is_same_v<_Ts, _Value> && ...);
+
+    using _Node = _BTreeNode<_Value, _S_slots>;
+    using _Internal = _BTreeInternal<_Value, _S_slots>;
+
+    [[no_unique_address]] _Compare _M_comp;
+    [[no_unique_address]] _Alloc _M_alloc;
+    _Internal *_M_block; // 头结点，0 号子节点是根，空树时为空指针
+    std::size_t _M_size;
+
+  public:
+    using iterator = _BTreeIterator<_Node, _Tp, false>;
+    using reverse_iterator = _BTreeIterator<_Node, _Tp, true>;
+    using const_iterator = _BTreeIterator<_Node, _Tp const, false>;
+    using const_reverse_iterator = _BTreeIterator<_Node, _Tp const, true>;
+    using node_type = _BTreeNodeHandle<_Tp, _Alloc>;
+
+    _BTreeImpl() : _M_block(this->_M_new_header()), _M_size(0) {}
+
+    explicit _BTreeImpl(_Compare __comp)
+        : _M_comp(__comp), _M_block(this->_M_new_header()), _M_size(0) {}
+
+    explicit _BTreeImpl(_Alloc __alloc, _Compare __comp = _Compare())
+        : _M_comp(__comp), _M_alloc(__alloc),
+          _M_block(this->_M_new_header()), _M_size(0) {}
+
+    _BTreeImpl(_BTreeImpl &&__that) noexcept
+        : _M_comp(__that._M_comp), _M_alloc(__that._M_alloc),
+          _M_block(__that._M_block), _M_size(__that._M_size) {
+        __that._M_block = __that._M_new_header();
+        __that._M_size = 0;
+    }
+
+    _BTreeImpl &operator=(_BTreeImpl &&__that) noexcept {
+        std::swap(_M_comp, __that._M_comp);
+        std::swap(_M_block, __that._M_block);
+        std::swap(_M_size, __that._M_size);
+        return *this;
+    }
+
+    // 拷贝时源树已经有序，逐个追加在末尾，不调用比较器
+    _BTreeImpl(_BTreeImpl const &__that)
+        : _M_comp(__that._M_comp),
+          _M_alloc(std::allocator_traits<_Alloc>::
+                       select_on_container_copy_construction(
+                           __that._M_alloc)),
+          _M_block(this->_M_new_header()), _M_size(0) {
+        try {
+            this->_M_append_all(__that);
+        } catch (...) {
+            this->clear();
+            this->_M_free_node(_M_block);
+            throw;
+        }
+    }
+
+    _BTreeImpl &operator=(_BTreeImpl const &__that) {
+        if (&__that != this) {
+            this->clear();
+            _M_comp = __that._M_comp;
+            this->_M_append_all(__that);
+        }
+        return *this;
+    }
+
+    ~_BTreeImpl() noexcept {
+        this->clear();
+        this->_M_free_node(_M_block);
+    }
+
+  protected:
+    template <class _Type> _Type *_M_allocate_node() {
+        using _NodeAlloc = typename std::allocator_traits<
+            _Alloc>::template rebind_alloc<_Type>;
+        _NodeAlloc __node_alloc(_M_alloc);
+        _Type *__node =
+            std::allocator_traits<_NodeAlloc>::allocate(__node_alloc, 1);
+        return ::new (static_cast<void *>(__node)) _Type;
+    }
+
+    template <class _Type> void _M_deallocate_node(_Type *__node) noexcept {
+        using _NodeAlloc = typename std::allocator_traits<
+            _Alloc>::template rebind_alloc<_Type>;
+        _NodeAlloc __node_alloc(_M_alloc);
+        std::allocator_traits<_NodeAlloc>::deallocate(__node_alloc, __node, 1);
+    }
+
+    _Node *_M_new_node(bool __leaf) {
+        _Node *__node = __leaf ? this->template _M_allocate_node<_Node>()
+                               : this->template _M_allocate_node<_Internal>();
+        __node->_M_count = 0;
+        __node->_M_leaf = __leaf;
+        return __node;
+    }
+
+    _Internal *_M_new_header() {
+        _Internal *__header = this->template _M_allocate_node<_Internal>();
+        __header->_M_parent = nullptr;
+        __header->_M_position = 0;
+        __header->_M_count = 0;
+        __header->_M_leaf = false;
+        __header->_M_children[0] = nullptr;
+        return __header;
+    }
+
+    void _M_free_node(_Node *__node) noexcept {
+        if (__node->_M_leaf) {
+            this->_M_deallocate_node(__node);
+        } else {
+            this->_M_deallocate_node(static_cast<_Internal *>(__node));
+        }
+    }
+
+    _Node *_M_root() const noexcept { return _M_block->_M_children[0]; }
+
+    static void _S_set_child(_Node *__parent, std::size_t __i,
+                             _Node *__child) noexcept {
+        static_cast<_Internal *>(__parent)->_M_children[__i] = __child;
+        __child->_M_parent = __parent;
+        __child->_M_position = static_cast<std::uint16_t>(__i);
+    }
+
+    static void _S_relocate(_Value *__src, _Value *__dst) noexcept {
+        if constexpr (mstl::is_trivially_relocatable_v<_Value>) {
+            std::memcpy(static_cast<void *>(__dst),
+                        static_cast<void const *>(__src), sizeof(_Value));
+        } else {
+            _BTreeRelocation<_Value>::_S_construct(__src, __dst);
+            __src->~_Value();
+        }
+    }
+
+    // 把 [__first, __last) 搬到 __dest，同一节点内允许重叠
+    static void _S_relocate_range(_Value *__first, _Value *__last,
+                                  _Value *__dest) noexcept {
+        if constexpr (mstl::is_trivially_relocatable_v<_Value>) {
+            mstl::trivially_relocate(__first, __last, __dest);
+        } else if (__dest < __first) {
+            for (; __first != __last; ++__first, ++__dest) {
+                _S_relocate(__first, __dest);
+            }
+        } else {
+            __dest += __last - __first;
+            while (__last != __first) {
+                _S_relocate(--__last, --__dest);
+            }
+        }
+    }
+
+    template <class _Kv>
+    std::size_t _M_lower_index(_Node const *__node,
+                               _Kv const &__key) const noexcept {
+        _Value const *__slots = __node->_M_slot(0);
+        std::size_t __n = __node->_M_count;
+        std::size_t __i = 0;
+        if constexpr (_S_count_scan) {
+            for (std::size_t __j = 0; __j != __n; ++__j) {
+                __i += _M_comp(__slots[__j], __key);
+            }
+        } else {
+            while (__i != __n && _M_comp(__slots[__i], __key)) {
+                ++__i;
+            }
+        }
+        return __i;
+    }
+
+    template <class _Kv>
+    std::size_t _M_upper_index(_Node const *__node,
+                               _Kv const &__key) const noexcept {
+        _Value const *__slots = __node->_M_slot(0);
+        std::size_t __n = __node->_M_count;
+        std::size_t __i = 0;
+        if constexpr (_S_count_scan) {
+            for (std::size_t __j = 0; __j != __n; ++__j) {
+                __i += !_M_comp(__key, __slots[__j]);
+            }
+        } else {
+            while (__i != __n && !_M_comp(__key, __slots[__i])) {
+                ++__i;
+            }
+        }
+        return __i;
+    }
+
+    template <class _Kv>
+    iterator _M_find_pos(_Kv const &__key) const noexcept {
+        _Node *__node = this->_M_root();
+        while (__node != nullptr) {
+            std::size_t __i = this->_M_lower_index(__node, __key);
+            if (__i != __node->_M_count &&
+                !_M_comp(__key, *__node->_M_slot(__i))) {
+                return {__node, __i};
+            }
+            if (__node->_M_leaf) {
+                break;
+            }
+            __node = __node->_M_child(__i);
+        }
+        return {_M_block, 0};
+    }
+
+    // 下层的候选位置都排在上层的候选位置之前，最后记下的就是答案
+    template <bool _Upper, class _Kv>
+    iterator _M_bound_pos(_Kv const &__key) const noexcept {
+        iterator __result(_M_block, 0);
+        _Node *__node = this->_M_root();
+        while (__node != nullptr) {
+            std::size_t __i = _Upper ? this->_M_upper_index(__node, __key)
+                                     : this->_M_lower_index(__node, __key);
+            if (__i != __node->_M_count) {
+                __result = iterator(__node, __i);
+            }
+            if (__node->_M_leaf) {
+                break;
+            }
+            __node = __node->_M_child(__i);
+        }
+        return __result;
+    }
+
+    // 返回 {位置, 是否已存在}：已存在时是等价元素的位置，否则是叶子中
+    // 的插入位置；空树返回 end()
+    template <class _Kv>
+    std::pair<iterator, bool>
+    _M_find_insert_pos(_Kv const &__key) const noexcept {
+        _Node *__node = this->_M_root();
+        if (__node == nullptr) {
+            return {iterator(_M_block, 0), false};
+        }
+        for (;;) {
+            std::size_t __i = this->_M_lower_index(__node, __key);
+            if (__i != __node->_M_count &&
+                !_M_comp(__key, *__node->_M_slot(__i))) {
+                return {iterator(__node, __i), true};
+            }
+            if (__node->_M_leaf) {
+                return {iterator(__node, __i), false};
+            }
+            __node = __node->_M_child(__i);
+        }
+    }
+
+    // 等价元素的最后面（_Lower 时为最前面）
+    template <bool _Lower = false, class _Kv>
+    iterator _M_multi_insert_pos(_Kv const &__key) const noexcept {
+        _Node *__node = this->_M_root();
+        if (__node == nullptr) {
+            return {_M_block, 0};
+        }
+        for (;;) {
+            std::size_t __i = _Lower ? this->_M_lower_index(__node, __key)
+                                     : this->_M_upper_index(__node, __key);
+            if (__node->_M_leaf) {
+                return {__node, __i};
+            }
+            __node = __node->_M_child(__i);
+        }
+    }
+
+    // 插入位置在第 __pos 个槽位时左半边留几个元素。追加在末尾（或开头）
+    // 时几乎全部留在一边，顺序插入的节点是满的而不是半满
+    static std::size_t _S_split_point(std::size_t __pos) noexcept {
+        if (__pos == _S_slots) {
+            return _S_slots - 1;
+        }
+        if (__pos == 0) {
+            return 0;
+        }
+        return _S_slots / 2;
+    }
+
+    // 满节点的后半段搬到新的右兄弟 __sibling，第 __lcount 个元素升到
+    // 父节点。调用前父节点必须还有空位
+    void _M_split_node(_Node *__node, _Node *__sibling,
+                       std::size_t __lcount) noexcept {
+        _Node *__parent = __node->_M_parent;
+        std::size_t __pos = __node->_M_position;
+        std::size_t __rcount = _S_slots - __lcount - 1;
+        _S_relocate_range(__node->_M_slot(__lcount + 1),
+                          __node->_M_slot(_S_slots), __sibling->_M_slot(0));
+        if (!__node->_M_leaf) {
+            for (std::size_t __k = 0; __k <= __rcount; ++__k) {
+                _S_set_child(__sibling, __k,
+                             __node->_M_child(__lcount + 1 + __k));
+            }
+        }
+        __sibling->_M_count = static_cast<std::uint16_t>(__rcount);
+        __node->_M_count = static_cast<std::uint16_t>(__lcount);
+        std::size_t __pcount = __parent->_M_count;
+        _S_relocate_range(__parent->_M_slot(__pos),
+                          __parent->_M_slot(__pcount),
+                          __parent->_M_slot(__pos + 1));
+        _S_relocate(__node->_M_slot(__lcount), __parent->_M_slot(__pos));
+        for (std::size_t __k = __pcount; __k > __pos; --__k) {
+            _S_set_child(__parent, __k + 1, __parent->_M_child(__k));
+        }
+        _S_set_child(__parent, __pos + 1, __sibling);
+        ++__parent->_M_count;
+    }
+
+    // 叶子满了：往上数出连续满的祖先，新节点（必要时还有新根）全部先
+    // 分配好，然后从上往下依次分裂，之后都是不会失败的挪动。
+    // 返回新元素在分裂后应处的位置
+    iterator _M_split_for_insert(_Node *__leaf, std::size_t __i) {
+        _Node *__chain[64];
+        _Node *__spare[65];
+        std::size_t __levels = 0;
+        _Node *__node = __leaf;
+        while (__node != _M_block && __node->_M_count == _S_slots) {
+            assert(__levels < 64);
+            __chain[__levels++] = __node;
+            __node = __node->_M_parent;
+        }
+        bool __new_root = __node == _M_block;
+        std::size_t __count = 0;
+        try {
+            for (; __count != __levels + __new_root; ++__count) {
+                __spare[__count] = this->_M_new_node(__count == 0);
+            }
+        } catch (...) {
+            while (__count != 0) {
+                this->_M_free_node(__spare[--__count]);
+            }
+            throw;
+        }
+        if (__new_root) {
+            _Node *__root = __spare[__levels];
+            _S_set_child(__root, 0, __chain[__levels - 1]);
+            _S_set_child(_M_block, 0, __root);
+        }
+        std::size_t __lcount = _S_split_point(__i);
+        for (std::size_t __j = __levels; __j-- > 0;) {
+            std::size_t __pos =
+                __j == 0 ? __i : __chain[__j - 1]->_M_position;
+            this->_M_split_node(__chain[__j], __spare[__j],
+                                _S_split_point(__pos));
+        }
+        if (__i <= __lcount) {
+            return {__leaf, __i};
+        }
+        return {__spare[0], __i - __lcount - 1};
+    }
+
+    // 把 __value 移进叶子的 __pos 处；__pos 是 end() 表示树是空的
+    iterator _M_insert_value(iterator __pos, _Value &__value) {
+        _Node *__leaf = __pos._M_node;
+        std::size_t __i = __pos._M_pos;
+        if (__leaf == _M_block) {
+            __leaf = this->_M_new_node(true);
+            _S_set_child(_M_block, 0, __leaf);
+            __i = 0;
+        } else if (__leaf->_M_count == _S_slots) {
+            iterator __split = this->_M_split_for_insert(__leaf, __i);
+            __leaf = __split._M_node;
+            __i = __split._M_pos;
+        }
+        _Value *__slot = __leaf->_M_slot(__i);
+        _S_relocate_range(__slot, __leaf->_M_slot(__leaf->_M_count),
+                          __slot + 1);
+        ::new (static_cast<void *>(__slot)) _Value(std::move(__value));
+        ++__leaf->_M_count;
+        ++_M_size;
+        return {__leaf, __i};
+    }
+
+    template <class... _Ts>
+    iterator _M_emplace_at(iterator __pos, _Ts &&...__value) {
+        if constexpr (_S_is_value<_Ts...>) {
+            return this->_M_insert_value(__pos, __value...);
+        } else {
+            _Value __tmp(std::forward<_Ts>(__value)...);
+            return this->_M_insert_value(__pos, __tmp);
+        }
+    }
+
+    // 把 __left 右边的兄弟连同中间的分隔元素并入 __left
+    void _M_merge(_Node *__left) noexcept {
+        _Node *__parent = __left->_M_parent;
+        std::size_t __pos = __left->_M_position;
+        _Node *__right = __parent->_M_child(__pos + 1);
+        std::size_t __lcount = __left->_M_count;
+        std::size_t __rcount = __right->_M_count;
+        _S_relocate(__parent->_M_slot(__pos), __left->_M_slot(__lcount));
+        _S_relocate_range(__right->_M_slot(0), __right->_M_slot(__rcount),
+                          __left->_M_slot(__lcount + 1));
+        if (!__left->_M_leaf) {
+            for (std::size_t __k = 0; __k <= __rcount; ++__k) {
+                _S_set_child(__left, __lcount + 1 + __k,
+                             __right->_M_child(__k));
+            }
+        }
+        __left->_M_count = static_cast<std::uint16_t>(__lcount + 1 + __rcount);
+        std::size_t __pcount = __parent->_M_count;
+        _S_relocate_range(__parent->_M_slot(__pos + 1),
+                          __parent->_M_slot(__pcount),
+                          __parent->_M_slot(__pos));
+        for (std::size_t __k = __pos + 1; __k < __pcount; ++__k) {
+            _S_set_child(__parent, __k, __parent->_M_child(__k + 1));
+        }
+        --__parent->_M_count;
+        this->_M_free_node(__right);
+    }
+
+    // 分隔元素移到 __node 末尾，右兄弟的第一个元素补上分隔元素
+    void _M_borrow_right(_Node *__node) noexcept {
+        _Node *__parent = __node->_M_parent;
+        std::size_t __pos = __node->_M_position;
+        _Node *__right = __parent->_M_child(__pos + 1);
+        std::size_t __count = __node->_M_count;
+        std::size_t __rcount = __right->_M_count;
+        _S_relocate(__parent->_M_slot(__pos), __node->_M_slot(__count));
+        _S_relocate(__right->_M_slot(0), __parent->_M_slot(__pos));
+        _S_relocate_range(__right->_M_slot(1), __right->_M_slot(__rcount),
+                          __right->_M_slot(0));
+        if (!__node->_M_leaf) {
+            _S_set_child(__node, __count + 1, __right->_M_child(0));
+            for (std::size_t __k = 0; __k < __rcount; ++__k) {
+                _S_set_child(__right, __k, __right->_M_child(__k + 1));
+            }
+        }
+        ++__node->_M_count;
+        --__right->_M_count;
+    }
+
+    // 分隔元素移到 __node 开头，左兄弟的最后一个元素补上分隔元素
+    void _M_borrow_left(_Node *__node) noexcept {
+        _Node *__parent = __node->_M_parent;
+        std::size_t __pos = __node->_M_position;
+        _Node *__left = __parent->_M_child(__pos - 1);
+        std::size_t __count = __node->_M_count;
+        std::size_t __lcount = __left->_M_count;
+        _S_relocate_range(__node->_M_slot(0), __node->_M_slot(__count),
+                          __node->_M_slot(1));
+        _S_relocate(__parent->_M_slot(__pos - 1), __node->_M_slot(0));
+        _S_relocate(__left->_M_slot(__lcount - 1),
+                    __parent->_M_slot(__pos - 1));
+        if (!__node->_M_leaf) {
+            for (std::size_t __k = __count + 1; __k-- > 0;) {
+                _S_set_child(__node, __k + 1, __node->_M_child(__k));
+            }
+            _S_set_child(__node, 0, __left->_M_child(__lcount));
+        }
+        ++__node->_M_count;
+        --__left->_M_count;
+    }
+
+    // 删除后自下而上修复过少的节点。__hole 是被删元素留下的位置，
+    // 合并和借元素时跟着挪动，最终仍指向原来的后继所在处
+    iterator _M_rebalance(_Node *__node, iterator __hole) noexcept {
+        while (__node != this->_M_root() && __node->_M_count < _S_min) {
+            _Node *__parent = __node->_M_parent;
+            std::size_t __pos = __node->_M_position;
+            if (__pos > 0) {
+                _Node *__left = __parent->_M_child(__pos - 1);
+                if (__left->_M_count + 1u + __node->_M_count <= _S_slots) {
+                    if (__hole._M_node == __node) {
+                        __hole = iterator(__left, __left->_M_count + 1 +
+                                                      __hole._M_pos);
+                    }
+                    this->_M_merge(__left);
+                    __node = __parent;
+                    continue;
+                }
+            }
+            if (__pos < __parent->_M_count) {
+                _Node *__right = __parent->_M_child(__pos + 1);
+                if (__node->_M_count + 1u + __right->_M_count <= _S_slots) {
+                    this->_M_merge(__node);
+                    __node = __parent;
+                    continue;
+                }
+                this->_M_borrow_right(__node);
+                return __hole;
+            }
+            // 合并放不下，兄弟的元素一定多于 _S_min
+            if (__hole._M_node == __node) {
+                ++__hole._M_pos;
+            }
+            this->_M_borrow_left(__node);
+            return __hole;
+        }
+        _Node *__root = this->_M_root();
+        if (__root->_M_count == 0) {
+            if (__root->_M_leaf) {
+                _M_block->_M_children[0] = nullptr;
+                this->_M_free_node(__root);
+                return {_M_block, 0};
+            }
+            _S_set_child(_M_block, 0, __root->_M_child(0));
+            this->_M_free_node(__root);
+        }
+        return __hole;
+    }
+
+    // __node 的第 __i 个元素已经析构或移走，补上空位并恢复平衡，返回
+    // 原来的后继。内部节点的空位由左子树中最大的元素（一定在叶子里）
+    // 填上，于是实际删除总发生在叶子
+    iterator _M_remove_at(_Node *__node, std::size_t __i) noexcept {
+        bool __internal = !__node->_M_leaf;
+        if (__internal) {
+            _Node *__leaf = __node->_M_child(__i);
+            while (!__leaf->_M_leaf) {
+                __leaf = __leaf->_M_child(__leaf->_M_count);
+            }
+            _S_relocate(__leaf->_M_slot(__leaf->_M_count - 1),
+                        __node->_M_slot(__i));
+            __node = __leaf;
+            __i = __leaf->_M_count - 1;
+        } else {
+            _S_relocate_range(__node->_M_slot(__i + 1),
+                              __node->_M_slot(__node->_M_count),
+                              __node->_M_slot(__i));
+        }
+        --__node->_M_count;
+        --_M_size;
+        iterator __next = this->_M_rebalance(__node, iterator(__node, __i));
+        __next._M_ascend();
+        // 空位之后是补进来的前驱，再往后才是原来的后继
+        if (__internal) {
+            __next._M_increment();
+        }
+        return __next;
+    }
+
+    void _M_destroy_subtree(_Node *__node) noexcept {
+        if (!__node->_M_leaf) {
+            for (std::size_t __k = 0; __k <= __node->_M_count; ++__k) {
+                this->_M_destroy_subtree(__node->_M_child(__k));
+            }
+        }
+        if constexpr (!std::is_trivially_destructible_v<_Value>) {
+            for (std::size_t __k = 0; __k != __node->_M_count; ++__k) {
+                __node->_M_slot(__k)->~_Value();
+            }
+        }
+        this->_M_free_node(__node);
+    }
+
+    // 新元素追加在 __tail（当前最大的元素）之后，它一定在叶子里
+    iterator _M_append_after(iterator __tail, _Value &__value) {
+        if (__tail._M_node == _M_block) {
+            return this->_M_insert_value(__tail, __value);
+        }
+        return this->_M_insert_value(
+            iterator(__tail._M_node, __tail._M_pos + 1), __value);
+    }
+
+    void _M_append_all(_BTreeImpl const &__that) {
+        iterator __tail(_M_block, 0);
+        for (const_iterator __it = __that.begin(); __it != __that.end();
+             ++__it) {
+            _Value __tmp(*__it);
+            __tail = this->_M_append_after(__tail, __tmp);
+        }
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void _M_single_insert(_InputIt __first, _InputIt __last,
+                          bool __sorted = false) {
+        this->_M_insert_range<true>(__first, __last, __sorted);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void _M_multi_insert(_InputIt __first, _InputIt __last,
+                         bool __sorted = false) {
+        this->_M_insert_range<false>(__first, __last, __sorted);
+    }
+
+    // 比当前最大元素还大的元素直接追加在最右的叶子末尾，有序输入因此
+    // 不必每次从根查找，节点也几乎是满的。__sorted 为真且原来是空树时
+    // 表示调用者保证有序，连这一次比较也省掉
+    template <bool _Unique, class _InputIt>
+    void _M_insert_range(_InputIt __first, _InputIt __last, bool __sorted) {
+        __sorted = __sorted && this->empty();
+        iterator __tail = this->end();
+        if (!this->empty()) {
+            --__tail;
+        }
+        for (; __first != __last; ++__first) {
+            _Value __tmp(*__first);
+            if (__tail == this->end() || __sorted ||
+                (_Unique ? _M_comp(*__tail, __tmp)
+                         : !_M_comp(__tmp, *__tail))) {
+                __tail = this->_M_append_after(__tail, __tmp);
+                continue;
+            }
+            if constexpr (_Unique) {
+                this->_M_single_emplace_key(__tmp, std::move(__tmp));
+            } else {
+                this->_M_multi_emplace(std::move(__tmp));
+            }
+            __tail = std::prev(this->end());
+        }
+    }
+
+  public:
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(_InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_multi_insert(__first, __last);
+    }
+
+  protected:
+    template <class _Tv> const_iterator _M_find(_Tv &&__value) const noexcept {
+        return this->_M_find_pos(__value);
+    }
+
+    template <class _Tv> iterator _M_find(_Tv &&__value) noexcept {
+        return this->_M_find_pos(__value);
+    }
+
+    template <class... _Ts> iterator _M_multi_emplace(_Ts &&...__value) {
+        if constexpr (_S_is_value<_Ts...>) {
+            return this->_M_insert_value(
+                this->_M_multi_insert_pos(__value...), __value...);
+        } else {
+            _Value __tmp(std::forward<_Ts>(__value)...);
+            return this->_M_insert_value(this->_M_multi_insert_pos(__tmp),
+                                         __tmp);
+        }
+    }
+
+    // 先按 __key 查找，键已存在时不构造值，__value 也不会被移走
+    template <class _Kv, class... _Ts>
+    std::pair<iterator, bool> _M_single_emplace_key(_Kv const &__key,
+                                                    _Ts &&...__value) {
+        auto [__pos, __found] = this->_M_find_insert_pos(__key);
+        if (__found) {
+            return {__pos, false};
+        }
+        return {this->_M_emplace_at(__pos, std::forward<_Ts>(__value)...),
+                true};
+    }
+
+    template <class... _Ts>
+    std::pair<iterator, bool> _M_single_emplace(_Ts &&...__value) {
+        if constexpr (sizeof...(_Ts) == 1 &&
+                      (std::is_same_v<std::remove_cvref_t<_Ts>, _Value> &&
+                       ...)) {
+            return this->_M_single_emplace_key(__value...,
+                                               std::forward<_Ts>(__value)...);
+        } else {
+            _Value __tmp(std::forward<_Ts>(__value)...);
+            return this->_M_single_emplace_key(__tmp, std::move(__tmp));
+        }
+    }
+
+    // __value 紧挨在 __hint 之前时插入位置就在 __hint 或其前驱旁边，
+    // 不必从根查找；唯一容器中与 __hint 等价时返回 {__hint, true}
+    template <bool _Unique>
+    std::pair<iterator, bool> _M_hint_insert_pos(const_iterator __hint,
+                                                 _Value const &__value) {
+        if (this->empty()) {
+            return {this->end(), false};
+        }
+        iterator __next(__hint._M_node, __hint._M_pos);
+        if (__next == this->end() ||
+            (_Unique ? _M_comp(__value, *__next)
+                     : !_M_comp(*__next, __value))) {
+            iterator __prev = __next;
+            --__prev;
+            if (__prev._M_node == _M_block) {
+                return {__next, false};
+            }
+            if (_Unique ? _M_comp(*__prev, __value)
+                        : !_M_comp(__value, *__prev)) {
+                if (__next != this->end() && __next._M_node->_M_leaf) {
+                    return {__next, false};
+                }
+                return {iterator(__prev._M_node, __prev._M_pos + 1), false};
+            }
+        } else if (_Unique && !_M_comp(*__next, __value)) {
+            return {__next, true};
+        } else if constexpr (!_Unique) {
+            // __hint 在 __value 之前：尽量靠近 __hint，插在等价元素的最前面
+            return {this->template _M_multi_insert_pos<true>(__value), false};
+        }
+        if constexpr (_Unique) {
+            return this->_M_find_insert_pos(__value);
+        } else {
+            return {this->_M_multi_insert_pos(__value), false};
+        }
+    }
+
+    template <class... _Ts>
+    iterator _M_single_emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        _Value __tmp(std::forward<_Ts>(__value)...);
+        auto [__pos, __found] =
+            this->template _M_hint_insert_pos<true>(__hint, __tmp);
+        if (__found) {
+            return __pos;
+        }
+        return this->_M_insert_value(__pos, __tmp);
+    }
+
+    template <class... _Ts>
+    iterator _M_multi_emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        _Value __tmp(std::forward<_Ts>(__value)...);
+        iterator __pos =
+            this->template _M_hint_insert_pos<false>(__hint, __tmp).first;
+        return this->_M_insert_value(__pos, __tmp);
+    }
+
+  public:
+    void clear() noexcept {
+        if (_Node *__root = this->_M_root()) {
+            this->_M_destroy_subtree(__root);
+            _M_block->_M_children[0] = nullptr;
+        }
+        _M_size = 0;
+    }
+
+    iterator erase(const_iterator __it) noexcept {
+        assert(__it != this->end());
+        _Node *__node = __it._M_node;
+        __node->_M_slot(__it._M_pos)->~_Value();
+        return this->_M_remove_at(__node, __it._M_pos);
+    }
+
+    // 键已存在时元素留在 __nh 里，随它一起销毁
+    std::pair<iterator, bool> insert(node_type __nh) {
+        if (__nh.empty()) {
+            return {this->end(), false};
+        }
+        auto [__pos, __found] = this->_M_find_insert_pos(*__nh._M_value);
+        if (__found) {
+            return {__pos, false};
+        }
+        iterator __it = this->_M_insert_value(__pos, *__nh._M_value);
+        __nh._M_release();
+        return {__it, true};
+    }
+
+    node_type extract(const_iterator __it) {
+        assert(__it != this->end());
+        typename node_type::_ValueAlloc __value_alloc(_M_alloc);
+        _Value *__value = std::allocator_traits<
+            typename node_type::_ValueAlloc>::allocate(__value_alloc, 1);
+        _S_relocate(__it._M_node->_M_slot(__it._M_pos), __value);
+        this->_M_remove_at(__it._M_node, __it._M_pos);
+        return node_type(__value, _M_alloc);
+    }
+
+  protected:
+    iterator _M_multi_insert_handle(node_type __nh) {
+        if (__nh.empty()) {
+            return this->end();
+        }
+        iterator __it = this->_M_insert_value(
+            this->_M_multi_insert_pos(*__nh._M_value), *__nh._M_value);
+        __nh._M_release();
+        return __it;
+    }
+
+    // 集合运算。元素存放在节点数组里，没有可以整体挪动的节点，只能
+    // 按 __that 的顺序逐个搬过来或查找，O(m log n)
+    template <bool _Unique> void _M_merge(_BTreeImpl &__that) {
+        if (&__that == this) {
+            return;
+        }
+        iterator __it = __that.begin();
+        while (__it != __that.end()) {
+            if constexpr (_Unique) {
+                if (!this->_M_single_emplace_key(*__it, std::move(*__it))
+                         .second) {
+                    ++__it;
+                    continue;
+                }
+            } else {
+                this->_M_multi_emplace(std::move(*__it));
+            }
+            __it = __that.erase(__it);
+        }
+    }
+
+    void _M_set_union(_BTreeImpl &__that) {
+        this->template _M_merge<true>(__that);
+        if (&__that != this) {
+            __that.clear();
+        }
+    }
+
+    void _M_set_intersection(_BTreeImpl &__that) {
+        if (&__that == this) {
+            return;
+        }
+        iterator __it = this->begin();
+        while (__it != this->end()) {
+            __it = __that._M_contains(*__it) ? std::next(__it)
+                                             : this->erase(__it);
+        }
+        __that.clear();
+    }
+
+    void _M_set_difference(_BTreeImpl &__that) {
+        if (&__that == this) {
+            this->clear();
+            return;
+        }
+        for (iterator __it = __that.begin(); __it != __that.end(); ++__it) {
+            this->_M_single_erase(*__it);
+        }
+        __that.clear();
+    }
+
+    // 并行批量操作的接口。元素放在节点数组里，没有可以拆开单独处理的
+    // 子树，这里都按顺序执行
+    template <bool _Unique, class _RandIt>
+    void _M_parallel_insert(_RandIt __first, _RandIt __last) {
+        this->_M_insert_range<_Unique>(__first, __last, false);
+    }
+
+    void _M_parallel_set_union(_BTreeImpl &__that) {
+        this->_M_set_union(__that);
+    }
+
+    template <class _Fn> void _M_parallel_for_each(_Fn &__f) const {
+        auto *__self = const_cast<_BTreeImpl *>(this);
+        for (iterator __it = __self->begin(); __it != __self->end(); ++__it) {
+            __f(*__it);
+        }
+    }
+
+    template <class _Tv> size_t _M_single_erase(_Tv &&__value) noexcept {
+        iterator __it = this->_M_find_pos(__value);
+        if (__it == this->end()) {
+            return 0;
+        }
+        this->erase(__it);
+        return 1;
+    }
+
+    // 删除会挪动元素，__last 随之失效，先数出个数再逐个删除
+    std::pair<iterator, size_t> _M_erase_range(const_iterator __first,
+                                               const_iterator __last) noexcept {
+        size_t __num = std::distance(__first, __last);
+        iterator __it(__first._M_node, __first._M_pos);
+        for (size_t __k = 0; __k != __num; ++__k) {
+            __it = this->erase(__it);
+        }
+        return {__it, __num};
+    }
+
+    template <class _Tv> size_t _M_multi_erase(_Tv &&__value) noexcept {
+        const_iterator __first = this->template _M_bound_pos<false>(__value);
+        const_iterator __last = this->template _M_bound_pos<true>(__value);
+        return this->_M_erase_range(__first, __last).second;
+    }
+
+  public:
+    iterator erase(const_iterator __first, const_iterator __last) noexcept {
+        return _BTreeImpl::_M_erase_range(__first, __last).first;
+    }
+
+    template <class _Tv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
+    iterator lower_bound(_Tv &&__value) noexcept {
+        return this->template _M_bound_pos<false>(__value);
+    }
+
+    template <class _Tv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
+    const_iterator lower_bound(_Tv &&__value) const noexcept {
+        return this->template _M_bound_pos<false>(__value);
+    }
+
+    template <class _Tv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
+    iterator upper_bound(_Tv &&__value) noexcept {
+        return this->template _M_bound_pos<true>(__value);
+    }
+
+    template <class _Tv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
+    const_iterator upper_bound(_Tv &&__value) const noexcept {
+        return this->template _M_bound_pos<true>(__value);
+    }
+
+    template <class _Tv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
+    std::pair<iterator, iterator> equal_range(_Tv &&__value) noexcept {
+        return {this->lower_bound(__value), this->upper_bound(__value)};
+    }
+
+    template <class _Tv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
+    std::pair<const_iterator, const_iterator>
+    equal_range(_Tv &&__value) const noexcept {
+        return {this->lower_bound(__value), this->upper_bound(__value)};
+    }
+
+    iterator lower_bound(_Tp const &__value) noexcept {
+        return this->template _M_bound_pos<false>(__value);
+    }
+
+    const_iterator lower_bound(_Tp const &__value) const noexcept {
+        return this->template _M_bound_pos<false>(__value);
+    }
+
+    iterator upper_bound(_Tp const &__value) noexcept {
+        return this->template _M_bound_pos<true>(__value);
+    }
+
+    const_iterator upper_bound(_Tp const &__value) const noexcept {
+        return this->template _M_bound_pos<true>(__value);
+    }
+
+    std::pair<iterator, iterator> equal_range(_Tp const &__value) noexcept {
+        return {this->lower_bound(__value), this->upper_bound(__value)};
+    }
+
+    std::pair<const_iterator, const_iterator>
+    equal_range(_Tp const &__value) const noexcept {
+        return {this->lower_bound(__value), this->upper_bound(__value)};
+    }
+
+  protected:
+    template <class _Tv> size_t _M_multi_count(_Tv &&__value) const noexcept {
+        return std::distance(this->template _M_bound_pos<false>(__value),
+                             this->template _M_bound_pos<true>(__value));
+    }
+
+    template <class _Tv> bool _M_contains(_Tv &&__value) const noexcept {
+        return this->_M_find_pos(__value) != this->end();
+    }
+
+    // 以迭代器为起点的查找。B 树只有几层，直接从根查找，__finger 不用
+    template <bool _Upper, class _Tv>
+    iterator _M_finger_bound(const_iterator, _Tv const &__value) noexcept {
+        return this->template _M_bound_pos<_Upper>(__value);
+    }
+
+    template <bool _Upper, class _Tv>
+    const_iterator _M_finger_bound(const_iterator,
+                                   _Tv const &__value) const noexcept {
+        return this->template _M_bound_pos<_Upper>(__value);
+    }
+
+    // 与红黑树一致，等价元素有多个时返回第一个
+    template <class _Tv>
+    iterator _M_finger_find(const_iterator, _Tv const &__value) noexcept {
+        iterator __it = this->template _M_bound_pos<false>(__value);
+        return __it != this->end() && _M_comp(__value, *__it) ? this->end()
+                                                               : __it;
+    }
+
+    template <class _Tv>
+    const_iterator _M_finger_find(const_iterator,
+                                  _Tv const &__value) const noexcept {
+        const_iterator __it = this->template _M_bound_pos<false>(__value);
+        return __it != this->end() && _M_comp(__value, *__it) ? this->end()
+                                                               : __it;
+    }
+
+    // 游标不记录路径，同样每次从根查找
+    struct _CursorPath {
+        void _M_reset() noexcept {}
+    };
+
+    template <class, class, class> friend struct _TreeCursor;
+
+    template <bool _Upper, class _Tv>
+    iterator _M_cursor_bound(_CursorPath &, _Tv const &__value) noexcept {
+        return this->template _M_bound_pos<_Upper>(__value);
+    }
+
+    template <bool _Upper, class _Tv>
+    const_iterator _M_cursor_bound(_CursorPath &,
+                                   _Tv const &__value) const noexcept {
+        return this->template _M_bound_pos<_Upper>(__value);
+    }
+
+    // 成批查找。B 树的节点本身就连续存放多个元素，这里逐个查找
+    template <class _KeyIt, class _OutIt>
+    _OutIt _M_find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) {
+        for (; __first != __last; ++__first) {
+            *__out++ = this->_M_find_pos(*__first);
+        }
+        return __out;
+    }
+
+    template <class _KeyIt, class _OutIt>
+    _OutIt _M_find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) const {
+        for (; __first != __last; ++__first) {
+            *__out++ = const_iterator(this->_M_find_pos(*__first));
+        }
+        return __out;
+    }
+
+    template <class _KeyIt, class _OutIt>
+    _OutIt _M_contains_many(_KeyIt __first, _KeyIt __last,
+                            _OutIt __out) const {
+        for (; __first != __last; ++__first) {
+            *__out++ = this->_M_find_pos(*__first) != this->end();
+        }
+        return __out;
+    }
+
+  public:
+    iterator begin() noexcept {
+        _Node *__node = this->_M_root();
+        if (__node == nullptr) {
+            return this->end();
+        }
+        while (!__node->_M_leaf) {
+            __node = __node->_M_child(0);
+        }
+        return {__node, 0};
+    }
+
+    reverse_iterator rbegin() noexcept {
+        iterator __it = this->end();
+        if (!this->empty()) {
+            --__it;
+        }
+        return {__it._M_node, __it._M_pos};
+    }
+
+    iterator end() noexcept { return {_M_block, 0}; }
+
+    reverse_iterator rend() noexcept { return {_M_block, 0}; }
+
+    const_iterator begin() const noexcept {
+        return const_cast<_BTreeImpl *>(this)->begin();
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        reverse_iterator __it = const_cast<_BTreeImpl *>(this)->rbegin();
+        return {__it._M_node, __it._M_pos};
+    }
+
+    const_iterator end() const noexcept { return {_M_block, 0}; }
+
+    const_reverse_iterator rend() const noexcept { return {_M_block, 0}; }
+
+    bool empty() const noexcept { return _M_size == 0; }
+
+    size_t size() const noexcept { return _M_size; }
+};
+
+template <class _Tp, class _Compare, class _Alloc, std::size_t _NodeBytes>
+struct _TreeImplSelect<_Tp, _Compare, _Alloc, _BTreeTag<_NodeBytes>> {
+    using type = _BTreeImpl<_Tp, _Compare, _Alloc, _NodeBytes>;
+};
+
+#endif // !__BTREE__
@@ -1,6 +1,7 @@
 #ifndef __COMMON__
 #define __COMMON__
 
+#include "_simd.hpp"
 #include <version>
 
 // C++20 concepts
@@ -36,6 +37,35 @@
                            std::declval<_Compare##Tp>()(std::declval<_Tp>(),   \
                                                         std::declval<_Tv>()))
 
+// 透明哈希约束宏 - 哈希函数和相等比较都支持异构键时才启用
+#define _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual, _Kv, _Key)     \
+    class _Hash##Tp = _Hash, class _KeyEqual##Tp = _KeyEqual,                  \
+          class = typename _Hash##Tp::is_transparent,                          \
+          class = typename _KeyEqual##Tp::is_transparent,                      \
+          class = decltype(std::declval<std::size_t &>() =                     \
+                               std::declval<_Hash##Tp>()(std::declval<_Kv>()), \
+                           std::declval<bool &>() =                            \
+                               std::declval<_KeyEqual##Tp>()(                  \
+                                   std::declval<_Kv>(), std::declval<_Key>()))
+
+namespace mstl {
+
+// 调用者保证区间已按比较器排好序时传入，有序容器据此跳过逐个比较、
+// 直接线性建树。sorted_unique 还要求区间内没有等价的元素
+struct sorted_unique_t {
+    explicit sorted_unique_t() = default;
+};
+
+inline constexpr sorted_unique_t sorted_unique{};
+
+struct sorted_equivalent_t {
+    explicit sorted_equivalent_t() = default;
+};
+
+inline constexpr sorted_equivalent_t sorted_equivalent{};
+
+} // namespace mstl
+
 // 越界异常抛出宏 - 统一的越界错误处理
 #define _LIBPENGCXX_THROW_OUT_OF_RANGE(__i, __n)                               \
     throw std::runtime_error("out of range at index " + std::to_string(__i) +  \
@@ -54,25 +84,33 @@
     } while (1)
 #endif
 
+// 预取宏 - 提示 CPU 提前把 __p 所在的缓存行读进来，不支持时什么也不做
+#if defined(__GNUC__) || defined(__clang__)
+#define _LIBPENGCXX_PREFETCH(__p) __builtin_prefetch(__p)
+#else
+#define _LIBPENGCXX_PREFETCH(__p) ((void)(__p))
+#endif
+
 // 比较操作符定义宏 - 根据C++20支持生成不同的比较操作符
 #if __cpp_lib_three_way_comparison
 // C++20版本：使用三路比较和自动生成的操作符
+// 连续存储的算术类型区间会分派到 _simd.hpp 中的 memcmp/SIMD 内核
 #define _LIBPENGCXX_DEFINE_COMPARISON(_Type)                                   \
     bool operator==(_Type const &__that) const noexcept {                      \
-        return std::equal(this->begin(), this->end(), __that.begin(),          \
-                          __that.end());                                       \
+        return mstl::__range_equal(this->begin(), this->end(), __that.begin(), \
+                                   __that.end());                              \
     }                                                                          \
                                                                                \
     auto operator<=>(_Type const &__that) const noexcept {                     \
-        return std::lexicographical_compare_three_way(                         \
+        return mstl::__range_compare_three_way(                                \
             this->begin(), this->end(), __that.begin(), __that.end());         \
     }
 #else
 // C++17版本：手动定义所有比较操作符
 #define _LIBPENGCXX_DEFINE_COMPARISON(_Type)                                   \
     bool operator==(_Type const &__that) const noexcept {                      \
-        return std::equal(this->begin(), this->end(), __that.begin(),          \
-                          __that.end());                                       \
+        return mstl::__range_equal(this->begin(), this->end(), __that.begin(), \
+                                   __that.end());                              \
     }                                                                          \
                                                                                \
     bool operator!=(_Type const &__that) const noexcept {                      \
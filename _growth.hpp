@@ -0,0 +1,75 @@
+#ifndef __GROWTH__
+#define __GROWTH__
+
+/*
+
+ -- 动态数组扩容策略 --
+
+ 策略是一个提供静态函数 next_capacity 的类型：
+   static size_t next_capacity(size_t cap, size_t n, size_t elem_size);
+ 其中 cap 为当前容量，n 为至少需要的容量，返回值必须 >= n。
+
+*/
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+namespace mstl {
+
+// 2 倍扩容：扩容次数最少，适合延迟敏感的场景
+struct growth_2x {
+    static constexpr std::size_t next_capacity(std::size_t cap, std::size_t n,
+                                               std::size_t) noexcept {
+        return std::max(n, cap * 2);
+    }
+};
+
+// 1.5 倍扩容：之前释放的若干块加起来足以容纳新块，分配器可以复用，
+// 峰值内存更低，适合内存敏感的场景
+struct growth_1_5x {
+    static constexpr std::size_t next_capacity(std::size_t cap, std::size_t n,
+                                               std::size_t) noexcept {
+        return std::max(n, cap + cap / 2);
+    }
+};
+
+// 在 Base 的基础上把字节数向上取整到分配器的尺寸类别
+// （与 jemalloc/tcmalloc 相同：每个 2 的幂区间划分为 4 档），
+// 否则取整多出来的那部分内存会被分配器白白浪费掉
+template <typename Base = growth_2x> struct growth_size_class {
+    static constexpr std::size_t
+    next_capacity(std::size_t cap, std::size_t n,
+                  std::size_t elem_size) noexcept {
+        std::size_t bytes = Base::next_capacity(cap, n, elem_size) * elem_size;
+        std::size_t step;
+        if (bytes <= 128) {
+            step = 16;
+        } else {
+            step = std::size_t(1) << (std::bit_width(bytes - 1) - 3);
+        }
+        bytes = (bytes + step - 1) / step * step;
+        return bytes / elem_size;
+    }
+};
+
+// 在 Base 的基础上把超过一页的块向上取整到 PageSize 的整数倍
+template <typename Base = growth_2x, std::size_t PageSize = 4096>
+struct growth_page_aligned {
+    static_assert(std::has_single_bit(PageSize),
+                  "PageSize must be a power of two");
+
+    static constexpr std::size_t
+    next_capacity(std::size_t cap, std::size_t n,
+                  std::size_t elem_size) noexcept {
+        std::size_t bytes = Base::next_capacity(cap, n, elem_size) * elem_size;
+        if (bytes >= PageSize) {
+            bytes = (bytes + PageSize - 1) & ~(PageSize - 1);
+        }
+        return bytes / elem_size;
+    }
+};
+
+} // namespace mstl
+
+#endif // !__GROWTH__
@@ -0,0 +1,931 @@
+#ifndef __HASHTABLE__
+#define __HASHTABLE__
+
+/*
+
+ -- 开放寻址哈希表（SwissTable 风格）--
+
+ 每个槽位对应一个控制字节：
+   空     0b10000000 (-128)
+   已删除 0b11111110 (-2)
+   哨兵   0b11111111 (-1)，位于 ctrl[cap]，迭代器走到这里结束
+   占用   0b0xxxxxxx，低 7 位是哈希值的 H2 部分
+ 哈希值的其余位（H1）决定探测起点。查找时一次载入 16 个控制字节，
+ 用 SSE2 同时和 H2 比较，只有匹配的槽位才会调用 _KeyEqual；
+ 一组中只要出现空字节，就可以断定查找失败。
+
+ 容量总是 2^k - 1。哨兵之后复制了前 15 个控制字节，
+ 所以从任意槽位开始载入一组都不会越界，组内第 i 个字节对应
+ 槽位 (pos + i) & cap。元素直接平铺在槽位数组中，rehash 时会被搬迁。
+
+*/
+
+#include "_common.hpp"
+#include "_relocate.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+struct _HashTableCtrl {
+    static constexpr std::int8_t _S_empty = -128;
+    static constexpr std::int8_t _S_deleted = -2;
+    static constexpr std::int8_t _S_sentinel = -1;
+
+    static bool _S_is_full(std::int8_t __ctrl) noexcept { return __ctrl >= 0; }
+};
+
+// 尚未分配内存的表共用这一组控制字节：哨兵 + 15 个空
+alignas(16) inline constexpr std::int8_t __hashtable_empty_group[16] = {
+    _HashTableCtrl::_S_sentinel, _HashTableCtrl::_S_empty,
+    _HashTableCtrl::_S_empty,    _HashTableCtrl::_S_empty,
+    _HashTableCtrl::_S_empty,    _HashTableCtrl::_S_empty,
+    _HashTableCtrl::_S_empty,    _HashTableCtrl::_S_empty,
+    _HashTableCtrl::_S_empty,    _HashTableCtrl::_S_empty,
+    _HashTableCtrl::_S_empty,    _HashTableCtrl::_S_empty,
+    _HashTableCtrl::_S_empty,    _HashTableCtrl::_S_empty,
+    _HashTableCtrl::_S_empty,    _HashTableCtrl::_S_empty,
+};
+
+// 一组 16 个控制字节，_M_match 系列返回每个字节一位的掩码
+struct _HashTableGroup {
+    static constexpr std::size_t _S_width = 16;
+
+#if defined(_LIBPENGCXX_SIMD)
+    __m128i _M_ctrl;
+
+    explicit _HashTableGroup(std::int8_t const *__pos) noexcept
+        : _M_ctrl(_mm_loadu_si128(reinterpret_cast<__m128i const *>(__pos))) {}
+
+    std::uint32_t _M_match(std::int8_t __h2) const noexcept {
+        return static_cast<std::uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(__h2), _M_ctrl)));
+    }
+
+    // 空和已删除都小于哨兵 -1（有符号比较）
+    std::uint32_t _M_match_empty_or_deleted() const noexcept {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(
+            _mm_set1_epi8(_HashTableCtrl::_S_sentinel), _M_ctrl)));
+    }
+#else
+    std::int8_t _M_ctrl[_S_width];
+
+    explicit _HashTableGroup(std::int8_t const *__pos) noexcept {
+        std::memcpy(_M_ctrl, __pos, _S_width);
+    }
+
+    std::uint32_t _M_match(std::int8_t __h2) const noexcept {
+        std::uint32_t __mask = 0;
+        for (std::size_t __i = 0; __i < _S_width; __i++) {
+            __mask |= std::uint32_t(_M_ctrl[__i] == __h2) << __i;
+        }
+        return __mask;
+    }
+
+    std::uint32_t _M_match_empty_or_deleted() const noexcept {
+        std::uint32_t __mask = 0;
+        for (std::size_t __i = 0; __i < _S_width; __i++) {
+            __mask |= std::uint32_t(_M_ctrl[__i] < _HashTableCtrl::_S_sentinel)
+                      << __i;
+        }
+        return __mask;
+    }
+#endif
+
+    std::uint32_t _M_match_empty() const noexcept {
+        return this->_M_match(_HashTableCtrl::_S_empty);
+    }
+};
+
+// std::hash 对整数是恒等映射，低位和高位都需要充分混合后才能拆成 H1/H2
+inline std::size_t __hashtable_mix(std::size_t __hash) noexcept {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 __m =
+        static_cast<unsigned __int128>(__hash) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(static_cast<std::uint64_t>(__m) ^
+                                    static_cast<std::uint64_t>(__m >> 64));
+#else
+    std::uint64_t __h = __hash;
+    __h ^= __h >> 33;
+    __h *= 0xFF51AFD7ED558CCDull;
+    __h ^= __h >> 33;
+    return static_cast<std::size_t>(__h);
+#endif
+}
+
+struct _HashTableIdentity {
+    template <class _Tp>
+    _Tp const &operator()(_Tp const &__value) const noexcept {
+        return __value;
+    }
+};
+
+struct _HashTableSelect1st {
+    template <class _Tp>
+    typename _Tp::first_type const &
+    operator()(_Tp const &__value) const noexcept {
+        return __value.first;
+    }
+
+    struct _HashTableIsMap;
+};
+
+template <class _Tp> struct _HashTableNodeImpl {
+    union {
+        _Tp _M_value;
+    };
+
+    template <class... _Ts> void _M_construct(_Ts &&...__value) {
+        new (const_cast<std::remove_const_t<_Tp> *>(std::addressof(_M_value)))
+            _Tp(std::forward<_Ts>(__value)...);
+    }
+
+    void _M_destruct() noexcept { _M_value.~_Tp(); }
+
+    _HashTableNodeImpl() noexcept {}
+
+    ~_HashTableNodeImpl() noexcept {}
+};
+
+template <class _Tp> struct _HashTableIterator {
+  protected:
+    std::int8_t const *_M_ctrl;
+    std::remove_const_t<_Tp> *_M_slot;
+
+    _HashTableIterator(std::int8_t const *__ctrl,
+                       std::remove_const_t<_Tp> *__slot) noexcept
+        : _M_ctrl(__ctrl), _M_slot(__slot) {}
+
+    // 跳过空槽和已删除的槽，哨兵会让循环停在 end()
+    void _M_skip_empty() noexcept {
+        while (*_M_ctrl < _HashTableCtrl::_S_sentinel) {
+            ++_M_ctrl;
+            ++_M_slot;
+        }
+    }
+
+    template <class, class, class, class, class, class>
+    friend struct _HashTableImpl;
+
+    template <class> friend struct _HashTableIterator;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = std::remove_const_t<_Tp>;
+    using reference = _Tp &;
+    using pointer = _Tp *;
+
+    _HashTableIterator() noexcept : _M_ctrl(nullptr), _M_slot(nullptr) {}
+
+    template <class T0 = _Tp>
+    explicit operator std::enable_if_t<
+        std::is_const_v<T0>, _HashTableIterator<std::remove_const_t<T0>>>()
+        const noexcept {
+        return {_M_ctrl, _M_slot};
+    }
+
+    template <class T0 = _Tp>
+    operator std::enable_if_t<!std::is_const_v<T0>,
+                              _HashTableIterator<std::add_const_t<T0>>>()
+        const noexcept {
+        return {_M_ctrl, _M_slot};
+    }
+
+    _HashTableIterator &operator++() noexcept { // ++__it
+        ++_M_ctrl;
+        ++_M_slot;
+        this->_M_skip_empty();
+        return *this;
+    }
+
+    _HashTableIterator operator++(int) noexcept { // __it++
+        _HashTableIterator __tmp = *this;
+        ++*this;
+        return __tmp;
+    }
+
+    _Tp &operator*() const noexcept {
+        assert(_HashTableCtrl::_S_is_full(*_M_ctrl));
+        return *_M_slot;
+    }
+
+    _Tp *operator->() const noexcept {
+        assert(_HashTableCtrl::_S_is_full(*_M_ctrl));
+        return _M_slot;
+    }
+
+    bool operator==(_HashTableIterator const &__that) const noexcept {
+        return _M_ctrl == __that._M_ctrl;
+    }
+
+    bool operator!=(_HashTableIterator const &__that) const noexcept {
+        return _M_ctrl != __that._M_ctrl;
+    }
+};
+
+// 槽位是平铺的，extract 时把元素移进单独分配的节点，insert 时再移回槽位
+template <class _Tp, class _KeyOf, class _Alloc, class = void>
+struct _HashTableNodeHandle {
+  protected:
+    using _NodeImpl = _HashTableNodeImpl<_Tp>;
+    using _NodeAlloc = typename std::allocator_traits<
+        _Alloc>::template rebind_alloc<_NodeImpl>;
+
+    _NodeImpl *_M_node;
+    [[no_unique_address]] _Alloc _M_alloc;
+
+    _HashTableNodeHandle(_NodeImpl *__node, _Alloc __alloc) noexcept
+        : _M_node(__node), _M_alloc(__alloc) {}
+
+    void _M_release() noexcept {
+        if (_M_node) {
+            _M_node->_M_destruct();
+            _NodeAlloc __node_alloc(_M_alloc);
+            std::allocator_traits<_NodeAlloc>::deallocate(__node_alloc,
+                                                          _M_node, 1);
+            _M_node = nullptr;
+        }
+    }
+
+    template <class, class, class, class, class, class>
+    friend struct _HashTableImpl;
+
+  public:
+    _HashTableNodeHandle() noexcept : _M_node(nullptr) {}
+
+    _HashTableNodeHandle(_HashTableNodeHandle &&__that) noexcept
+        : _M_node(__that._M_node), _M_alloc(std::move(__that._M_alloc)) {
+        __that._M_node = nullptr;
+    }
+
+    _HashTableNodeHandle &operator=(_HashTableNodeHandle &&__that) noexcept {
+        std::swap(_M_node, __that._M_node);
+        std::swap(_M_alloc, __that._M_alloc);
+        return *this;
+    }
+
+    bool empty() const noexcept { return _M_node == nullptr; }
+
+    explicit operator bool() const noexcept { return _M_node != nullptr; }
+
+    _Tp &value() const noexcept { return _M_node->_M_value; }
+
+    ~_HashTableNodeHandle() noexcept { this->_M_release(); }
+};
+
+template <class _Tp, class _KeyOf, class _Alloc>
+struct _HashTableNodeHandle<
+    _Tp, _KeyOf, _Alloc,
+    decltype((void)static_cast<typename _KeyOf::_HashTableIsMap *>(nullptr))>
+    : _HashTableNodeHandle<_Tp, _KeyOf, _Alloc, void *> {
+  protected:
+    using _HashTableNodeHandle<_Tp, _KeyOf, _Alloc,
+                               void *>::_HashTableNodeHandle;
+
+    template <class, class, class, class, class, class>
+    friend struct _HashTableImpl;
+
+  public:
+    _HashTableNodeHandle() noexcept = default;
+
+    typename _Tp::first_type &key() const noexcept {
+        return this->value().first;
+    }
+
+    typename _Tp::second_type &mapped() const noexcept {
+        return this->value().second;
+    }
+};
+
+template <class _Tp, class _Key, class _KeyOf, class _Hash, class _KeyEqual,
+          class _Alloc>
+struct _HashTableImpl {
+  protected:
+    using _Ctrl = _HashTableCtrl;
+    using _Group = _HashTableGroup;
+
+    static constexpr std::size_t _S_width = _Group::_S_width;
+
+    // 控制字节和槽位放在同一块内存中：控制字节在前，槽位在后
+    struct alignas(_Tp) _Unit {
+        unsigned char _M_bytes[alignof(_Tp)];
+    };
+
+    using _UnitAlloc =
+        typename std::allocator_traits<_Alloc>::template rebind_alloc<_Unit>;
+
+    std::int8_t *_M_ctrl;
+    _Tp *_M_slots;
+    std::size_t _M_cap;
+    std::size_t _M_size;
+    std::size_t _M_growth_left; // 还能填入多少个空槽而不必 rehash
+    [[no_unique_address]] _Hash _M_hash;
+    [[no_unique_address]] _KeyEqual _M_eq;
+    [[no_unique_address]] _Alloc _M_alloc;
+
+  public:
+    using iterator = _HashTableIterator<_Tp>;
+    using const_iterator = _HashTableIterator<_Tp const>;
+    using node_type = _HashTableNodeHandle<_Tp, _KeyOf, _Alloc>;
+
+    _HashTableImpl() noexcept
+        : _M_ctrl(const_cast<std::int8_t *>(__hashtable_empty_group)),
+          _M_slots(nullptr), _M_cap(0), _M_size(0), _M_growth_left(0) {}
+
+    explicit _HashTableImpl(std::size_t __bucket_count,
+                            _Hash __hash = _Hash(),
+                            _KeyEqual __eq = _KeyEqual(),
+                            _Alloc __alloc = _Alloc())
+        : _M_ctrl(const_cast<std::int8_t *>(__hashtable_empty_group)),
+          _M_slots(nullptr), _M_cap(0), _M_size(0), _M_growth_left(0),
+          _M_hash(__hash), _M_eq(__eq), _M_alloc(__alloc) {
+        if (__bucket_count != 0) {
+            this->_M_allocate_table(_S_normalize_capacity(__bucket_count));
+        }
+    }
+
+    ~_HashTableImpl() noexcept {
+        this->_M_destroy_slots();
+        this->_M_deallocate_table(_M_ctrl, _M_cap);
+    }
+
+    // 布局完全确定，拷贝时直接复制控制字节，元素按原位置拷贝构造，不再重新哈希
+    _HashTableImpl(_HashTableImpl const &__that)
+        : _HashTableImpl(0, __that._M_hash, __that._M_eq, __that._M_alloc) {
+        if (__that._M_size == 0) {
+            return;
+        }
+        this->_M_allocate_table(__that._M_cap);
+        std::size_t __i = 0;
+        try {
+            for (; __i < _M_cap; __i++) {
+                if (_Ctrl::_S_is_full(__that._M_ctrl[__i])) {
+                    new (static_cast<void *>(_M_slots + __i))
+                        _Tp(__that._M_slots[__i]);
+                }
+            }
+        } catch (...) {
+            for (std::size_t __j = 0; __j < __i; __j++) {
+                if (_Ctrl::_S_is_full(__that._M_ctrl[__j])) {
+                    _M_slots[__j].~_Tp();
+                }
+            }
+            this->_M_deallocate_table(_M_ctrl, _M_cap);
+            // 委托构造已经完成，析构函数还会运行，置空以免再释放一次
+            this->_M_reset_empty();
+            throw;
+        }
+        std::memcpy(_M_ctrl, __that._M_ctrl, _M_cap + _S_width);
+        _M_size = __that._M_size;
+        _M_growth_left = __that._M_growth_left;
+    }
+
+    _HashTableImpl(_HashTableImpl &&__that) noexcept
+        : _M_ctrl(__that._M_ctrl), _M_slots(__that._M_slots),
+          _M_cap(__that._M_cap), _M_size(__that._M_size),
+          _M_growth_left(__that._M_growth_left),
+          _M_hash(std::move(__that._M_hash)), _M_eq(std::move(__that._M_eq)),
+          _M_alloc(std::move(__that._M_alloc)) {
+        __that._M_reset_empty();
+    }
+
+    _HashTableImpl &operator=(_HashTableImpl const &__that) {
+        if (&__that != this) {
+            _HashTableImpl __tmp(__that);
+            this->swap(__tmp);
+        }
+        return *this;
+    }
+
+    _HashTableImpl &operator=(_HashTableImpl &&__that) noexcept {
+        if (&__that != this) {
+            _HashTableImpl __tmp(std::move(__that));
+            this->swap(__tmp);
+        }
+        return *this;
+    }
+
+    void swap(_HashTableImpl &__that) noexcept {
+        std::swap(_M_ctrl, __that._M_ctrl);
+        std::swap(_M_slots, __that._M_slots);
+        std::swap(_M_cap, __that._M_cap);
+        std::swap(_M_size, __that._M_size);
+        std::swap(_M_growth_left, __that._M_growth_left);
+        std::swap(_M_hash, __that._M_hash);
+        std::swap(_M_eq, __that._M_eq);
+        std::swap(_M_alloc, __that._M_alloc);
+    }
+
+  protected:
+    static std::size_t _S_h1(std::size_t __hash) noexcept {
+        return __hash >> 7;
+    }
+
+    static std::int8_t _S_h2(std::size_t __hash) noexcept {
+        return static_cast<std::int8_t>(__hash & 0x7F);
+    }
+
+    // 最多填到 7/8；容量不超过 7 时整张表都在一组里，可以填满
+    static std::size_t _S_capacity_to_growth(std::size_t __cap) noexcept {
+        return __cap - __cap / 8;
+    }
+
+    static std::size_t _S_growth_to_capacity(std::size_t __growth) noexcept {
+        return __growth == 0 ? 0 : __growth + (__growth - 1) / 7;
+    }
+
+    static std::size_t _S_normalize_capacity(std::size_t __n) noexcept {
+        return __n == 0 ? 1 : std::bit_ceil(__n + 1) - 1;
+    }
+
+    // 控制字节（cap 个 + 哨兵 + 15 个副本）按 _Tp 对齐后的字节数
+    static std::size_t _S_ctrl_bytes(std::size_t __cap) noexcept {
+        return (__cap + _S_width + alignof(_Tp) - 1) / alignof(_Tp) *
+               alignof(_Tp);
+    }
+
+    static std::size_t _S_alloc_units(std::size_t __cap) noexcept {
+        return (_S_ctrl_bytes(__cap) + __cap * sizeof(_Tp)) / alignof(_Tp);
+    }
+
+    void _M_reset_empty() noexcept {
+        _M_ctrl = const_cast<std::int8_t *>(__hashtable_empty_group);
+        _M_slots = nullptr;
+        _M_cap = 0;
+        _M_size = 0;
+        _M_growth_left = 0;
+    }
+
+    void _M_allocate_table(std::size_t __cap) {
+        _UnitAlloc __unit_alloc(_M_alloc);
+        auto __block = reinterpret_cast<unsigned char *>(
+            std::allocator_traits<_UnitAlloc>::allocate(
+                __unit_alloc, _S_alloc_units(__cap)));
+        _M_ctrl = reinterpret_cast<std::int8_t *>(__block);
+        _M_slots = reinterpret_cast<_Tp *>(__block + _S_ctrl_bytes(__cap));
+        _M_cap = __cap;
+        std::memset(_M_ctrl, static_cast<unsigned char>(_Ctrl::_S_empty),
+                    __cap + _S_width);
+        _M_ctrl[__cap] = _Ctrl::_S_sentinel;
+        _M_growth_left = _S_capacity_to_growth(__cap) - _M_size;
+    }
+
+    void _M_deallocate_table(std::int8_t *__ctrl, std::size_t __cap) noexcept {
+        if (__cap != 0) {
+            _UnitAlloc __unit_alloc(_M_alloc);
+            std::allocator_traits<_UnitAlloc>::deallocate(
+                __unit_alloc, reinterpret_cast<_Unit *>(__ctrl),
+                _S_alloc_units(__cap));
+        }
+    }
+
+    void _M_destroy_slots() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<_Tp>) {
+            for (std::size_t __i = 0; __i < _M_cap; __i++) {
+                if (_Ctrl::_S_is_full(_M_ctrl[__i])) {
+                    _M_slots[__i].~_Tp();
+                }
+            }
+        }
+    }
+
+    // 同时写入控制字节和它在哨兵之后的副本（位于前 15 个槽位时）
+    void _M_set_ctrl(std::size_t __i, std::int8_t __h) noexcept {
+        _M_ctrl[__i] = __h;
+        _M_ctrl[((__i - (_S_width - 1)) & _M_cap) +
+                ((_S_width - 1) & _M_cap)] = __h;
+    }
+
+    template <class _Kv> std::size_t _M_hash_of(_Kv const &__key) const {
+        return __hashtable_mix(_M_hash(__key));
+    }
+
+    // 查找键所在的槽位，找不到时返回 _M_cap
+    template <class _Kv>
+    std::size_t _M_find_index(_Kv const &__key, std::size_t __hash) const {
+        std::int8_t __h2 = _S_h2(__hash);
+        std::size_t __pos = _S_h1(__hash) & _M_cap;
+        std::size_t __step = 0;
+        while (true) {
+            _Group __group(_M_ctrl + __pos);
+            for (std::uint32_t __m = __group._M_match(__h2); __m != 0;
+                 __m &= __m - 1) {
+                std::size_t __i = (__pos + std::countr_zero(__m)) & _M_cap;
+                if (_M_eq(__key, _KeyOf()(_M_slots[__i]))) [[likely]] {
+                    return __i;
+                }
+            }
+            if (__group._M_match_empty() != 0) [[likely]] {
+                return _M_cap;
+            }
+            __step += _S_width;
+            __pos = (__pos + __step) & _M_cap;
+        }
+    }
+
+    std::size_t _M_find_first_non_full(std::size_t __hash) const noexcept {
+        std::size_t __pos = _S_h1(__hash) & _M_cap;
+        std::size_t __step = 0;
+        while (true) {
+            _Group __group(_M_ctrl + __pos);
+            std::uint32_t __m = __group._M_match_empty_or_deleted();
+            if (__m != 0) [[likely]] {
+                return (__pos + std::countr_zero(__m)) & _M_cap;
+            }
+            __step += _S_width;
+            __pos = (__pos + __step) & _M_cap;
+        }
+    }
+
+    static constexpr bool _S_nothrow_hash =
+        std::is_nothrow_invocable_v<_Hash const &, _Key const &>;
+
+    static constexpr bool _S_nothrow_relocate =
+        mstl::is_trivially_relocatable_v<_Tp> ||
+        std::is_nothrow_move_constructible_v<_Tp>;
+
+    static void _S_relocate(_Tp *__src, _Tp *__dst) noexcept {
+        if constexpr (mstl::is_trivially_relocatable_v<_Tp>) {
+            std::memcpy(static_cast<void *>(__dst),
+                        static_cast<void const *>(__src), sizeof(_Tp));
+        } else {
+            new (static_cast<void *>(__dst)) _Tp(std::move(*__src));
+            __src->~_Tp();
+        }
+    }
+
+    void _M_resize(std::size_t __new_cap) {
+        if constexpr (!_S_nothrow_hash || !_S_nothrow_relocate) {
+            this->_M_resize_slow(__new_cap);
+            return;
+        }
+        std::int8_t *__old_ctrl = _M_ctrl;
+        _Tp *__old_slots = _M_slots;
+        std::size_t __old_cap = _M_cap;
+        this->_M_allocate_table(__new_cap);
+        for (std::size_t __i = 0; __i < __old_cap; __i++) {
+            if (_Ctrl::_S_is_full(__old_ctrl[__i])) {
+                std::size_t __hash =
+                    this->_M_hash_of(_KeyOf()(__old_slots[__i]));
+                std::size_t __j = this->_M_find_first_non_full(__hash);
+                this->_M_set_ctrl(__j, _S_h2(__hash));
+                _S_relocate(__old_slots + __i, _M_slots + __j);
+            }
+        }
+        this->_M_deallocate_table(__old_ctrl, __old_cap);
+    }
+
+    // 哈希或搬迁可能抛出异常时：先算出所有哈希值，再把元素复制（或不会
+    // 抛出异常地移动）到新表，全部成功后才销毁旧元素。任何一步失败，
+    // 旧表都保持原样
+    void _M_resize_slow(std::size_t __new_cap) {
+        using _HashAlloc = typename std::allocator_traits<
+            _Alloc>::template rebind_alloc<std::size_t>;
+        _HashAlloc __hash_alloc(_M_alloc);
+        std::size_t __count = std::max<std::size_t>(_M_size, 1);
+        std::size_t *__hashes =
+            std::allocator_traits<_HashAlloc>::allocate(__hash_alloc, __count);
+        std::int8_t *__old_ctrl = _M_ctrl;
+        _Tp *__old_slots = _M_slots;
+        std::size_t __old_cap = _M_cap;
+        std::size_t __old_growth = _M_growth_left;
+        bool __allocated = false;
+        try {
+            std::size_t __k = 0;
+            for (std::size_t __i = 0; __i < __old_cap; __i++) {
+                if (_Ctrl::_S_is_full(__old_ctrl[__i])) {
+                    __hashes[__k++] =
+                        this->_M_hash_of(_KeyOf()(__old_slots[__i]));
+                }
+            }
+            this->_M_allocate_table(__new_cap);
+            __allocated = true;
+            __k = 0;
+            for (std::size_t __i = 0; __i < __old_cap; __i++) {
+                if (_Ctrl::_S_is_full(__old_ctrl[__i])) {
+                    std::size_t __hash = __hashes[__k++];
+                    std::size_t __j = this->_M_find_first_non_full(__hash);
+                    if constexpr (mstl::is_trivially_relocatable_v<_Tp>) {
+                        std::memcpy(
+                            static_cast<void *>(_M_slots + __j),
+                            static_cast<void const *>(__old_slots + __i),
+                            sizeof(_Tp));
+                    } else {
+                        new (static_cast<void *>(_M_slots + __j))
+                            _Tp(std::move_if_noexcept(__old_slots[__i]));
+                    }
+                    this->_M_set_ctrl(__j, _S_h2(__hash));
+                }
+            }
+        } catch (...) {
+            // 平凡搬迁不会抛出异常，走到这里时新表中只有复制出的元素
+            if (__allocated) {
+                this->_M_destroy_slots();
+                this->_M_deallocate_table(_M_ctrl, _M_cap);
+                _M_ctrl = __old_ctrl;
+                _M_slots = __old_slots;
+                _M_cap = __old_cap;
+                _M_growth_left = __old_growth;
+            }
+            std::allocator_traits<_HashAlloc>::deallocate(__hash_alloc,
+                                                          __hashes, __count);
+            throw;
+        }
+        if constexpr (!mstl::is_trivially_relocatable_v<_Tp>) {
+            for (std::size_t __i = 0; __i < __old_cap; __i++) {
+                if (_Ctrl::_S_is_full(__old_ctrl[__i])) {
+                    __old_slots[__i].~_Tp();
+                }
+            }
+        }
+        this->_M_deallocate_table(__old_ctrl, __old_cap);
+        std::allocator_traits<_HashAlloc>::deallocate(__hash_alloc, __hashes,
+                                                      __count);
+    }
+
+    // 已删除的槽位太多时按原容量重建即可，否则容量翻倍
+    void _M_rehash_for_insert() {
+        if (_M_cap > _S_width && _M_size * 32 <= _M_cap * 25) {
+            this->_M_resize(_M_cap);
+        } else {
+            this->_M_resize(_M_cap * 2 + 1);
+        }
+    }
+
+    // 为哈希值为 __hash 的新元素占好一个槽位，元素由调用者构造
+    std::size_t _M_prepare_insert(std::size_t __hash) {
+        if (_M_growth_left == 0) [[unlikely]] {
+            this->_M_rehash_for_insert();
+        }
+        std::size_t __i = this->_M_find_first_non_full(__hash);
+        _M_growth_left -= _M_ctrl[__i] == _Ctrl::_S_empty;
+        this->_M_set_ctrl(__i, _S_h2(__hash));
+        ++_M_size;
+        return __i;
+    }
+
+    // 前后两组中都有空槽，且包含 __i 的连续占用段不足一组：
+    // 从来没有探测序列因为这一组满了而越过它，可以直接标记为空
+    void _M_erase_meta(std::size_t __i) noexcept {
+        bool __never_full = true;
+        if (_M_cap >= _S_width - 1) {
+            std::size_t __before = (__i - _S_width) & _M_cap;
+            std::uint32_t __empty_after =
+                _Group(_M_ctrl + __i)._M_match_empty();
+            std::uint32_t __empty_before =
+                _Group(_M_ctrl + __before)._M_match_empty();
+            __never_full =
+                __empty_after != 0 && __empty_before != 0 &&
+                std::size_t(std::countr_zero(__empty_after) +
+                            std::countl_zero(std::uint16_t(__empty_before))) <
+                    _S_width;
+        }
+        this->_M_set_ctrl(__i, __never_full ? _Ctrl::_S_empty
+                                            : _Ctrl::_S_deleted);
+        _M_growth_left += __never_full;
+    }
+
+    void _M_erase_index(std::size_t __i) noexcept {
+        _M_slots[__i].~_Tp();
+        --_M_size;
+        this->_M_erase_meta(__i);
+    }
+
+    template <class... _Ts>
+    void _M_construct_at(std::size_t __i, _Ts &&...__value) {
+        try {
+            new (static_cast<void *>(_M_slots + __i))
+                _Tp(std::forward<_Ts>(__value)...);
+        } catch (...) {
+            --_M_size;
+            this->_M_erase_meta(__i);
+            throw;
+        }
+    }
+
+    template <class _Kv>
+    std::pair<std::size_t, bool> _M_find_or_prepare_insert(_Kv const &__key) {
+        std::size_t __hash = this->_M_hash_of(__key);
+        std::size_t __i = this->_M_find_index(__key, __hash);
+        if (__i != _M_cap) {
+            return {__i, false};
+        }
+        return {this->_M_prepare_insert(__hash), true};
+    }
+
+    iterator _M_iterator_at(std::size_t __i) noexcept {
+        return {_M_ctrl + __i, _M_slots + __i};
+    }
+
+    const_iterator _M_iterator_at(std::size_t __i) const noexcept {
+        return {_M_ctrl + __i, _M_slots + __i};
+    }
+
+    template <class _Kv> iterator _M_find(_Kv const &__key) {
+        return this->_M_iterator_at(
+            this->_M_find_index(__key, this->_M_hash_of(__key)));
+    }
+
+    template <class _Kv>
+    const_iterator _M_find(_Kv const &__key) const {
+        return this->_M_iterator_at(
+            this->_M_find_index(__key, this->_M_hash_of(__key)));
+    }
+
+    template <class _Kv> bool _M_contains(_Kv const &__key) const {
+        return this->_M_find_index(__key, this->_M_hash_of(__key)) != _M_cap;
+    }
+
+    // 先用已有的值取出键查找，只有键不存在时才构造元素
+    template <class _Vp>
+    std::pair<iterator, bool> _M_insert_value(_Vp &&__value) {
+        auto [__i, __inserted] =
+            this->_M_find_or_prepare_insert(_KeyOf()(__value));
+        if (__inserted) {
+            this->_M_construct_at(__i, std::forward<_Vp>(__value));
+        }
+        return {this->_M_iterator_at(__i), __inserted};
+    }
+
+    // 参数不是现成的值时，先在临时节点中构造出来才能拿到键
+    template <class... _Ts>
+    std::pair<iterator, bool> _M_single_emplace(_Ts &&...__value) {
+        if constexpr (sizeof...(_Ts) == 1 &&
+                      (std::is_same_v<std::remove_cvref_t<_Ts>, _Tp> && ...)) {
+            return this->_M_insert_value(std::forward<_Ts>(__value)...);
+        } else {
+            _HashTableNodeImpl<_Tp> __tmp;
+            __tmp._M_construct(std::forward<_Ts>(__value)...);
+            try {
+                auto __result =
+                    this->_M_insert_value(std::move(__tmp._M_value));
+                __tmp._M_destruct();
+                return __result;
+            } catch (...) {
+                __tmp._M_destruct();
+                throw;
+            }
+        }
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void _M_single_insert(_InputIt __first, _InputIt __last) {
+        while (__first != __last) {
+            this->_M_single_emplace(*__first);
+            ++__first;
+        }
+    }
+
+    template <class _Kv>
+    std::size_t _M_single_erase(_Kv const &__key) {
+        std::size_t __i = this->_M_find_index(__key, this->_M_hash_of(__key));
+        if (__i == _M_cap) {
+            return 0;
+        }
+        this->_M_erase_index(__i);
+        return 1;
+    }
+
+  public:
+    iterator begin() noexcept {
+        iterator __it(_M_ctrl, _M_slots);
+        __it._M_skip_empty();
+        return __it;
+    }
+
+    const_iterator begin() const noexcept {
+        const_iterator __it(_M_ctrl, _M_slots);
+        __it._M_skip_empty();
+        return __it;
+    }
+
+    const_iterator cbegin() const noexcept { return this->begin(); }
+
+    iterator end() noexcept { return this->_M_iterator_at(_M_cap); }
+
+    const_iterator end() const noexcept { return this->_M_iterator_at(_M_cap); }
+
+    const_iterator cend() const noexcept { return this->end(); }
+
+    bool empty() const noexcept { return _M_size == 0; }
+
+    std::size_t size() const noexcept { return _M_size; }
+
+    std::size_t bucket_count() const noexcept { return _M_cap; }
+
+    float load_factor() const noexcept {
+        return _M_cap == 0 ? 0.0f : float(_M_size) / float(_M_cap);
+    }
+
+    float max_load_factor() const noexcept { return 0.875f; }
+
+    _Hash hash_function() const { return _M_hash; }
+
+    _KeyEqual key_eq() const { return _M_eq; }
+
+    _Alloc get_allocator() const noexcept { return _M_alloc; }
+
+    void clear() noexcept {
+        if (_M_size == 0) {
+            return;
+        }
+        this->_M_destroy_slots();
+        std::memset(_M_ctrl, static_cast<unsigned char>(_Ctrl::_S_empty),
+                    _M_cap + _S_width);
+        _M_ctrl[_M_cap] = _Ctrl::_S_sentinel;
+        _M_size = 0;
+        _M_growth_left = _S_capacity_to_growth(_M_cap);
+    }
+
+    // 保证之后再插入 __n - size() 个元素都不会 rehash
+    void reserve(std::size_t __n) {
+        if (__n > _M_size + _M_growth_left) {
+            this->_M_resize(_S_normalize_capacity(_S_growth_to_capacity(__n)));
+        }
+    }
+
+    void rehash(std::size_t __n) {
+        if (__n == 0 && _M_size == 0) {
+            this->_M_deallocate_table(_M_ctrl, _M_cap);
+            this->_M_reset_empty();
+            return;
+        }
+        std::size_t __cap = _S_normalize_capacity(
+            std::max(__n, _S_growth_to_capacity(_M_size)));
+        if (__cap != _M_cap) {
+            this->_M_resize(__cap);
+        }
+    }
+
+    iterator erase(const_iterator __it) noexcept {
+        assert(__it != this->end());
+        std::size_t __i = __it._M_slot - _M_slots;
+        this->_M_erase_index(__i);
+        iterator __next = this->_M_iterator_at(__i);
+        __next._M_skip_empty();
+        return __next;
+    }
+
+    iterator erase(const_iterator __first, const_iterator __last) noexcept {
+        while (__first != __last) {
+            __first = this->erase(__first);
+        }
+        return this->_M_iterator_at(__last._M_slot - _M_slots);
+    }
+
+    node_type extract(const_iterator __it) {
+        assert(__it != this->end());
+        std::size_t __i = __it._M_slot - _M_slots;
+        typename node_type::_NodeAlloc __node_alloc(_M_alloc);
+        auto __node = std::allocator_traits<
+            typename node_type::_NodeAlloc>::allocate(__node_alloc, 1);
+        try {
+            __node->_M_construct(std::move(_M_slots[__i]));
+        } catch (...) {
+            std::allocator_traits<typename node_type::_NodeAlloc>::deallocate(
+                __node_alloc, __node, 1);
+            throw;
+        }
+        this->_M_erase_index(__i);
+        return node_type(__node, _M_alloc);
+    }
+
+    // 键已存在时节点保持原样，随 __nh 一起销毁
+    std::pair<iterator, bool> insert(node_type __nh) {
+        if (__nh.empty()) {
+            return {this->end(), false};
+        }
+        auto [__i, __inserted] =
+            this->_M_find_or_prepare_insert(_KeyOf()(__nh.value()));
+        if (__inserted) {
+            this->_M_construct_at(__i, std::move(__nh.value()));
+            __nh._M_release();
+        }
+        return {this->_M_iterator_at(__i), __inserted};
+    }
+
+    // 元素个数相同，且每个元素都能在对方中找到相等的元素
+    bool operator==(_HashTableImpl const &__that) const {
+        if (_M_size != __that._M_size) {
+            return false;
+        }
+        for (const_iterator __it = this->begin(); __it != this->end(); ++__it) {
+            const_iterator __found = __that._M_find(_KeyOf()(*__it));
+            if (__found == __that.end() || !(*__found == *__it)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif // !__HASHTABLE__
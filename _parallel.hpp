@@ -0,0 +1,78 @@
+#ifndef __PARALLEL__
+#define __PARALLEL__
+
+/*
+
+ -- fork-join 辅助 --
+
+ 容器的并行批量操作都按二分递归：每层把任务一分为二，一半交给新线程，
+ 一半留在当前线程，两边结束后再汇合。递归 __fork_depth() 层后不再分叉，
+ 叶子任务数不超过硬件线程数的两倍，不需要常驻的线程池。
+ 创建线程失败时退化为在当前线程上依次执行。
+
+ 每次分叉都新建一个 std::thread，只适合大批量的操作。随核数的加速比
+ 还没有测量过：map_bench 的 bench_parallel 会打印所用的线程数，
+ 需要在多核机器上运行才有意义。
+
+ 工作线程上分配的节点最后在调用线程上释放。分配器若按线程缓存内存，
+ 线程退出时必须把缓存交回去，否则每次批量操作都要向系统要新内存；
+ pool_allocator 会交给全局的孤儿链表，bench_parallel 打印了反复批量
+ 建树前后的 slab 数。
+
+*/
+
+#include <cstddef>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+namespace mstl {
+
+// 分叉的层数：2^层数 >= 硬件线程数，单核时为 0，不会创建线程
+inline std::size_t __fork_depth() noexcept {
+    std::size_t __threads = std::thread::hardware_concurrency();
+    std::size_t __depth = 0;
+    while ((std::size_t(1) << __depth) < __threads) {
+        ++__depth;
+    }
+    return __depth;
+}
+
+// 新线程上执行 __left，当前线程执行 __right，两者都结束后才返回。
+// 任一方抛出异常时，等另一方结束后重新抛出（__left 的优先）
+template <class _Left, class _Right>
+void __fork_join(_Left &&__left, _Right &&__right) {
+    std::exception_ptr __left_error, __right_error;
+    auto __run_left = [&]() noexcept {
+        try {
+            __left();
+        } catch (...) {
+            __left_error = std::current_exception();
+        }
+    };
+    std::thread __worker;
+    try {
+        __worker = std::thread(__run_left);
+    } catch (std::system_error const &) {
+        __run_left();
+    }
+    try {
+        __right();
+    } catch (...) {
+        __right_error = std::current_exception();
+    }
+    if (__worker.joinable()) {
+        __worker.join();
+    }
+    if (__left_error) {
+        std::rethrow_exception(__left_error);
+    }
+    if (__right_error) {
+        std::rethrow_exception(__right_error);
+    }
+}
+
+} // namespace mstl
+
+#endif // !__PARALLEL__
@@ -9,7 +9,10 @@
 */
 
 #include "_common.hpp"
+#include "_parallel.hpp"
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <memory>
 #include <type_traits>
@@ -25,15 +28,78 @@ enum _RbTreeChildDir {
     _S_right,
 };
 
+// 颜色存放在父节点指针的最低位，子节点方向由父节点的左右指针比较得出，
+// 每个节点的额外开销是三个指针
 struct _RbTreeNode {
-    _RbTreeNode *_M_left;     // 左子节点指针
-    _RbTreeNode *_M_right;    // 右子节点指针
-    _RbTreeNode *_M_parent;   // 父节点指针
-    _RbTreeNode **_M_pparent; // 父节点中指向本节点指针的指针
-    _RbTreeColor _M_color;    // 红或黑
+    _RbTreeNode *_M_left;           // 左子节点指针
+    _RbTreeNode *_M_right;          // 右子节点指针
+    std::uintptr_t _M_parent_color; // 父节点指针 | 颜色
+
+    _RbTreeNode *_M_parent() const noexcept {
+        return reinterpret_cast<_RbTreeNode *>(_M_parent_color &
+                                               ~std::uintptr_t(1));
+    }
+
+    _RbTreeColor _M_color() const noexcept {
+        return static_cast<_RbTreeColor>(_M_parent_color & 1);
+    }
+
+    void _M_set_parent(_RbTreeNode *__parent) noexcept {
+        _M_parent_color =
+            reinterpret_cast<std::uintptr_t>(__parent) | (_M_parent_color & 1);
+    }
+
+    void _M_set_color(_RbTreeColor __color) noexcept {
+        _M_parent_color = (_M_parent_color & ~std::uintptr_t(1)) | __color;
+    }
+
+    void _M_set_parent_color(_RbTreeNode *__parent,
+                             _RbTreeColor __color) noexcept {
+        _M_parent_color = reinterpret_cast<std::uintptr_t>(__parent) | __color;
+    }
+};
+
+static_assert(alignof(_RbTreeNode) >= 2, "no spare bit for the color");
+static_assert(sizeof(_RbTreeNode) == 3 * sizeof(void *));
+
+// 增强策略：_Node 是带附加字段的节点基类；树的形状每次改变后，受影响的
+// 节点按自下而上的顺序调用 _S_update，由左右子节点重新计算自己的字段
+struct _RbTreeNoAugment {
+    using _Node = _RbTreeNode;
+
+    static void _S_update(_RbTreeNode *) noexcept {}
+};
+
+struct _RbTreeSizeNode : _RbTreeNode {
+    std::size_t _M_size; // 以该节点为根的子树中的节点数
+};
+
+// 顺序统计：记录子树大小，按名次取元素、求名次都是 O(log n)
+struct _RbTreeSizeAugment {
+    using _Node = _RbTreeSizeNode;
+
+    static std::size_t _S_size(_RbTreeNode *__node) noexcept {
+        return __node == nullptr
+                   ? 0
+                   : static_cast<_RbTreeSizeNode *>(__node)->_M_size;
+    }
+
+    static void _S_update(_RbTreeNode *__node) noexcept {
+        static_cast<_RbTreeSizeNode *>(__node)->_M_size =
+            1 + _S_size(__node->_M_left) + _S_size(__node->_M_right);
+    }
 };
 
-template <class _Tp> struct _RbTreeNodeImpl : _RbTreeNode {
+template <class _Augment, class = void>
+struct _RbTreeHasSize : std::false_type {};
+
+template <class _Augment>
+struct _RbTreeHasSize<_Augment,
+                      decltype((void)_Augment::_S_size(nullptr))>
+    : std::true_type {};
+
+template <class _Tp, class _NodeBase = _RbTreeNode>
+struct _RbTreeNodeImpl : _NodeBase {
     union {
         _Tp _M_value;
     }; // union 可以阻止里面成员的自动初始化，方便不支持 _Tp() 默认构造的类型
@@ -50,13 +116,60 @@ template <class _Tp> struct _RbTreeNodeImpl : _RbTreeNode {
     ~_RbTreeNodeImpl() noexcept {}
 };
 
+// 用户策略看到的节点：自己的值、左右子节点（可能为空）和附加数据。
+// 节点内存不经过构造，附加数据只能是平凡类型，由 update 负责写入
+template <class _Tp, class _Data> struct _RbTreeDataNode : _RbTreeNode {
+    static_assert(std::is_trivially_copyable_v<_Data> &&
+                      std::is_trivially_destructible_v<_Data>,
+                  "augmentation data must be a trivial type");
+
+    _Data _M_data;
+
+    _Tp const &value() const noexcept {
+        return static_cast<_RbTreeNodeImpl<_Tp, _RbTreeDataNode> const *>(
+                   this)
+            ->_M_value;
+    }
+
+    _Data &data() noexcept { return _M_data; }
+
+    _Data const &data() const noexcept { return _M_data; }
+
+    _RbTreeDataNode const *left() const noexcept {
+        return static_cast<_RbTreeDataNode const *>(_M_left);
+    }
+
+    _RbTreeDataNode const *right() const noexcept {
+        return static_cast<_RbTreeDataNode const *>(_M_right);
+    }
+};
+
+// 把用户策略接到 _RbTreeImpl 上。_Policy 提供 data_type 和
+// static void update(node &) noexcept，后者由两个子节点的 data() 和
+// 自己的 value() 算出 node.data()，每次旋转和结构变化后自下而上调用
+template <class _Tp, class _Policy> struct _RbTreePolicyAugment {
+    using _Node = _RbTreeDataNode<_Tp, typename _Policy::data_type>;
+
+    static void _S_update(_RbTreeNode *__node) noexcept {
+        _Policy::update(*static_cast<_Node *>(__node));
+    }
+};
+
+// 除了根还缓存最左和最右节点，begin()、rbegin() 和从 end() 出发的
+// ++/-- 都不必从根往下走。空树时三者都是 nullptr
+struct _RbTreeRoot {
+    _RbTreeNode *_M_root;
+    _RbTreeNode *_M_leftmost;
+    _RbTreeNode *_M_rightmost;
+};
+
 template <bool> struct _RbTreeIteratorBase;
 
 template <> struct _RbTreeIteratorBase<false> {
   protected:
     union {
         _RbTreeNode *_M_node;
-        _RbTreeNode **_M_proot;
+        _RbTreeRoot *_M_proot;
     };
 
     bool _M_off_by_one;
@@ -64,10 +177,10 @@ template <> struct _RbTreeIteratorBase<false> {
     _RbTreeIteratorBase(_RbTreeNode *__node) noexcept
         : _M_node(__node), _M_off_by_one(false) {}
 
-    _RbTreeIteratorBase(_RbTreeNode **__proot) noexcept
+    _RbTreeIteratorBase(_RbTreeRoot *__proot) noexcept
         : _M_proot(__proot), _M_off_by_one(true) {}
 
-    template <class, class, class, class> friend struct _RbTreeImpl;
+    template <class, class, class, class, class> friend struct _RbTreeImpl;
 
     template <class, class, bool> friend struct _RbTreeIterator;
 
@@ -86,11 +199,8 @@ template <> struct _RbTreeIteratorBase<false> {
         // 为了支持 ++rbegin()
         if (_M_off_by_one) {
             _M_off_by_one = false;
-            _M_node = *_M_proot;
+            _M_node = _M_proot->_M_leftmost;
             assert(_M_node);
-            while (_M_node->_M_left != nullptr) {
-                _M_node = _M_node->_M_left;
-            }
             return;
         }
         assert(_M_node);
@@ -100,15 +210,16 @@ template <> struct _RbTreeIteratorBase<false> {
                 _M_node = _M_node->_M_left;
             }
         } else {
-            while (_M_node->_M_parent != nullptr &&
-                   _M_node->_M_pparent == &_M_node->_M_parent->_M_right) {
-                _M_node = _M_node->_M_parent;
+            _RbTreeNode *__parent = _M_node->_M_parent();
+            while (__parent != nullptr && _M_node == __parent->_M_right) {
+                _M_node = __parent;
+                __parent = _M_node->_M_parent();
             }
-            if (_M_node->_M_parent == nullptr) {
+            if (__parent == nullptr) {
                 _M_off_by_one = true;
                 return;
             }
-            _M_node = _M_node->_M_parent;
+            _M_node = __parent;
         }
     }
 
@@ -116,11 +227,8 @@ template <> struct _RbTreeIteratorBase<false> {
         // 为了支持 --end()
         if (_M_off_by_one) {
             _M_off_by_one = false;
-            _M_node = *_M_proot;
+            _M_node = _M_proot->_M_rightmost;
             assert(_M_node);
-            while (_M_node->_M_right != nullptr) {
-                _M_node = _M_node->_M_right;
-            }
             return;
         }
         assert(_M_node);
@@ -130,15 +238,16 @@ template <> struct _RbTreeIteratorBase<false> {
                 _M_node = _M_node->_M_right;
             }
         } else {
-            while (_M_node->_M_parent != nullptr &&
-                   _M_node->_M_pparent == &_M_node->_M_parent->_M_left) {
-                _M_node = _M_node->_M_parent;
+            _RbTreeNode *__parent = _M_node->_M_parent();
+            while (__parent != nullptr && _M_node == __parent->_M_left) {
+                _M_node = __parent;
+                __parent = _M_node->_M_parent();
             }
-            if (_M_node->_M_parent == nullptr) {
+            if (__parent == nullptr) {
                 _M_off_by_one = true;
                 return;
             }
-            _M_node = _M_node->_M_parent;
+            _M_node = __parent;
         }
     }
 
@@ -234,14 +343,28 @@ struct _RbTreeIterator : _RbTreeIteratorBase<_Reverse> {
     using pointer = _Tp *;
 };
 
-struct _RbTreeRoot {
-    _RbTreeNode *_M_root;
+// 游标记录的路径：_M_nodes[0] 是根，路径的末端是上一次查找的结果（结果
+// 是 end() 时为最后经过的节点），_M_depth 为 0 表示还没有路径。
+// _M_turns[1] 按从上到下的顺序记录往左拐的层，_M_turns[0] 记录往右拐的
+struct _RbTreePath {
+    // 红黑树的高度不超过 2 log2(n + 1)
+    static constexpr std::size_t _S_max_depth = 2 * 64;
+
+    _RbTreeNode *_M_nodes[_S_max_depth];
+    unsigned char _M_turns[2][_S_max_depth];
+    std::size_t _M_count[2];
+    std::size_t _M_depth = 0;
+
+    void _M_reset() noexcept { _M_depth = 0; }
 };
 
-struct _RbTreeBase {
+template <class _Augment> struct _RbTreeBase {
   protected:
     _RbTreeRoot *_M_block;
 
+    static constexpr bool _S_augmented =
+        !std::is_same_v<_Augment, _RbTreeNoAugment>;
+
     explicit _RbTreeBase(_RbTreeRoot *__block) : _M_block(__block) {}
 
     template <class _Type, class _Alloc>
@@ -249,7 +372,7 @@ struct _RbTreeBase {
         typename std::allocator_traits<_Alloc>::template rebind_alloc<_Type>
             __rebind_alloc(__alloc);
         return std::allocator_traits<_Alloc>::template rebind_traits<
-            _Type>::allocate(__rebind_alloc, sizeof(_Type));
+            _Type>::allocate(__rebind_alloc, 1);
     }
 
     template <class _Type, class _Alloc>
@@ -257,86 +380,104 @@ struct _RbTreeBase {
         typename std::allocator_traits<_Alloc>::template rebind_alloc<_Type>
             __rebind_alloc(__alloc);
         std::allocator_traits<_Alloc>::template rebind_traits<
-            _Type>::deallocate(__rebind_alloc, static_cast<_Type *>(__ptr),
-                               sizeof(_Type));
+            _Type>::deallocate(__rebind_alloc, static_cast<_Type *>(__ptr), 1);
+    }
+
+    // 父节点中指向 __node 的那个指针；根节点对应 _M_block->_M_root
+    _RbTreeNode **_M_child_link(_RbTreeNode *__node,
+                                _RbTreeNode *__parent) const noexcept {
+        if (__parent == nullptr) {
+            return &_M_block->_M_root;
+        }
+        return __node == __parent->_M_left ? &__parent->_M_left
+                                           : &__parent->_M_right;
     }
 
-    static void _M_rotate_left(_RbTreeNode *__node) noexcept {
+    void _M_rotate_left(_RbTreeNode *__node) noexcept {
         _RbTreeNode *__right = __node->_M_right;
+        _RbTreeNode *__parent = __node->_M_parent();
+        *this->_M_child_link(__node, __parent) = __right;
         __node->_M_right = __right->_M_left;
         if (__right->_M_left != nullptr) {
-            __right->_M_left->_M_parent = __node;
-            __right->_M_left->_M_pparent = &__node->_M_right;
+            __right->_M_left->_M_set_parent(__node);
         }
-        __right->_M_parent = __node->_M_parent;
-        __right->_M_pparent = __node->_M_pparent;
-        *__node->_M_pparent = __right;
+        __right->_M_set_parent(__parent);
         __right->_M_left = __node;
-        __node->_M_parent = __right;
-        __node->_M_pparent = &__right->_M_left;
+        __node->_M_set_parent(__right);
+        _Augment::_S_update(__node);
+        _Augment::_S_update(__right);
     }
 
-    static void _M_rotate_right(_RbTreeNode *__node) noexcept {
+    void _M_rotate_right(_RbTreeNode *__node) noexcept {
         _RbTreeNode *__left = __node->_M_left;
+        _RbTreeNode *__parent = __node->_M_parent();
+        *this->_M_child_link(__node, __parent) = __left;
         __node->_M_left = __left->_M_right;
         if (__left->_M_right != nullptr) {
-            __left->_M_right->_M_parent = __node;
-            __left->_M_right->_M_pparent = &__node->_M_left;
+            __left->_M_right->_M_set_parent(__node);
         }
-        __left->_M_parent = __node->_M_parent;
-        __left->_M_pparent = __node->_M_pparent;
-        *__node->_M_pparent = __left;
+        __left->_M_set_parent(__parent);
         __left->_M_right = __node;
-        __node->_M_parent = __left;
-        __node->_M_pparent = &__left->_M_right;
+        __node->_M_set_parent(__left);
+        _Augment::_S_update(__node);
+        _Augment::_S_update(__left);
     }
 
-    static void _M_fix_violation(_RbTreeNode *__node) noexcept {
+    // 从 __node 到根逐个重新计算增强字段
+    static void _M_update_path(_RbTreeNode *__node) noexcept {
+        if constexpr (_S_augmented) {
+            for (; __node != nullptr; __node = __node->_M_parent()) {
+                _Augment::_S_update(__node);
+            }
+        }
+    }
+
+    // 返回根是否由红染黑，也就是整棵树的黑高是否加一
+    bool _M_fix_violation(_RbTreeNode *__node) noexcept {
         while (true) {
-            _RbTreeNode *__parent = __node->_M_parent;
+            _RbTreeNode *__parent = __node->_M_parent();
             if (__parent == nullptr) { // 根节点的 __parent 总是 nullptr
                 // 情况 0: __node == root
-                __node->_M_color = _S_black;
-                return;
+                bool __grown = __node->_M_color() == _S_red;
+                __node->_M_set_color(_S_black);
+                return __grown;
             }
-            if (__node->_M_color == _S_black ||
-                __parent->_M_color == _S_black) {
-                return;
+            if (__node->_M_color() == _S_black ||
+                __parent->_M_color() == _S_black) {
+                return false;
             }
             _RbTreeNode *__uncle;
-            _RbTreeNode *__grandpa = __parent->_M_parent;
+            _RbTreeNode *__grandpa = __parent->_M_parent();
             assert(__grandpa);
             _RbTreeChildDir __parent_dir =
-                __parent->_M_pparent == &__grandpa->_M_left ? _S_left
-                                                            : _S_right;
+                __parent == __grandpa->_M_left ? _S_left : _S_right;
             if (__parent_dir == _S_left) {
                 __uncle = __grandpa->_M_right;
             } else {
-                assert(__parent->_M_pparent == &__grandpa->_M_right);
+                assert(__parent == __grandpa->_M_right);
                 __uncle = __grandpa->_M_left;
             }
             _RbTreeChildDir __node_dir =
-                __node->_M_pparent == &__parent->_M_left ? _S_left : _S_right;
-            if (__uncle != nullptr && __uncle->_M_color == _S_red) {
+                __node == __parent->_M_left ? _S_left : _S_right;
+            if (__uncle != nullptr && __uncle->_M_color() == _S_red) {
                 // 情况 1: 叔叔是红色人士
-                __parent->_M_color = _S_black;
-                __uncle->_M_color = _S_black;
-                __grandpa->_M_color = _S_red;
+                __parent->_M_set_color(_S_black);
+                __uncle->_M_set_color(_S_black);
+                __grandpa->_M_set_color(_S_red);
                 __node = __grandpa;
             } else if (__node_dir == __parent_dir) {
                 if (__node_dir == _S_right) {
-                    assert(__node->_M_pparent == &__parent->_M_right);
                     // 情况 2: 叔叔是黑色人士（RR）
                     _RbTreeBase::_M_rotate_left(__grandpa);
                 } else {
                     // 情况 3: 叔叔是黑色人士（LL）
                     _RbTreeBase::_M_rotate_right(__grandpa);
                 }
-                std::swap(__parent->_M_color, __grandpa->_M_color);
+                __parent->_M_set_color(__grandpa->_M_color());
+                __grandpa->_M_set_color(_S_red);
                 __node = __grandpa;
             } else {
                 if (__node_dir == _S_right) {
-                    assert(__node->_M_pparent == &__parent->_M_right);
                     // 情况 4: 叔叔是黑色人士（LR）
                     _RbTreeBase::_M_rotate_left(__parent);
                 } else {
@@ -348,24 +489,25 @@ struct _RbTreeBase {
         }
     }
 
-    _RbTreeNode *_M_min_node() const noexcept {
-        _RbTreeNode *__current = _M_block->_M_root;
-        if (__current != nullptr) {
-            while (__current->_M_left != nullptr) {
-                __current = __current->_M_left;
-            }
-        }
-        return __current;
-    }
+    _RbTreeNode *_M_min_node() const noexcept { return _M_block->_M_leftmost; }
 
     _RbTreeNode *_M_max_node() const noexcept {
-        _RbTreeNode *__current = _M_block->_M_root;
-        if (__current != nullptr) {
-            while (__current->_M_right != nullptr) {
-                __current = __current->_M_right;
+        return _M_block->_M_rightmost;
+    }
+
+    // 整棵树一次换掉（建树、克隆、清空）以后重新找最左和最右节点
+    void _M_reset_root(_RbTreeNode *__root) noexcept {
+        _M_block->_M_root = __root;
+        _M_block->_M_leftmost = __root;
+        _M_block->_M_rightmost = __root;
+        if (__root != nullptr) {
+            while (_M_block->_M_leftmost->_M_left != nullptr) {
+                _M_block->_M_leftmost = _M_block->_M_leftmost->_M_left;
+            }
+            while (_M_block->_M_rightmost->_M_right != nullptr) {
+                _M_block->_M_rightmost = _M_block->_M_rightmost->_M_right;
             }
         }
-        return __current;
     }
 
     template <class _NodeImpl, class _Tv, class _Compare>
@@ -388,6 +530,64 @@ struct _RbTreeBase {
         return nullptr;
     }
 
+    // 成批查找：每次取 _S_batch_width 个键轮流下降，每个键每轮下降一层
+    // 并预取它的下一个节点，几条查找路径上的缓存缺失可以重叠。
+    // 每个键的比较顺序与 _M_find_node 相同，按输入顺序调用 __emit(结果)。
+    // 黑高不到 _S_batch_height（几万个节点以内）的树基本在缓存里，
+    // 交错只多出记账的开销，直接逐个查找
+    static constexpr std::size_t _S_batch_width = 8;
+    static constexpr std::size_t _S_batch_height = 9;
+
+    template <class _NodeImpl, class _KeyIt, class _Compare, class _Emit>
+    void _M_find_nodes(_KeyIt __first, _KeyIt __last, _Compare __comp,
+                       _Emit &&__emit) const {
+        if (_RbTreeBase::_S_black_height(_M_block->_M_root) <
+            _S_batch_height) {
+            for (; __first != __last; ++__first) {
+                __emit(this->_M_find_node<_NodeImpl>(*__first, __comp));
+            }
+            return;
+        }
+        _KeyIt __keys[_S_batch_width];
+        _RbTreeNode *__nodes[_S_batch_width];
+        while (__first != __last) {
+            std::size_t __n = 0;
+            for (; __n < _S_batch_width && __first != __last; ++__first) {
+                __keys[__n] = __first;
+                __nodes[__n++] = _M_block->_M_root;
+            }
+            // __pending 的第 i 位表示第 i 个键还没有查完
+            unsigned __pending = (1u << __n) - 1;
+            while (__pending != 0) {
+                for (std::size_t __i = 0; __i < __n; ++__i) {
+                    if (!(__pending >> __i & 1u)) {
+                        continue;
+                    }
+                    _RbTreeNode *__current = __nodes[__i];
+                    auto const &__value =
+                        static_cast<_NodeImpl *>(__current)->_M_value;
+                    if (__comp(*__keys[__i], __value)) {
+                        __current = __current->_M_left;
+                    } else if (__comp(__value, *__keys[__i])) {
+                        __current = __current->_M_right;
+                    } else {
+                        __pending &= ~(1u << __i);
+                        continue;
+                    }
+                    __nodes[__i] = __current;
+                    if (__current == nullptr) {
+                        __pending &= ~(1u << __i);
+                    } else {
+                        _LIBPENGCXX_PREFETCH(__current);
+                    }
+                }
+            }
+            for (std::size_t __i = 0; __i < __n; ++__i) {
+                __emit(__nodes[__i]);
+            }
+        }
+    }
+
     template <class _NodeImpl, class _Tv, class _Compare>
     _RbTreeNode *_M_lower_bound(_Tv &&__value, _Compare __comp) const noexcept {
         _RbTreeNode *__current = _M_block->_M_root;
@@ -421,6 +621,152 @@ struct _RbTreeBase {
         return __result;
     }
 
+    // 从 __finger 往上爬的层数上限，超过时改为从根查找。根附近的几层
+    // 总在缓存里，从根往下走比沿父指针爬上去再下来更快
+    static constexpr std::size_t _S_finger_climb = 4;
+
+    // 从 __finger 出发的 lower_bound（_Upper 时为 upper_bound），__finger
+    // 为空表示 end()。沿父指针往上爬，直到遇到不在 __finger 与结果之间的
+    // 祖先，再从最后一个被越过的祖先往下走。结果在 __finger 附近时只经过
+    // 几层；爬了 _S_finger_climb 层还没到头时改为从根查找，所以最多比
+    // 从根查找多走这几层
+    template <class _NodeImpl, bool _Upper, class _Tv, class _Compare>
+    _RbTreeNode *_M_finger_bound(_RbTreeNode *__finger, _Tv const &__value,
+                                 _Compare __comp) const noexcept {
+        // 节点排在结果之前
+        auto __before = [&](_RbTreeNode *__node) {
+            auto const &__cur = static_cast<_NodeImpl *>(__node)->_M_value;
+            return _Upper ? !__comp(__value, __cur) : __comp(__cur, __value);
+        };
+        _RbTreeNode *__node =
+            __finger != nullptr ? __finger : _M_block->_M_rightmost;
+        if (__node == nullptr) {
+            return nullptr;
+        }
+        bool __forward = __before(__node);
+        // 顺序处理时常见的两头：已经越过最大的，或者还没到最小的
+        if (__forward && __node == _M_block->_M_rightmost) {
+            return nullptr;
+        }
+        if (!__forward && __node == _M_block->_M_leftmost) {
+            return __node;
+        }
+        // __from 是已知被越过的最深的节点：往后找时它在结果之前，
+        // 结果在它的右子树里；往前找时它就是候选结果，更好的在左子树里
+        _RbTreeNode *__from = __node;
+        _RbTreeNode *__result = __forward ? nullptr : __node;
+        std::size_t __climb = 0;
+        for (_RbTreeNode *__parent = __node->_M_parent(); __parent != nullptr;
+             __node = __parent, __parent = __parent->_M_parent()) {
+            if (++__climb > _S_finger_climb) {
+                return _Upper
+                           ? this->_M_upper_bound<_NodeImpl>(__value, __comp)
+                           : this->_M_lower_bound<_NodeImpl>(__value, __comp);
+            }
+            if (__forward && __node == __parent->_M_left) {
+                // __parent 比整棵子树都大，它不在结果之前时不必再往上
+                if (!__before(__parent)) {
+                    __result = __parent;
+                    break;
+                }
+                __from = __parent;
+            } else if (!__forward && __node == __parent->_M_right) {
+                if (__before(__parent)) {
+                    break;
+                }
+                __from = __result = __parent;
+            }
+        }
+        __node = __forward ? __from->_M_right : __from->_M_left;
+        while (__node != nullptr) {
+            if (__before(__node)) {
+                __node = __node->_M_right;
+            } else {
+                __result = __node;
+                __node = __node->_M_left;
+            }
+        }
+        return __result;
+    }
+
+    // 沿 __path 做 lower_bound（_Upper 时为 upper_bound），并把路径改成
+    // 这次查找的路径。路径上的祖先都在数组里，不必读父指针：从末端往回
+    // 退，只和拐弯方向可能挡住目标的祖先比较（往后找时是往左拐的，往前
+    // 找时是往右拐的），退到从根查找也会经过的那一层为止，再往下走。
+    // 往下走的部分和从根查找的最后几层完全相同
+    template <class _NodeImpl, bool _Upper, class _Tv, class _Compare>
+    _RbTreeNode *_M_path_bound(_RbTreePath &__path, _Tv const &__value,
+                               _Compare __comp) const noexcept {
+        auto __before = [&](_RbTreeNode *__node) {
+            auto const &__cur = static_cast<_NodeImpl *>(__node)->_M_value;
+            return _Upper ? !__comp(__value, __cur) : __comp(__cur, __value);
+        };
+        _RbTreeNode **__nodes = __path._M_nodes;
+        unsigned char *__lefts = __path._M_turns[1];
+        unsigned char *__rights = __path._M_turns[0];
+        _RbTreeNode *__result = nullptr;
+        _RbTreeNode *__node = _M_block->_M_root;
+        std::size_t __depth = 0;
+        if (__path._M_depth == 0) {
+            __path._M_count[0] = __path._M_count[1] = 0;
+        } else {
+            // __from 是已知被越过的最深的一层，见 _M_finger_bound
+            std::size_t __from = __path._M_depth - 1;
+            bool __forward = __before(__nodes[__from]);
+            unsigned char *__block = __path._M_turns[__forward];
+            std::size_t &__nblock = __path._M_count[__forward];
+            while (__nblock != 0 &&
+                   __before(__nodes[__block[__nblock - 1]]) == __forward) {
+                __from = __block[--__nblock];
+            }
+            if (!__forward) {
+                __result = __nodes[__from];
+            } else if (__nblock != 0) {
+                __result = __nodes[__block[__nblock - 1]];
+            }
+            // 另一个方向上比 __from 深的拐弯不再属于路径，再记下 __from 处
+            // 这一次的拐弯
+            unsigned char *__other = __path._M_turns[!__forward];
+            std::size_t &__nother = __path._M_count[!__forward];
+            while (__nother != 0 && __other[__nother - 1] >= __from) {
+                --__nother;
+            }
+            __other[__nother++] = static_cast<unsigned char>(__from);
+            __node = __forward ? __nodes[__from]->_M_right
+                               : __nodes[__from]->_M_left;
+            __depth = __from + 1;
+        }
+        std::size_t __nleft = __path._M_count[1];
+        std::size_t __nright = __path._M_count[0];
+        while (__node != nullptr) {
+            __nodes[__depth] = __node;
+            if (__before(__node)) {
+                __rights[__nright++] = static_cast<unsigned char>(__depth);
+                __node = __node->_M_right;
+            } else {
+                __lefts[__nleft++] = static_cast<unsigned char>(__depth);
+                __result = __node;
+                __node = __node->_M_left;
+            }
+            ++__depth;
+        }
+        // 结果总是最后一次往左拐的节点，路径截到它为止；没有结果时末端
+        // 最后一次往右拐，丢掉这一次
+        if (__result != nullptr) {
+            __depth = __lefts[--__nleft];
+            while (__nright != 0 && __rights[__nright - 1] > __depth) {
+                --__nright;
+            }
+            ++__depth;
+        } else if (__nright != 0) {
+            --__nright;
+        }
+        __path._M_depth = __depth;
+        __path._M_count[0] = __nright;
+        __path._M_count[1] = __nleft;
+        return __result;
+    }
+
     template <class _NodeImpl, class _Tv, class _Compare>
     std::pair<_RbTreeNode *, _RbTreeNode *>
     _M_equal_range(_Tv &&__value, _Compare __comp) const noexcept {
@@ -428,143 +774,259 @@ struct _RbTreeBase {
                 this->_M_upper_bound<_NodeImpl>(__value, __comp)};
     }
 
-    static void _M_transplant(_RbTreeNode *__node,
-                              _RbTreeNode *__replace) noexcept {
-        *__node->_M_pparent = __replace;
-        if (__replace != nullptr) {
-            __replace->_M_parent = __node->_M_parent;
-            __replace->_M_pparent = __node->_M_pparent;
+    // 中序第 __k 个节点（从 0 开始）。这一组函数要求 _Augment 记录子树大小
+    _RbTreeNode *_M_nth_node(std::size_t __k) const noexcept {
+        _RbTreeNode *__current = _M_block->_M_root;
+        while (__current != nullptr) {
+            std::size_t __left = _Augment::_S_size(__current->_M_left);
+            if (__k < __left) {
+                __current = __current->_M_left;
+            } else if (__k == __left) {
+                return __current;
+            } else {
+                __k -= __left + 1;
+                __current = __current->_M_right;
+            }
         }
+        return nullptr;
     }
 
-    static void _M_delete_fixup(_RbTreeNode *__node) noexcept {
-        if (__node == nullptr) {
-            return;
+    // 小于 __value 的元素个数，_Upper 时为不大于 __value 的元素个数
+    template <class _NodeImpl, bool _Upper, class _Tv, class _Compare>
+    std::size_t _M_rank(_Tv &&__value, _Compare __comp) const noexcept {
+        _RbTreeNode *__current = _M_block->_M_root;
+        std::size_t __rank = 0;
+        while (__current != nullptr) {
+            auto const &__cur = static_cast<_NodeImpl *>(__current)->_M_value;
+            if (_Upper ? !__comp(__value, __cur) : __comp(__cur, __value)) {
+                __rank += _Augment::_S_size(__current->_M_left) + 1;
+                __current = __current->_M_right;
+            } else {
+                __current = __current->_M_left;
+            }
+        }
+        return __rank;
+    }
+
+    // __node 之前的元素个数：自下而上累加所有左侧子树
+    static std::size_t _M_node_rank(_RbTreeNode *__node) noexcept {
+        std::size_t __rank = _Augment::_S_size(__node->_M_left);
+        for (_RbTreeNode *__parent = __node->_M_parent(); __parent != nullptr;
+             __node = __parent, __parent = __parent->_M_parent()) {
+            if (__node == __parent->_M_right) {
+                __rank += _Augment::_S_size(__parent->_M_left) + 1;
+            }
+        }
+        return __rank;
+    }
+
+    void _M_transplant(_RbTreeNode *__node, _RbTreeNode *__replace) noexcept {
+        _RbTreeNode *__parent = __node->_M_parent();
+        *this->_M_child_link(__node, __parent) = __replace;
+        if (__replace != nullptr) {
+            __replace->_M_set_parent(__parent);
         }
-        while (__node->_M_parent != nullptr && __node->_M_color == _S_black) {
+    }
+
+    static bool _M_is_black(_RbTreeNode *__node) noexcept {
+        return __node == nullptr || __node->_M_color() == _S_black;
+    }
+
+    // __node 可能是空叶子，因此由调用者给出它的父节点
+    void _M_delete_fixup(_RbTreeNode *__node, _RbTreeNode *__parent) noexcept {
+        while (__parent != nullptr && _RbTreeBase::_M_is_black(__node)) {
             _RbTreeChildDir __dir =
-                __node->_M_pparent == &__node->_M_parent->_M_left ? _S_left
-                                                                  : _S_right;
-            _RbTreeNode *__sibling = __dir == _S_left
-                                         ? __node->_M_parent->_M_right
-                                         : __node->_M_parent->_M_left;
-            if (__sibling->_M_color == _S_red) {
-                __sibling->_M_color = _S_black;
-                __node->_M_parent->_M_color = _S_red;
+                __node == __parent->_M_left ? _S_left : _S_right;
+            _RbTreeNode *__sibling =
+                __dir == _S_left ? __parent->_M_right : __parent->_M_left;
+            if (__sibling->_M_color() == _S_red) {
+                __sibling->_M_set_color(_S_black);
+                __parent->_M_set_color(_S_red);
                 if (__dir == _S_left) {
-                    _RbTreeBase::_M_rotate_left(__node->_M_parent);
+                    _RbTreeBase::_M_rotate_left(__parent);
                 } else {
-                    _RbTreeBase::_M_rotate_right(__node->_M_parent);
+                    _RbTreeBase::_M_rotate_right(__parent);
                 }
-                __sibling = __dir == _S_left ? __node->_M_parent->_M_right
-                                             : __node->_M_parent->_M_left;
+                __sibling =
+                    __dir == _S_left ? __parent->_M_right : __parent->_M_left;
             }
-            if (__sibling->_M_left->_M_color == _S_black &&
-                __sibling->_M_right->_M_color == _S_black) {
-                __sibling->_M_color = _S_red;
-                __node = __node->_M_parent;
+            if (_RbTreeBase::_M_is_black(__sibling->_M_left) &&
+                _RbTreeBase::_M_is_black(__sibling->_M_right)) {
+                __sibling->_M_set_color(_S_red);
+                __node = __parent;
+                __parent = __node->_M_parent();
             } else {
                 if (__dir == _S_left &&
-                    __sibling->_M_right->_M_color == _S_black) {
-                    __sibling->_M_left->_M_color = _S_black;
-                    __sibling->_M_color = _S_red;
+                    _RbTreeBase::_M_is_black(__sibling->_M_right)) {
+                    __sibling->_M_left->_M_set_color(_S_black);
+                    __sibling->_M_set_color(_S_red);
                     _RbTreeBase::_M_rotate_right(__sibling);
-                    __sibling = __node->_M_parent->_M_right;
+                    __sibling = __parent->_M_right;
                 } else if (__dir == _S_right &&
-                           __sibling->_M_left->_M_color == _S_black) {
-                    __sibling->_M_right->_M_color = _S_black;
-                    __sibling->_M_color = _S_red;
+                           _RbTreeBase::_M_is_black(__sibling->_M_left)) {
+                    __sibling->_M_right->_M_set_color(_S_black);
+                    __sibling->_M_set_color(_S_red);
                     _RbTreeBase::_M_rotate_left(__sibling);
-                    __sibling = __node->_M_parent->_M_left;
+                    __sibling = __parent->_M_left;
                 }
-                __sibling->_M_color = __node->_M_parent->_M_color;
-                __node->_M_parent->_M_color = _S_black;
+                __sibling->_M_set_color(__parent->_M_color());
+                __parent->_M_set_color(_S_black);
                 if (__dir == _S_left) {
-                    __sibling->_M_right->_M_color = _S_black;
-                    _RbTreeBase::_M_rotate_left(__node->_M_parent);
+                    __sibling->_M_right->_M_set_color(_S_black);
+                    _RbTreeBase::_M_rotate_left(__parent);
                 } else {
-                    __sibling->_M_left->_M_color = _S_black;
-                    _RbTreeBase::_M_rotate_right(__node->_M_parent);
+                    __sibling->_M_left->_M_set_color(_S_black);
+                    _RbTreeBase::_M_rotate_right(__parent);
                 }
-                // while (__node->_M_parent != nullptr) {
-                //     __node = __node->_M_parent;
-                // }
-                break;
+                return;
             }
         }
-        __node->_M_color = _S_black;
+        if (__node != nullptr) {
+            __node->_M_set_color(_S_black);
+        }
     }
 
-    static void _M_erase_node(_RbTreeNode *__node) noexcept {
+    void _M_erase_node(_RbTreeNode *__node) noexcept {
+        // 最左节点没有左孩子，后继就是右孩子或父节点，都是 O(1)
+        if (__node == _M_block->_M_leftmost) {
+            _M_block->_M_leftmost = _RbTreeBase::_M_next_node(__node);
+        }
+        if (__node == _M_block->_M_rightmost) {
+            _M_block->_M_rightmost = _RbTreeBase::_M_prev_node(__node);
+        }
+        _RbTreeNode *__child;
+        _RbTreeNode *__parent;
+        _RbTreeColor __color;
         if (__node->_M_left == nullptr) {
-            _RbTreeNode *__right = __node->_M_right;
-            _RbTreeColor __color = __node->_M_color;
-            _RbTreeBase::_M_transplant(__node, __right);
-            if (__color == _S_black) {
-                _RbTreeBase::_M_delete_fixup(__right);
-            }
+            __child = __node->_M_right;
+            __parent = __node->_M_parent();
+            __color = __node->_M_color();
+            _RbTreeBase::_M_transplant(__node, __child);
         } else if (__node->_M_right == nullptr) {
-            _RbTreeNode *__left = __node->_M_left;
-            _RbTreeColor __color = __node->_M_color;
-            _RbTreeBase::_M_transplant(__node, __left);
-            if (__color == _S_black) {
-                _RbTreeBase::_M_delete_fixup(__left);
-            }
+            __child = __node->_M_left;
+            __parent = __node->_M_parent();
+            __color = __node->_M_color();
+            _RbTreeBase::_M_transplant(__node, __child);
         } else {
             _RbTreeNode *__replace = __node->_M_right;
             while (__replace->_M_left != nullptr) {
                 __replace = __replace->_M_left;
             }
-            _RbTreeNode *__right = __replace->_M_right;
-            _RbTreeColor __color = __replace->_M_color;
-            if (__replace->_M_parent == __node) {
-                if (__right != nullptr) {
-                    __right->_M_parent = __replace;
-                    __right->_M_pparent = &__replace->_M_right;
-                }
+            __child = __replace->_M_right;
+            __color = __replace->_M_color();
+            if (__replace->_M_parent() == __node) {
+                __parent = __replace;
             } else {
-                _RbTreeBase::_M_transplant(__replace, __right);
+                __parent = __replace->_M_parent();
+                _RbTreeBase::_M_transplant(__replace, __child);
                 __replace->_M_right = __node->_M_right;
-                __replace->_M_right->_M_parent = __replace;
-                __replace->_M_right->_M_pparent = &__replace->_M_right;
+                __replace->_M_right->_M_set_parent(__replace);
             }
             _RbTreeBase::_M_transplant(__node, __replace);
             __replace->_M_left = __node->_M_left;
-            __replace->_M_left->_M_parent = __replace;
-            __replace->_M_left->_M_pparent = &__replace->_M_left;
-            if (__color == _S_black) {
-                _RbTreeBase::_M_delete_fixup(__right);
-            }
+            __replace->_M_left->_M_set_parent(__replace);
+            __replace->_M_set_color(__node->_M_color());
+        }
+        _RbTreeBase::_M_update_path(__parent);
+        if (__color == _S_black) {
+            _RbTreeBase::_M_delete_fixup(__child, __parent);
         }
     }
 
-    template <class _NodeImpl, class _Compare>
-    _RbTreeNode *_M_single_insert_node(_RbTreeNode *__node, _Compare __comp) {
+    // 把按中序串在 _M_right 上的 __n 个节点建成平衡树。左右子树大小至多
+    // 相差一，空叶子只出现在最深的两层；最深一层不满时把它染成红色，
+    // 所有路径的黑高就相等了
+    static _RbTreeNode *_M_build_balanced(_RbTreeNode *__list,
+                                          std::size_t __n) noexcept {
+        if (__n == 0) {
+            return nullptr;
+        }
+        std::size_t __depth = 0;
+        while ((__n >> (__depth + 1)) != 0) {
+            ++__depth;
+        }
+        std::size_t __red_depth =
+            (__n & (__n + 1)) == 0 ? std::size_t(-1) : __depth;
+        _RbTreeNode *__root =
+            _RbTreeBase::_M_build_subtree(__list, __n, 0, __red_depth);
+        __root->_M_set_parent_color(nullptr, _S_black);
+        return __root;
+    }
+
+    static _RbTreeNode *_M_build_subtree(_RbTreeNode *&__list, std::size_t __n,
+                                         std::size_t __depth,
+                                         std::size_t __red_depth) noexcept {
+        if (__n == 0) {
+            return nullptr;
+        }
+        std::size_t __left_n = __n / 2;
+        _RbTreeNode *__left = _RbTreeBase::_M_build_subtree(
+            __list, __left_n, __depth + 1, __red_depth);
+        _RbTreeNode *__node = __list;
+        __list = __list->_M_right;
+        __node->_M_set_parent_color(
+            nullptr, __depth == __red_depth ? _S_red : _S_black);
+        __node->_M_left = __left;
+        if (__left != nullptr) {
+            __left->_M_set_parent(__node);
+        }
+        __node->_M_right = _RbTreeBase::_M_build_subtree(
+            __list, __n - 1 - __left_n, __depth + 1, __red_depth);
+        if (__node->_M_right != nullptr) {
+            __node->_M_right->_M_set_parent(__node);
+        }
+        _Augment::_S_update(__node);
+        return __node;
+    }
+
+    void _M_link_node(_RbTreeNode *__node, _RbTreeNode *__parent,
+                      _RbTreeNode **__link) noexcept {
+        __node->_M_left = nullptr;
+        __node->_M_right = nullptr;
+        __node->_M_set_parent_color(__parent, _S_red);
+        *__link = __node;
+        if (__parent == nullptr) {
+            _M_block->_M_leftmost = __node;
+            _M_block->_M_rightmost = __node;
+        } else if (__link == &_M_block->_M_leftmost->_M_left) {
+            _M_block->_M_leftmost = __node;
+        } else if (__link == &_M_block->_M_rightmost->_M_right) {
+            _M_block->_M_rightmost = __node;
+        }
+        _RbTreeBase::_M_update_path(__node);
+        _RbTreeBase::_M_fix_violation(__node);
+    }
+
+    // 找到与 __key 等价的节点时返回 {该节点, nullptr}，否则返回
+    // {新节点的父节点, 父节点中指向新节点的指针}
+    template <class _NodeImpl, class _Kv, class _Compare>
+    std::pair<_RbTreeNode *, _RbTreeNode **>
+    _M_find_insert_pos(_Kv const &__key, _Compare __comp) const noexcept {
         _RbTreeNode **__pparent = &_M_block->_M_root;
         _RbTreeNode *__parent = nullptr;
         while (*__pparent != nullptr) {
             __parent = *__pparent;
-            if (__comp(static_cast<_NodeImpl *>(__node)->_M_value,
-                       static_cast<_NodeImpl *>(__parent)->_M_value)) {
+            if (__comp(__key, static_cast<_NodeImpl *>(__parent)->_M_value)) {
                 __pparent = &__parent->_M_left;
                 continue;
             }
-            if (__comp(static_cast<_NodeImpl *>(__parent)->_M_value,
-                       static_cast<_NodeImpl *>(__node)->_M_value)) {
+            if (__comp(static_cast<_NodeImpl *>(__parent)->_M_value, __key)) {
                 __pparent = &__parent->_M_right;
                 continue;
             }
-            return __parent;
+            return {__parent, nullptr};
         }
+        return {__parent, __pparent};
+    }
 
-        __node->_M_left = nullptr;
-        __node->_M_right = nullptr;
-        __node->_M_color = _S_red;
-
-        __node->_M_parent = __parent;
-        __node->_M_pparent = __pparent;
-        *__pparent = __node;
-        _RbTreeBase::_M_fix_violation(__node);
+    template <class _NodeImpl, class _Compare>
+    _RbTreeNode *_M_single_insert_node(_RbTreeNode *__node, _Compare __comp) {
+        auto [__parent, __link] = this->_M_find_insert_pos<_NodeImpl>(
+            static_cast<_NodeImpl *>(__node)->_M_value, __comp);
+        if (__link == nullptr) {
+            return __parent;
+        }
+        this->_M_link_node(__node, __parent, __link);
         return nullptr;
     }
 
@@ -586,15 +1048,282 @@ struct _RbTreeBase {
             }
             __pparent = &__parent->_M_right;
         }
+        this->_M_link_node(__node, __parent, __pparent);
+    }
 
-        __node->_M_left = nullptr;
-        __node->_M_right = nullptr;
-        __node->_M_color = _S_red;
+    // 插在等价区间的最前面
+    template <class _NodeImpl, class _Compare>
+    void _M_multi_insert_node_lower(_RbTreeNode *__node, _Compare __comp) {
+        _RbTreeNode **__pparent = &_M_block->_M_root;
+        _RbTreeNode *__parent = nullptr;
+        while (*__pparent != nullptr) {
+            __parent = *__pparent;
+            if (__comp(static_cast<_NodeImpl *>(__parent)->_M_value,
+                       static_cast<_NodeImpl *>(__node)->_M_value)) {
+                __pparent = &__parent->_M_right;
+            } else {
+                __pparent = &__parent->_M_left;
+            }
+        }
+        this->_M_link_node(__node, __parent, __pparent);
+    }
 
-        __node->_M_parent = __parent;
-        __node->_M_pparent = __pparent;
-        *__pparent = __node;
-        _RbTreeBase::_M_fix_violation(__node);
+    static _RbTreeNode *_M_prev_node(_RbTreeNode *__node) noexcept {
+        if (__node->_M_left != nullptr) {
+            __node = __node->_M_left;
+            while (__node->_M_right != nullptr) {
+                __node = __node->_M_right;
+            }
+            return __node;
+        }
+        _RbTreeNode *__parent = __node->_M_parent();
+        while (__parent != nullptr && __node == __parent->_M_left) {
+            __node = __parent;
+            __parent = __node->_M_parent();
+        }
+        return __parent;
+    }
+
+    static _RbTreeNode *_M_next_node(_RbTreeNode *__node) noexcept {
+        if (__node->_M_right != nullptr) {
+            __node = __node->_M_right;
+            while (__node->_M_left != nullptr) {
+                __node = __node->_M_left;
+            }
+            return __node;
+        }
+        _RbTreeNode *__parent = __node->_M_parent();
+        while (__parent != nullptr && __node == __parent->_M_right) {
+            __node = __parent;
+            __parent = __node->_M_parent();
+        }
+        return __parent;
+    }
+
+    template <class _NodeImpl, class _Compare>
+    static bool _M_node_less(_Compare &__comp, _RbTreeNode *__lhs,
+                             _RbTreeNode *__rhs) {
+        return __comp(static_cast<_NodeImpl *>(__lhs)->_M_value,
+                      static_cast<_NodeImpl *>(__rhs)->_M_value);
+    }
+
+    // __hint 为空表示 end()。__node 恰好落在 __hint 和它的前驱（或后继）
+    // 之间时，直接挂到两者中空着的那个子指针上，只比较一两次；
+    // 提示不对时退回从根查找。_Unique 时遇到等价节点返回该节点，不插入
+    template <class _NodeImpl, bool _Unique, class _Compare>
+    _RbTreeNode *_M_hint_insert_node(_RbTreeNode *__hint, _RbTreeNode *__node,
+                                     _Compare __comp) {
+        auto __less = [&__comp](_RbTreeNode *__lhs, _RbTreeNode *__rhs) {
+            return _RbTreeBase::_M_node_less<_NodeImpl>(__comp, __lhs, __rhs);
+        };
+        if (__hint == nullptr) {
+            _RbTreeNode *__max = this->_M_max_node();
+            if (__max == nullptr) {
+                this->_M_link_node(__node, nullptr, &_M_block->_M_root);
+                return nullptr;
+            }
+            if (_Unique ? __less(__max, __node) : !__less(__node, __max)) {
+                this->_M_link_node(__node, __max, &__max->_M_right);
+                return nullptr;
+            }
+        } else if (_Unique ? __less(__node, __hint) : !__less(__hint, __node)) {
+            _RbTreeNode *__prev = _RbTreeBase::_M_prev_node(__hint);
+            if (__prev == nullptr ||
+                (_Unique ? __less(__prev, __node) : !__less(__node, __prev))) {
+                if (__hint->_M_left == nullptr) {
+                    this->_M_link_node(__node, __hint, &__hint->_M_left);
+                } else {
+                    this->_M_link_node(__node, __prev, &__prev->_M_right);
+                }
+                return nullptr;
+            }
+        } else if (!_Unique || __less(__hint, __node)) {
+            _RbTreeNode *__next = _RbTreeBase::_M_next_node(__hint);
+            if (__next == nullptr ||
+                (_Unique ? __less(__node, __next) : !__less(__next, __node))) {
+                if (__hint->_M_right == nullptr) {
+                    this->_M_link_node(__node, __hint, &__hint->_M_right);
+                } else {
+                    this->_M_link_node(__node, __next, &__next->_M_left);
+                }
+                return nullptr;
+            }
+            if constexpr (!_Unique) {
+                // 提示和它的后继都在 __node 之前：按标准要尽量靠近提示，
+                // 即插在等价区间的最前面
+                this->_M_multi_insert_node_lower<_NodeImpl>(__node, __comp);
+                return nullptr;
+            }
+        } else {
+            return __hint;
+        }
+        if constexpr (_Unique) {
+            return this->_M_single_insert_node<_NodeImpl>(__node, __comp);
+        } else {
+            this->_M_multi_insert_node<_NodeImpl>(__node, __comp);
+            return nullptr;
+        }
+    }
+    // 独立的一棵子树：根为黑、没有父节点，_M_height 是黑高（根到空叶子
+    // 路上的黑节点数，空树为 0）。join/split 只在这种子树之间进行
+    struct _Subtree {
+        _RbTreeNode *_M_root;
+        std::size_t _M_height;
+    };
+
+    static std::size_t _S_black_height(_RbTreeNode *__node) noexcept {
+        std::size_t __height = 0;
+        for (; __node != nullptr; __node = __node->_M_left) {
+            __height += __node->_M_color() == _S_black;
+        }
+        return __height;
+    }
+
+    // 把黑高为 __height 的孩子摘成独立子树，红根染黑后黑高加一
+    static _Subtree _S_detach(_RbTreeNode *__node,
+                              std::size_t __height) noexcept {
+        if (__node == nullptr) {
+            return {nullptr, 0};
+        }
+        __node->_M_set_parent(nullptr);
+        if (__node->_M_color() == _S_red) {
+            __node->_M_set_color(_S_black);
+            ++__height;
+        }
+        return {__node, __height};
+    }
+
+    // 拆开 __tree 的根，左右孩子各成一棵独立子树
+    static _RbTreeNode *_S_unlink_root(_Subtree __tree, _Subtree &__left,
+                                       _Subtree &__right) noexcept {
+        _RbTreeNode *__root = __tree._M_root;
+        __left = _RbTreeBase::_S_detach(__root->_M_left, __tree._M_height - 1);
+        __right =
+            _RbTreeBase::_S_detach(__root->_M_right, __tree._M_height - 1);
+        return __root;
+    }
+
+    // __left 的元素都在 __mid 之前，__right 的都在它之后，连成一棵树。
+    // 黑高较大的一方沿靠近对方的脊下行到黑高相等的黑节点，由 __mid
+    // 取代它的位置，再按插入修复红红冲突，O(两者黑高之差 + 1)。
+    // 修复最多转到 __tall 的根，根的位置记在栈上的根块里，不碰
+    // _M_block：互不相交的子树可以在不同线程上同时 join
+    _Subtree _M_join(_Subtree __left, _RbTreeNode *__mid,
+                     _Subtree __right) noexcept {
+        if (__left._M_height == __right._M_height) {
+            __mid->_M_left = __left._M_root;
+            __mid->_M_right = __right._M_root;
+            __mid->_M_set_parent_color(nullptr, _S_black);
+            if (__left._M_root != nullptr) {
+                __left._M_root->_M_set_parent(__mid);
+            }
+            if (__right._M_root != nullptr) {
+                __right._M_root->_M_set_parent(__mid);
+            }
+            _Augment::_S_update(__mid);
+            return {__mid, __left._M_height + 1};
+        }
+        bool __rightward = __left._M_height > __right._M_height;
+        _Subtree __tall = __rightward ? __left : __right;
+        _Subtree __short = __rightward ? __right : __left;
+        _RbTreeNode *__parent = nullptr;
+        _RbTreeNode *__node = __tall._M_root;
+        std::size_t __height = __tall._M_height;
+        while (__height > __short._M_height || __node->_M_color() == _S_red) {
+            __height -= __node->_M_color() == _S_black;
+            __parent = __node;
+            __node = __rightward ? __node->_M_right : __node->_M_left;
+            if (__node == nullptr) {
+                break;
+            }
+        }
+        _RbTreeRoot __scratch{__tall._M_root, nullptr, nullptr};
+        _RbTreeBase __view(&__scratch);
+        if (__rightward) {
+            __mid->_M_left = __node;
+            __mid->_M_right = __short._M_root;
+            __parent->_M_right = __mid;
+        } else {
+            __mid->_M_left = __short._M_root;
+            __mid->_M_right = __node;
+            __parent->_M_left = __mid;
+        }
+        __mid->_M_set_parent_color(__parent, _S_red);
+        if (__node != nullptr) {
+            __node->_M_set_parent(__mid);
+        }
+        if (__short._M_root != nullptr) {
+            __short._M_root->_M_set_parent(__mid);
+        }
+        _Augment::_S_update(__mid);
+        _RbTreeBase::_M_update_path(__parent);
+        bool __grown = __view._M_fix_violation(__mid);
+        return {__scratch._M_root, __tall._M_height + __grown};
+    }
+
+    // 摘下最大的节点，其余部分重新连成一棵树
+    _RbTreeNode *_M_split_last(_Subtree &__tree) noexcept {
+        _Subtree __left, __right;
+        _RbTreeNode *__root =
+            _RbTreeBase::_S_unlink_root(__tree, __left, __right);
+        if (__right._M_root == nullptr) {
+            __tree = __left;
+            return __root;
+        }
+        _RbTreeNode *__last = this->_M_split_last(__right);
+        __tree = this->_M_join(__left, __root, __right);
+        return __last;
+    }
+
+    // 没有中间节点的 join：借 __left 的最大节点当中间节点
+    _Subtree _M_join2(_Subtree __left, _Subtree __right) noexcept {
+        if (__left._M_root == nullptr) {
+            return __right;
+        }
+        if (__right._M_root == nullptr) {
+            return __left;
+        }
+        _RbTreeNode *__mid = this->_M_split_last(__left);
+        return this->_M_join(__left, __mid, __right);
+    }
+
+    // 把 __tree 按 __value 切成前后两棵。_Unique 时与 __value 等价的
+    // 节点（至多一个）单独返回，否则等价的节点都归入 __right。
+    // 沿查找路径下行，回来时逐层 join，总共 O(log n)
+    template <class _NodeImpl, bool _Unique, class _Tv, class _Compare>
+    _RbTreeNode *_M_split(_Subtree __tree, _Tv const &__value,
+                          _Compare &__comp, _Subtree &__left,
+                          _Subtree &__right) noexcept {
+        if (__tree._M_root == nullptr) {
+            __left = __right = {nullptr, 0};
+            return nullptr;
+        }
+        _Subtree __lower, __upper;
+        _RbTreeNode *__root =
+            _RbTreeBase::_S_unlink_root(__tree, __lower, __upper);
+        auto const &__key = static_cast<_NodeImpl *>(__root)->_M_value;
+        bool __goes_right = _Unique ? __comp(__value, __key)
+                                    : !__comp(__key, __value);
+        if (__goes_right) {
+            _RbTreeNode *__match = this->_M_split<_NodeImpl, _Unique>(
+                __lower, __value, __comp, __left, __right);
+            __right = this->_M_join(__right, __root, __upper);
+            return __match;
+        }
+        if (!_Unique || __comp(__key, __value)) {
+            _RbTreeNode *__match = this->_M_split<_NodeImpl, _Unique>(
+                __upper, __value, __comp, __left, __right);
+            __left = this->_M_join(__lower, __root, __left);
+            return __match;
+        }
+        __left = __lower;
+        __right = __upper;
+        return __root;
+    }
+
+    _Subtree _M_whole_tree() const noexcept {
+        return {_M_block->_M_root,
+                _RbTreeBase::_S_black_height(_M_block->_M_root)};
     }
 };
 
@@ -608,30 +1337,41 @@ struct _RbTreeNodeHandle {
     _RbTreeNodeHandle(_NodeImpl *__node, _Alloc __alloc) noexcept
         : _M_node(__node), _M_alloc(__alloc) {}
 
-    template <class, class, class, class> friend struct _RbTreeImpl;
+    void _M_release() noexcept {
+        if (_M_node) {
+            _M_node->_M_destruct();
+            typename std::allocator_traits<_Alloc>::template rebind_alloc<
+                _NodeImpl>
+                __node_alloc(_M_alloc);
+            std::allocator_traits<decltype(__node_alloc)>::deallocate(
+                __node_alloc, _M_node, 1);
+            _M_node = nullptr;
+        }
+    }
+
+    template <class, class, class, class, class> friend struct _RbTreeImpl;
 
   public:
     _RbTreeNodeHandle() noexcept : _M_node(nullptr) {}
 
     _RbTreeNodeHandle(_RbTreeNodeHandle &&__that) noexcept
-        : _M_node(__that._M_node) {
+        : _M_node(__that._M_node), _M_alloc(std::move(__that._M_alloc)) {
         __that._M_node = nullptr;
     }
 
     _RbTreeNodeHandle &operator=(_RbTreeNodeHandle &&__that) noexcept {
         std::swap(_M_node, __that._M_node);
+        std::swap(_M_alloc, __that._M_alloc);
         return *this;
     }
 
-    _Tp &value() const noexcept {
-        return static_cast<_NodeImpl *>(_M_node)->_M_value;
-    }
+    bool empty() const noexcept { return _M_node == nullptr; }
 
-    ~_RbTreeNodeHandle() noexcept {
-        if (_M_node) {
-            _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, _M_node);
-        }
-    }
+    explicit operator bool() const noexcept { return _M_node != nullptr; }
+
+    _Tp &value() const noexcept { return _M_node->_M_value; }
+
+    ~_RbTreeNodeHandle() noexcept { this->_M_release(); }
 };
 
 template <class _Tp, class _Compare, class _Alloc, class _NodeImpl>
@@ -639,6 +1379,15 @@ struct _RbTreeNodeHandle<
     _Tp, _Compare, _Alloc, _NodeImpl,
     decltype((void)static_cast<typename _Compare::_RbTreeIsMap *>(nullptr))>
     : _RbTreeNodeHandle<_Tp, _Compare, _Alloc, _NodeImpl, void *> {
+  protected:
+    using _RbTreeNodeHandle<_Tp, _Compare, _Alloc, _NodeImpl,
+                            void *>::_RbTreeNodeHandle;
+
+    template <class, class, class, class, class> friend struct _RbTreeImpl;
+
+  public:
+    _RbTreeNodeHandle() noexcept = default;
+
     typename _Tp::first_type &key() const noexcept {
         return this->value().first;
     }
@@ -648,39 +1397,54 @@ struct _RbTreeNodeHandle<
     }
 };
 
+// 分配器能否一次收回一串节点（见 pool_allocator::deallocate_chain）
+template <class _Alloc, class _Type, class = void>
+struct _RbTreeHasDeallocateChain : std::false_type {};
+
+template <class _Alloc, class _Type>
+struct _RbTreeHasDeallocateChain<
+    _Alloc, _Type,
+    decltype((void)std::declval<_Alloc &>().deallocate_chain(
+        std::declval<_Type *>(), std::declval<_Type *>(), std::size_t()))>
+    : std::true_type {};
+
 template <class _Tp, class _Compare, class _Alloc,
-          class _NodeImpl = _RbTreeNodeImpl<_Tp>>
-struct _RbTreeImpl : protected _RbTreeBase {
+          class _Augment = _RbTreeNoAugment,
+          class _NodeImpl = _RbTreeNodeImpl<_Tp, typename _Augment::_Node>>
+struct _RbTreeImpl : protected _RbTreeBase<_Augment> {
   protected:
+    using _Base = _RbTreeBase<_Augment>;
+    using _Base::_M_block;
+
     [[no_unique_address]] _Compare _M_comp;
     [[no_unique_address]] _Alloc _M_alloc;
 
   public:
     _RbTreeImpl() noexcept
-        : _RbTreeBase(_RbTreeBase::_M_allocate<_RbTreeRoot>(_M_alloc)) {
-        _M_block->_M_root = nullptr;
+        : _Base(_Base::template _M_allocate<_RbTreeRoot>(_M_alloc)) {
+        this->_M_reset_root(nullptr);
     }
 
     ~_RbTreeImpl() noexcept {
         this->clear();
-        _RbTreeBase::_M_deallocate<_RbTreeRoot>(_M_alloc, _M_block);
+        _Base::template _M_deallocate<_RbTreeRoot>(_M_alloc, _M_block);
     }
 
     explicit _RbTreeImpl(_Compare __comp) noexcept
-        : _RbTreeBase(_RbTreeBase::_M_allocate<_RbTreeRoot>(_M_alloc)),
+        : _Base(_Base::template _M_allocate<_RbTreeRoot>(_M_alloc)),
           _M_comp(__comp) {
-        _M_block->_M_root = nullptr;
+        this->_M_reset_root(nullptr);
     }
 
     explicit _RbTreeImpl(_Alloc alloc, _Compare __comp = _Compare()) noexcept
-        : _RbTreeBase(_RbTreeBase::_M_allocate<_RbTreeRoot>(_M_alloc)),
-          _M_alloc(alloc), _M_comp(__comp) {
-        _M_block->_M_root = nullptr;
+        : _Base(_Base::template _M_allocate<_RbTreeRoot>(alloc)),
+          _M_comp(__comp), _M_alloc(alloc) {
+        this->_M_reset_root(nullptr);
     }
 
-    _RbTreeImpl(_RbTreeImpl &&__that) noexcept : _RbTreeBase(__that._M_block) {
-        __that._M_block = _RbTreeBase::_M_allocate<_RbTreeRoot>(_M_alloc);
-        __that._M_block->_M_root = nullptr;
+    _RbTreeImpl(_RbTreeImpl &&__that) noexcept : _Base(__that._M_block) {
+        __that._M_block = _Base::template _M_allocate<_RbTreeRoot>(_M_alloc);
+        __that._M_reset_root(nullptr);
     }
 
     _RbTreeImpl &operator=(_RbTreeImpl &&__that) noexcept {
@@ -688,22 +1452,125 @@ struct _RbTreeImpl : protected _RbTreeBase {
         return *this;
     }
 
+    // 拷贝按源树的形状逐个节点复制，颜色照搬，不调用比较器
+    _RbTreeImpl(_RbTreeImpl const &__that)
+        : _Base(nullptr), _M_comp(__that._M_comp),
+          _M_alloc(std::allocator_traits<_Alloc>::
+                       select_on_container_copy_construction(
+                           __that._M_alloc)) {
+        _M_block = _Base::template _M_allocate<_RbTreeRoot>(_M_alloc);
+        this->_M_reset_root(nullptr);
+        try {
+            this->_M_assign_clone(__that);
+        } catch (...) {
+            _Base::template _M_deallocate<_RbTreeRoot>(_M_alloc, _M_block);
+            throw;
+        }
+    }
+
+    // 拷贝赋值时原有节点先析构值再原地构造新值，省去分配和释放
+    _RbTreeImpl &operator=(_RbTreeImpl const &__that) {
+        if (&__that != this) {
+            _M_comp = __that._M_comp;
+            this->_M_assign_clone(__that);
+        }
+        return *this;
+    }
+
   protected:
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
-    void _M_single_insert(_InputIt __first, _InputIt __last) {
-        while (__first != __last) {
-            this->_M_single_insert(*__first);
-            ++__first;
-        }
+    void _M_single_insert(_InputIt __first, _InputIt __last,
+                          bool __sorted = false) {
+        this->_M_insert_range<true>(__first, __last, __sorted);
     }
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
-    void _M_multi_insert(_InputIt __first, _InputIt __last) {
-        while (__first != __last) {
-            this->_M_multi_insert(*__first);
-            ++__first;
+    void _M_multi_insert(_InputIt __first, _InputIt __last,
+                         bool __sorted = false) {
+        this->_M_insert_range<false>(__first, __last, __sorted);
+    }
+
+    // 空树上插入区间时先按输入顺序构造节点，借用 _M_right 串成链表，
+    // 有序的话 O(n) 建成平衡树。遇到逆序时把已构造的有序前缀建树，
+    // 剩下的元素逐个插入。__sorted 为真表示调用者保证有序，不再比较
+    template <bool _Unique, class _InputIt>
+    void _M_insert_range(_InputIt __first, _InputIt __last, bool __sorted) {
+        if (this->empty()) {
+            _RbTreeNode *__head = nullptr;
+            _RbTreeNode **__tail = &__head;
+            _NodeImpl *__prev = nullptr;
+            _NodeImpl *__unsorted = nullptr;
+            std::size_t __n = 0;
+            try {
+                for (; __first != __last; ++__first) {
+                    _NodeImpl *__node = this->_M_create_node(*__first);
+                    if (!__sorted && __prev != nullptr &&
+                        !this->_M_in_order<_Unique>(__prev, __node)) {
+                        __unsorted = __node;
+                        ++__first;
+                        break;
+                    }
+                    *__tail = __node;
+                    __tail = &__node->_M_right;
+                    __prev = __node;
+                    ++__n;
+                }
+            } catch (...) {
+                *__tail = nullptr;
+                this->_M_destroy_list(__head);
+                throw;
+            }
+            *__tail = nullptr;
+            this->_M_reset_root(_Base::_M_build_balanced(__head, __n));
+            if (__unsorted == nullptr) {
+                return;
+            }
+            this->_M_insert_node<_Unique>(__unsorted);
+        }
+        for (; __first != __last; ++__first) {
+            if constexpr (_Unique) {
+                this->_M_single_emplace(*__first);
+            } else {
+                this->_M_multi_emplace(*__first);
+            }
+        }
+    }
+
+    template <bool _Unique>
+    bool _M_in_order(_NodeImpl *__prev, _NodeImpl *__node) const noexcept {
+        if constexpr (_Unique) {
+            return _M_comp(__prev->_M_value, __node->_M_value);
+        } else {
+            return !_M_comp(__node->_M_value, __prev->_M_value);
+        }
+    }
+
+    template <bool _Unique> void _M_insert_node(_NodeImpl *__node) noexcept {
+        if constexpr (_Unique) {
+            if (this->template _M_single_insert_node<_NodeImpl>(__node,
+                                                                _M_comp)) {
+                __node->_M_destruct();
+                _Base::template _M_deallocate<_NodeImpl>(_M_alloc, __node);
+            }
+        } else {
+            this->template _M_multi_insert_node<_NodeImpl>(__node, _M_comp);
+        }
+    }
+
+    template <class... _Ts> _NodeImpl *_M_create_node(_Ts &&...__value) {
+        _NodeImpl *__node = _Base::template _M_allocate<_NodeImpl>(_M_alloc);
+        __node->_M_construct(std::forward<_Ts>(__value)...);
+        return __node;
+    }
+
+    void _M_destroy_list(_RbTreeNode *__head) noexcept {
+        while (__head != nullptr) {
+            _RbTreeNode *__next = __head->_M_right;
+            static_cast<_NodeImpl *>(__head)->_M_destruct();
+            _Base::template _M_deallocate<_NodeImpl>(_M_alloc, __head);
+            __head = __next;
         }
     }
 
@@ -723,43 +1590,219 @@ struct _RbTreeImpl : protected _RbTreeBase {
   protected:
     template <class _Tv> const_iterator _M_find(_Tv &&__value) const noexcept {
         return this->_M_prevent_end(
-            this->_M_find_node<_NodeImpl>(__value, _M_comp));
+            this->template _M_find_node<_NodeImpl>(__value, _M_comp));
     }
 
     template <class _Tv> iterator _M_find(_Tv &&__value) noexcept {
         return this->_M_prevent_end(
-            this->_M_find_node<_NodeImpl>(__value, _M_comp));
+            this->template _M_find_node<_NodeImpl>(__value, _M_comp));
     }
 
     template <class... _Ts> iterator _M_multi_emplace(_Ts &&...__value) {
-        _NodeImpl *__node = _RbTreeBase::_M_allocate<_NodeImpl>(_M_alloc);
+        _NodeImpl *__node = _Base::template _M_allocate<_NodeImpl>(_M_alloc);
         __node->_M_construct(std::forward<_Ts>(__value)...);
-        this->_M_multi_insert_node<_NodeImpl>(__node, _M_comp);
+        this->template _M_multi_insert_node<_NodeImpl>(__node, _M_comp);
         return __node;
     }
 
+    // 先按 __key 查找，键已存在时既不分配节点也不构造值，__value
+    // 也不会被移走。__key 可以是键，也可以是一个完整的值
+    template <class _Kv, class... _Ts>
+    std::pair<iterator, bool> _M_single_emplace_key(_Kv const &__key,
+                                                    _Ts &&...__value) {
+        auto [__parent, __link] =
+            this->template _M_find_insert_pos<_NodeImpl>(__key, _M_comp);
+        if (__link == nullptr) {
+            return {__parent, false};
+        }
+        // __key 可能引用 __value 中的对象，构造之后不能再用
+        _NodeImpl *__node =
+            this->_M_create_node(std::forward<_Ts>(__value)...);
+        this->_M_link_node(__node, __parent, __link);
+        return {static_cast<_RbTreeNode *>(__node), true};
+    }
+
     template <class... _Ts>
     std::pair<iterator, bool> _M_single_emplace(_Ts &&...__value) {
-        _RbTreeNode *__node = _RbTreeBase::_M_allocate<_NodeImpl>(_M_alloc);
+        if constexpr (sizeof...(_Ts) == 1 &&
+                      (std::is_same_v<std::remove_cvref_t<_Ts>,
+                                      std::remove_cv_t<_Tp>> &&
+                       ...)) {
+            // 传入的就是一个完整的值，可以直接拿它去比较
+            return this->_M_single_emplace_key(__value...,
+                                               std::forward<_Ts>(__value)...);
+        }
+        _RbTreeNode *__node = _Base::template _M_allocate<_NodeImpl>(_M_alloc);
         static_cast<_NodeImpl *>(__node)->_M_construct(
             std::forward<_Ts>(__value)...);
         _RbTreeNode *__conflict =
-            this->_M_single_insert_node<_NodeImpl>(__node, _M_comp);
+            this->template _M_single_insert_node<_NodeImpl>(__node, _M_comp);
         if (__conflict) {
             static_cast<_NodeImpl *>(__node)->_M_destruct();
-            _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, __node);
+            _Base::template _M_deallocate<_NodeImpl>(_M_alloc, __node);
             return {__conflict, false};
         } else {
             return {__node, true};
         }
     }
 
+    // __hint 是 end() 时传空指针
+    static _RbTreeNode *_M_hint_node(const_iterator __hint) noexcept {
+        return __hint._M_off_by_one ? nullptr : __hint._M_node;
+    }
+
+    template <class... _Ts>
+    iterator _M_single_emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        _NodeImpl *__node =
+            this->_M_create_node(std::forward<_Ts>(__value)...);
+        _RbTreeNode *__conflict =
+            this->template _M_hint_insert_node<_NodeImpl, true>(
+                _RbTreeImpl::_M_hint_node(__hint), __node, _M_comp);
+        if (__conflict) {
+            __node->_M_destruct();
+            _Base::template _M_deallocate<_NodeImpl>(_M_alloc, __node);
+            return __conflict;
+        }
+        return static_cast<_RbTreeNode *>(__node);
+    }
+
+    template <class... _Ts>
+    iterator _M_multi_emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        _NodeImpl *__node =
+            this->_M_create_node(std::forward<_Ts>(__value)...);
+        this->template _M_hint_insert_node<_NodeImpl, false>(
+            _RbTreeImpl::_M_hint_node(__hint), __node, _M_comp);
+        return static_cast<_RbTreeNode *>(__node);
+    }
+
+    // 拆掉整棵树，不做旋转也不重新着色：左子不空时把左子右旋上来，
+    // 左子为空时释放当前节点再走向右子，每个节点只经过常数次，
+    // 不需要栈。分配器支持 deallocate_chain 时，释放的节点借首个指针
+    // 串成一条链，最后一次性交还
+    void _M_destroy_tree(_RbTreeNode *__node) noexcept {
+        using _NodeAlloc = typename std::allocator_traits<
+            _Alloc>::template rebind_alloc<_NodeImpl>;
+        constexpr bool __chained =
+            _RbTreeHasDeallocateChain<_NodeAlloc, _NodeImpl>::value;
+        _RbTreeNode *__head = nullptr;
+        _RbTreeNode *__tail = nullptr;
+        std::size_t __count = 0;
+        while (__node != nullptr) {
+            if (__node->_M_left != nullptr) {
+                _RbTreeNode *__left = __node->_M_left;
+                __node->_M_left = __left->_M_right;
+                __left->_M_right = __node;
+                __node = __left;
+                continue;
+            }
+            _RbTreeNode *__next = __node->_M_right;
+            static_cast<_NodeImpl *>(__node)->_M_destruct();
+            if constexpr (__chained) {
+                __node->_M_left = __head;
+                __head = __node;
+                if (__tail == nullptr) {
+                    __tail = __node;
+                }
+                ++__count;
+            } else {
+                _Base::template _M_deallocate<_NodeImpl>(_M_alloc, __node);
+            }
+            __node = __next;
+        }
+        if constexpr (__chained) {
+            if (__head != nullptr) {
+                _NodeAlloc __node_alloc(_M_alloc);
+                __node_alloc.deallocate_chain(
+                    static_cast<_NodeImpl *>(__head),
+                    static_cast<_NodeImpl *>(__tail), __count);
+            }
+        }
+    }
+
+    // 析构所有值，节点借 _M_right 串成链表留待复用，树变为空
+    _RbTreeNode *_M_detach_nodes() noexcept {
+        _RbTreeNode *__node = _M_block->_M_root;
+        _RbTreeNode *__spare = nullptr;
+        while (__node != nullptr) {
+            if (__node->_M_left != nullptr) {
+                _RbTreeNode *__left = __node->_M_left;
+                __node->_M_left = __left->_M_right;
+                __left->_M_right = __node;
+                __node = __left;
+                continue;
+            }
+            _RbTreeNode *__next = __node->_M_right;
+            static_cast<_NodeImpl *>(__node)->_M_destruct();
+            __node->_M_right = __spare;
+            __spare = __node;
+            __node = __next;
+        }
+        this->_M_reset_root(nullptr);
+        return __spare;
+    }
+
+    void _M_free_spare(_RbTreeNode *__spare) noexcept {
+        while (__spare != nullptr) {
+            _RbTreeNode *__next = __spare->_M_right;
+            _Base::template _M_deallocate<_NodeImpl>(_M_alloc, __spare);
+            __spare = __next;
+        }
+    }
+
+    // 复制以 __src 为根的子树挂到 *__link 上。每个新节点先挂进树里再复制
+    // 子树，抛出异常时已复制的部分可以直接 clear。左链迭代、右子递归，
+    // 递归深度不超过树高
+    void _M_clone_into(_RbTreeNode *__src, _RbTreeNode *__parent,
+                       _RbTreeNode **__link, _RbTreeNode *&__spare) {
+        _RbTreeNode *__top = __parent;
+        while (__src != nullptr) {
+            _NodeImpl *__node;
+            _Tp const &__value = static_cast<_NodeImpl *>(__src)->_M_value;
+            if (__spare != nullptr) {
+                __node = static_cast<_NodeImpl *>(__spare);
+                __spare = __spare->_M_right;
+                __node->_M_construct(__value);
+            } else {
+                __node = this->_M_create_node(__value);
+            }
+            __node->_M_left = nullptr;
+            __node->_M_right = nullptr;
+            __node->_M_set_parent_color(__parent, __src->_M_color());
+            *__link = __node;
+            if (__src->_M_right != nullptr) {
+                this->_M_clone_into(__src->_M_right, __node,
+                                    &__node->_M_right, __spare);
+            }
+            __parent = __node;
+            __link = &__node->_M_left;
+            __src = __src->_M_left;
+        }
+        // 左链自下而上补算增强字段，各节点的右子树在递归里已经算好
+        if constexpr (_Base::_S_augmented) {
+            for (; __parent != __top; __parent = __parent->_M_parent()) {
+                _Augment::_S_update(__parent);
+            }
+        }
+    }
+
+    void _M_assign_clone(_RbTreeImpl const &__that) {
+        _RbTreeNode *__spare = this->_M_detach_nodes();
+        try {
+            this->_M_clone_into(__that._M_block->_M_root, nullptr,
+                                &_M_block->_M_root, __spare);
+        } catch (...) {
+            this->clear();
+            this->_M_free_spare(__spare);
+            throw;
+        }
+        this->_M_free_spare(__spare);
+        this->_M_reset_root(_M_block->_M_root);
+    }
+
   public:
     void clear() noexcept {
-        iterator __it = this->begin();
-        while (__it != this->end()) {
-            __it = this->erase(__it);
-        }
+        this->_M_destroy_tree(_M_block->_M_root);
+        this->_M_reset_root(nullptr);
     }
 
     iterator erase(const_iterator __it) noexcept {
@@ -769,37 +1812,335 @@ struct _RbTreeImpl : protected _RbTreeBase {
         _RbTreeNode *__node = __it._M_node;
         _RbTreeImpl::_M_erase_node(__node);
         static_cast<_NodeImpl *>(__node)->_M_destruct();
-        _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, __node);
+        _Base::template _M_deallocate<_NodeImpl>(_M_alloc, __node);
         return __tmp;
     }
 
     using node_type = _RbTreeNodeHandle<_Tp, _Compare, _Alloc, _NodeImpl>;
 
-    template <class... _Ts> std::pair<iterator, bool> insert(node_type __nh) {
-        _NodeImpl *__node = __nh._M_node;
+    // 键已存在时节点保持原样，随 __nh 一起销毁
+    std::pair<iterator, bool> insert(node_type __nh) {
+        if (__nh.empty()) {
+            return {this->end(), false};
+        }
         _RbTreeNode *__conflict =
-            this->_M_single_insert_node<_NodeImpl>(__node, _M_comp);
+            this->template _M_single_insert_node<_NodeImpl>(__nh._M_node,
+                                                            _M_comp);
         if (__conflict) {
-            static_cast<_NodeImpl *>(__node)->_M_destruct();
             return {__conflict, false};
-        } else {
-            return {__node, true};
         }
+        _RbTreeNode *__node = std::exchange(__nh._M_node, nullptr);
+        return {__node, true};
     }
 
     node_type extract(const_iterator __it) noexcept {
         _RbTreeNode *__node = __it._M_node;
         _RbTreeImpl::_M_erase_node(__node);
-        return {__node, _M_alloc};
+        return {static_cast<_NodeImpl *>(__node), _M_alloc};
+    }
+
+  protected:
+    iterator _M_multi_insert_handle(node_type __nh) {
+        if (__nh.empty()) {
+            return this->end();
+        }
+        this->template _M_multi_insert_node<_NodeImpl>(__nh._M_node, _M_comp);
+        return static_cast<_RbTreeNode *>(std::exchange(__nh._M_node, nullptr));
+    }
+
+    // 集合运算：节点在两棵树之间直接挪动，不重新分配，两边的分配器
+    // 必须相等。都以一棵树的根切开另一棵，左右分别递归再 join，
+    // 较小一方有 m 个元素时为 O(m log(n/m + 1))
+    using _Subtree = typename _Base::_Subtree;
+
+    void _M_drop_node(_RbTreeNode *__node) noexcept {
+        static_cast<_NodeImpl *>(__node)->_M_destruct();
+        _Base::template _M_deallocate<_NodeImpl>(_M_alloc, __node);
+    }
+
+    // __b 并入 __a，等价元素保留 __a 的。_Unique 时 __b 中重复的节点
+    // 按顺序借 _M_right 串到 __dups 后面；非 _Unique 时不会有重复，
+    // __b 中的等价元素排在 __a 的之后
+    template <bool _Unique>
+    _Subtree _M_union(_Subtree __a, _Subtree __b,
+                      _RbTreeNode **&__dups) noexcept {
+        if (__a._M_root == nullptr) {
+            return __b;
+        }
+        if (__b._M_root == nullptr) {
+            return __a;
+        }
+        _Subtree __a_left, __a_right, __b_left, __b_right;
+        _RbTreeNode *__root = _Base::_S_unlink_root(__a, __a_left, __a_right);
+        _RbTreeNode *__match = this->template _M_split<_NodeImpl, _Unique>(
+            __b, static_cast<_NodeImpl *>(__root)->_M_value, _M_comp,
+            __b_left, __b_right);
+        _Subtree __left = this->_M_union<_Unique>(__a_left, __b_left, __dups);
+        if (__match != nullptr) {
+            *__dups = __match;
+            __dups = &__match->_M_right;
+        }
+        _Subtree __right =
+            this->_M_union<_Unique>(__a_right, __b_right, __dups);
+        return this->_M_join(__left, __root, __right);
+    }
+
+    // 只保留 __a 中在 __b 里有等价元素的节点，其余节点都释放
+    _Subtree _M_intersect(_Subtree __a, _Subtree __b) noexcept {
+        if (__a._M_root == nullptr || __b._M_root == nullptr) {
+            this->_M_destroy_tree(__a._M_root);
+            this->_M_destroy_tree(__b._M_root);
+            return {nullptr, 0};
+        }
+        _Subtree __a_left, __a_right, __b_left, __b_right;
+        _RbTreeNode *__root = _Base::_S_unlink_root(__a, __a_left, __a_right);
+        _RbTreeNode *__match = this->template _M_split<_NodeImpl, true>(
+            __b, static_cast<_NodeImpl *>(__root)->_M_value, _M_comp,
+            __b_left, __b_right);
+        _Subtree __left = this->_M_intersect(__a_left, __b_left);
+        _Subtree __right = this->_M_intersect(__a_right, __b_right);
+        if (__match != nullptr) {
+            this->_M_drop_node(__match);
+            return this->_M_join(__left, __root, __right);
+        }
+        this->_M_drop_node(__root);
+        return this->_M_join2(__left, __right);
+    }
+
+    // 去掉 __a 中在 __b 里有等价元素的节点，__b 的节点全部释放
+    _Subtree _M_subtract(_Subtree __a, _Subtree __b) noexcept {
+        if (__a._M_root == nullptr || __b._M_root == nullptr) {
+            this->_M_destroy_tree(__b._M_root);
+            return __a;
+        }
+        _Subtree __a_left, __a_right, __b_left, __b_right;
+        _RbTreeNode *__root = _Base::_S_unlink_root(__b, __b_left, __b_right);
+        _RbTreeNode *__match = this->template _M_split<_NodeImpl, true>(
+            __a, static_cast<_NodeImpl *>(__root)->_M_value, _M_comp,
+            __a_left, __a_right);
+        _Subtree __left = this->_M_subtract(__a_left, __b_left);
+        _Subtree __right = this->_M_subtract(__a_right, __b_right);
+        this->_M_drop_node(__root);
+        if (__match != nullptr) {
+            this->_M_drop_node(__match);
+        }
+        return this->_M_join2(__left, __right);
+    }
+
+    // 两棵树都交给 __op，结果成为 *this 的树，__that 变为空
+    template <class _Op> void _M_combine(_RbTreeImpl &__that, _Op __op) {
+        assert(_M_alloc == __that._M_alloc);
+        _Subtree __a = this->_M_whole_tree();
+        _Subtree __b = __that._M_whole_tree();
+        __that._M_reset_root(nullptr);
+        this->_M_reset_root(__op(__a, __b)._M_root);
+    }
+
+    void _M_set_union(_RbTreeImpl &__that) noexcept {
+        if (&__that == this) {
+            return;
+        }
+        _RbTreeNode *__dups = nullptr;
+        _RbTreeNode **__tail = &__dups;
+        this->_M_combine(__that, [&](_Subtree __a, _Subtree __b) {
+            return this->template _M_union<true>(__a, __b, __tail);
+        });
+        *__tail = nullptr;
+        this->_M_destroy_list(__dups);
+    }
+
+    void _M_set_intersection(_RbTreeImpl &__that) noexcept {
+        if (&__that == this) {
+            return;
+        }
+        this->_M_combine(__that, [this](_Subtree __a, _Subtree __b) {
+            return this->_M_intersect(__a, __b);
+        });
+    }
+
+    void _M_set_difference(_RbTreeImpl &__that) noexcept {
+        if (&__that == this) {
+            this->clear();
+            return;
+        }
+        this->_M_combine(__that, [this](_Subtree __a, _Subtree __b) {
+            return this->_M_subtract(__a, __b);
+        });
+    }
+
+    // 与 std::map::merge 相同，_Unique 时 __that 中键已存在的元素留在
+    // __that 里，这些节点按顺序串起来后线性时间重新建树
+    template <bool _Unique> void _M_merge(_RbTreeImpl &__that) noexcept {
+        if (&__that == this) {
+            return;
+        }
+        _RbTreeNode *__dups = nullptr;
+        _RbTreeNode **__tail = &__dups;
+        this->_M_combine(__that, [&](_Subtree __a, _Subtree __b) {
+            return this->template _M_union<_Unique>(__a, __b, __tail);
+        });
+        *__tail = nullptr;
+        std::size_t __n = 0;
+        for (_RbTreeNode *__node = __dups; __node != nullptr;
+             __node = __node->_M_right) {
+            ++__n;
+        }
+        __that._M_reset_root(_Base::_M_build_balanced(__dups, __n));
+    }
+
+    // 并行批量操作（map/set 的 insert_bulk、union_with、for_each_parallel）：
+    // 递归的前几层用 __fork_join 把左右两半交给不同线程，B 树后端按顺序
+    // 执行。比较器、分配器和传入的函数都必须能在多个线程上同时调用。
+    // join/split 只改动参与的子树，互不相交的两半可以同时进行。
+    // 黑高不到 _S_fork_height（约 1000 个节点）的子树不再分叉；
+    // 这个阈值是估计值，还没有在多核机器上测量过
+    static constexpr std::size_t _S_fork_height = 10;
+
+    // 同 _M_union，两半的重复节点各自串成链，汇合后按顺序接上
+    template <bool _Unique>
+    _Subtree _M_parallel_union(_Subtree __a, _Subtree __b,
+                               _RbTreeNode **&__dups,
+                               std::size_t __depth) noexcept {
+        if (__depth == 0 || __a._M_height < _S_fork_height ||
+            __b._M_height < _S_fork_height) {
+            return this->_M_union<_Unique>(__a, __b, __dups);
+        }
+        _Subtree __a_left, __a_right, __b_left, __b_right;
+        _RbTreeNode *__root = _Base::_S_unlink_root(__a, __a_left, __a_right);
+        _RbTreeNode *__match = this->template _M_split<_NodeImpl, _Unique>(
+            __b, static_cast<_NodeImpl *>(__root)->_M_value, _M_comp,
+            __b_left, __b_right);
+        _RbTreeNode *__left_dups = nullptr, *__right_dups = nullptr;
+        _RbTreeNode **__left_tail = &__left_dups;
+        _RbTreeNode **__right_tail = &__right_dups;
+        _Subtree __left, __right;
+        mstl::__fork_join(
+            [&] {
+                __left = this->_M_parallel_union<_Unique>(
+                    __a_left, __b_left, __left_tail, __depth - 1);
+            },
+            [&] {
+                __right = this->_M_parallel_union<_Unique>(
+                    __a_right, __b_right, __right_tail, __depth - 1);
+            });
+        if (__left_dups != nullptr) {
+            *__dups = __left_dups;
+            __dups = __left_tail;
+        }
+        if (__match != nullptr) {
+            *__dups = __match;
+            __dups = &__match->_M_right;
+        }
+        if (__right_dups != nullptr) {
+            *__dups = __right_dups;
+            __dups = __right_tail;
+        }
+        return this->_M_join(__left, __root, __right);
+    }
+
+    // 区间二分到叶子，每个叶子在独立的临时树里用 _M_insert_range 建好
+    // （有序时线性），再两两并起来。_Unique 时靠前的元素优先
+    template <bool _Unique, class _RandIt>
+    _Subtree _M_parallel_build(_RandIt __first, _RandIt __last,
+                               std::size_t __depth) {
+        std::size_t __grain = std::size_t(2) << _S_fork_height;
+        if (__depth == 0 || std::size_t(__last - __first) < __grain) {
+            _RbTreeImpl __part(_M_alloc, _M_comp);
+            __part.template _M_insert_range<_Unique>(__first, __last, false);
+            _Subtree __tree = __part._M_whole_tree();
+            __part._M_reset_root(nullptr);
+            return __tree;
+        }
+        _RandIt __mid = __first + (__last - __first) / 2;
+        _Subtree __left{nullptr, 0}, __right{nullptr, 0};
+        try {
+            mstl::__fork_join(
+                [&] {
+                    __left = this->_M_parallel_build<_Unique>(__first, __mid,
+                                                              __depth - 1);
+                },
+                [&] {
+                    __right = this->_M_parallel_build<_Unique>(__mid, __last,
+                                                               __depth - 1);
+                });
+        } catch (...) {
+            this->_M_destroy_tree(__left._M_root);
+            this->_M_destroy_tree(__right._M_root);
+            throw;
+        }
+        return this->_M_parallel_absorb<_Unique>(__left, __right, __depth);
+    }
+
+    // 并起两棵树，_Unique 时释放 __b 中重复的节点
+    template <bool _Unique>
+    _Subtree _M_parallel_absorb(_Subtree __a, _Subtree __b,
+                                std::size_t __depth) noexcept {
+        _RbTreeNode *__dups = nullptr;
+        _RbTreeNode **__tail = &__dups;
+        _Subtree __tree =
+            this->_M_parallel_union<_Unique>(__a, __b, __tail, __depth);
+        *__tail = nullptr;
+        this->_M_destroy_list(__dups);
+        return __tree;
+    }
+
+    // 已有的元素优先，插入区间的元素排在等价的已有元素之后
+    template <bool _Unique, class _RandIt>
+    void _M_parallel_insert(_RandIt __first, _RandIt __last) {
+        std::size_t __depth = mstl::__fork_depth();
+        _Subtree __b =
+            this->_M_parallel_build<_Unique>(__first, __last, __depth);
+        _Subtree __a = this->_M_whole_tree();
+        this->_M_reset_root(
+            this->_M_parallel_absorb<_Unique>(__a, __b, __depth)._M_root);
+    }
+
+    void _M_parallel_set_union(_RbTreeImpl &__that) noexcept {
+        if (&__that == this) {
+            return;
+        }
+        std::size_t __depth = mstl::__fork_depth();
+        this->_M_combine(__that, [&](_Subtree __a, _Subtree __b) {
+            return this->template _M_parallel_absorb<true>(__a, __b, __depth);
+        });
+    }
+
+    // 对子树里的每个元素调用 __f，不保证顺序，不同线程上的调用可能同时进行
+    template <class _Fn>
+    void _M_parallel_for_each(_RbTreeNode *__node, _Fn &__f,
+                              std::size_t __depth) const {
+        if (__depth == 0 || __node == nullptr ||
+            _Base::_S_black_height(__node) < _S_fork_height) {
+            for (; __node != nullptr; __node = __node->_M_right) {
+                this->_M_parallel_for_each(__node->_M_left, __f, 0);
+                __f(static_cast<_NodeImpl *>(__node)->_M_value);
+            }
+            return;
+        }
+        mstl::__fork_join(
+            [&] {
+                this->_M_parallel_for_each(__node->_M_left, __f, __depth - 1);
+            },
+            [&] {
+                __f(static_cast<_NodeImpl *>(__node)->_M_value);
+                this->_M_parallel_for_each(__node->_M_right, __f,
+                                           __depth - 1);
+            });
+    }
+
+    template <class _Fn> void _M_parallel_for_each(_Fn &__f) const {
+        this->_M_parallel_for_each(_M_block->_M_root, __f,
+                                   mstl::__fork_depth());
     }
 
   protected:
     template <class _Tv> size_t _M_single_erase(_Tv &&__value) noexcept {
-        _RbTreeNode *__node = this->_M_find_node<_NodeImpl>(__value, _M_comp);
+        _RbTreeNode *__node =
+            this->template _M_find_node<_NodeImpl>(__value, _M_comp);
         if (__node != nullptr) {
             this->_M_erase_node(__node);
             static_cast<_NodeImpl *>(__node)->_M_destruct();
-            _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, __node);
+            _Base::template _M_deallocate<_NodeImpl>(_M_alloc, __node);
             return 1;
         } else {
             return 0;
@@ -817,9 +2158,13 @@ struct _RbTreeImpl : protected _RbTreeBase {
         return {__it, __num};
     }
 
+    // 键可能不是 _Tp（map 按键删除），不能经由公开的 equal_range
     template <class _Tv> size_t _M_multi_erase(_Tv &&__value) noexcept {
-        std::pair<iterator, iterator> __range = this->equal_range(__value);
-        return this->_M_erase_range(__range.first, __range.second).second;
+        auto __range =
+            this->template _M_equal_range<_NodeImpl>(__value, _M_comp);
+        return this->_M_erase_range(this->_M_prevent_end(__range.first),
+                                    this->_M_prevent_end(__range.second))
+            .second;
     }
 
   public:
@@ -830,25 +2175,25 @@ struct _RbTreeImpl : protected _RbTreeBase {
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     iterator lower_bound(_Tv &&__value) noexcept {
-        return this->_M_lower_bound<_NodeImpl>(__value, _M_comp);
+        return this->template _M_lower_bound<_NodeImpl>(__value, _M_comp);
     }
 
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     const_iterator lower_bound(_Tv &&__value) const noexcept {
-        return this->_M_lower_bound<_NodeImpl>(__value, _M_comp);
+        return this->template _M_lower_bound<_NodeImpl>(__value, _M_comp);
     }
 
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     iterator upper_bound(_Tv &&__value) noexcept {
-        return this->_M_upper_bound<_NodeImpl>(__value, _M_comp);
+        return this->template _M_upper_bound<_NodeImpl>(__value, _M_comp);
     }
 
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     const_iterator upper_bound(_Tv &&__value) const noexcept {
-        return this->_M_upper_bound<_NodeImpl>(__value, _M_comp);
+        return this->template _M_upper_bound<_NodeImpl>(__value, _M_comp);
     }
 
     template <class _Tv,
@@ -866,22 +2211,22 @@ struct _RbTreeImpl : protected _RbTreeBase {
 
     iterator lower_bound(_Tp const &__value) noexcept {
         return this->_M_prevent_end(
-            this->_M_lower_bound<_NodeImpl>(__value, _M_comp));
+            this->template _M_lower_bound<_NodeImpl>(__value, _M_comp));
     }
 
     const_iterator lower_bound(_Tp const &__value) const noexcept {
         return this->_M_prevent_end(
-            this->_M_lower_bound<_NodeImpl>(__value, _M_comp));
+            this->template _M_lower_bound<_NodeImpl>(__value, _M_comp));
     }
 
     iterator upper_bound(_Tp const &__value) noexcept {
         return this->_M_prevent_end(
-            this->_M_upper_bound<_NodeImpl>(__value, _M_comp));
+            this->template _M_upper_bound<_NodeImpl>(__value, _M_comp));
     }
 
     const_iterator upper_bound(_Tp const &__value) const noexcept {
         return this->_M_prevent_end(
-            this->_M_upper_bound<_NodeImpl>(__value, _M_comp));
+            this->template _M_upper_bound<_NodeImpl>(__value, _M_comp));
     }
 
     std::pair<iterator, iterator> equal_range(_Tp const &__value) noexcept {
@@ -893,10 +2238,83 @@ struct _RbTreeImpl : protected _RbTreeBase {
         return {this->lower_bound(__value), this->upper_bound(__value)};
     }
 
+    // 通过迭代器改动了参与增强计算的值以后调用，重新计算它到根的路径
+    void refresh(const_iterator __it) noexcept {
+        _Base::_M_update_path(__it._M_node);
+    }
+
+    // 自定义增强的查询从根往下走，空树返回 nullptr
+    typename _Augment::_Node const *root_node() const noexcept {
+        return static_cast<typename _Augment::_Node const *>(
+            _M_block->_M_root);
+    }
+
+    // 顺序统计，要求 _Augment 记录子树大小（见 mstl::ranked_set）。
+    // 中序第 __k 个元素（从 0 开始），__k >= size() 时返回 end()
+    iterator nth(std::size_t __k) noexcept {
+        static_assert(_RbTreeHasSize<_Augment>::value,
+                      "nth requires the subtree size augmentation");
+        return this->_M_prevent_end(this->_M_nth_node(__k));
+    }
+
+    const_iterator nth(std::size_t __k) const noexcept {
+        static_assert(_RbTreeHasSize<_Augment>::value,
+                      "nth requires the subtree size augmentation");
+        return this->_M_prevent_end(this->_M_nth_node(__k));
+    }
+
+    // 小于 __value 的元素个数，也就是 lower_bound(__value) 的下标
+    template <class _Tv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
+    std::size_t rank(_Tv &&__value) const noexcept {
+        static_assert(_RbTreeHasSize<_Augment>::value,
+                      "rank requires the subtree size augmentation");
+        return this->template _M_rank<_NodeImpl, false>(__value, _M_comp);
+    }
+
+    std::size_t rank(_Tp const &__value) const noexcept {
+        static_assert(_RbTreeHasSize<_Augment>::value,
+                      "rank requires the subtree size augmentation");
+        return this->template _M_rank<_NodeImpl, false>(__value, _M_comp);
+    }
+
+    // __it 之前的元素个数，end() 对应 size()
+    std::size_t rank(const_iterator __it) const noexcept {
+        static_assert(_RbTreeHasSize<_Augment>::value,
+                      "rank requires the subtree size augmentation");
+        return __it == this->end() ? this->size()
+                                   : _Base::_M_node_rank(__it._M_node);
+    }
+
+    // 落在 [__lo, __hi) 中的元素个数
+    template <class _Tv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
+    std::size_t count_range(_Tv const &__lo,
+                            _Tv const &__hi) const noexcept {
+        std::size_t __lo_rank = this->rank(__lo);
+        std::size_t __hi_rank = this->rank(__hi);
+        return __hi_rank > __lo_rank ? __hi_rank - __lo_rank : 0;
+    }
+
+    std::size_t count_range(_Tp const &__lo, _Tp const &__hi) const noexcept {
+        std::size_t __lo_rank = this->rank(__lo);
+        std::size_t __hi_rank = this->rank(__hi);
+        return __hi_rank > __lo_rank ? __hi_rank - __lo_rank : 0;
+    }
+
   protected:
     template <class _Tv> size_t _M_multi_count(_Tv &&__value) const noexcept {
-        const_iterator __it = this->lower_bound(__value);
-        return __it != end() ? std::distance(__it, this->upper_bound()) : 0;
+        if constexpr (_RbTreeHasSize<_Augment>::value) {
+            return this->template _M_rank<_NodeImpl, true>(__value, _M_comp) -
+                   this->template _M_rank<_NodeImpl, false>(__value, _M_comp);
+        }
+        auto __range =
+            this->template _M_equal_range<_NodeImpl>(__value, _M_comp);
+        if (__range.first == nullptr) {
+            return 0;
+        }
+        return std::distance(const_iterator(__range.first),
+                             this->_M_prevent_end(__range.second));
     }
 
     template <class _Tv> bool _M_contains(_Tv &&__value) const noexcept {
@@ -904,6 +2322,93 @@ struct _RbTreeImpl : protected _RbTreeBase {
                nullptr;
     }
 
+    // 以 __finger 为起点查找（map/set 的 find/lower_bound/upper_bound 带
+    // 迭代器的重载）。__finger 可以是任意有效的迭代器或 end()，通常是
+    // 上一次查找的结果；目标在它附近时只经过几层，远了就从根查找，见
+    // _RbTreeBase::_M_finger_bound。目标分布较散的连续查找用 _TreeCursor
+    template <bool _Upper, class _Tv>
+    iterator _M_finger_bound(const_iterator __finger,
+                             _Tv const &__value) noexcept {
+        return this->_M_prevent_end(
+            _Base::template _M_finger_bound<_NodeImpl, _Upper>(
+                _RbTreeImpl::_M_hint_node(__finger), __value, _M_comp));
+    }
+
+    template <bool _Upper, class _Tv>
+    const_iterator _M_finger_bound(const_iterator __finger,
+                                   _Tv const &__value) const noexcept {
+        return this->_M_prevent_end(
+            _Base::template _M_finger_bound<_NodeImpl, _Upper>(
+                _RbTreeImpl::_M_hint_node(__finger), __value, _M_comp));
+    }
+
+    // 等价元素有多个时返回第一个
+    template <class _Tv>
+    iterator _M_finger_find(const_iterator __finger,
+                            _Tv const &__value) noexcept {
+        iterator __it =
+            this->template _M_finger_bound<false>(__finger, __value);
+        return __it != this->end() && _M_comp(__value, *__it) ? this->end()
+                                                               : __it;
+    }
+
+    template <class _Tv>
+    const_iterator _M_finger_find(const_iterator __finger,
+                                  _Tv const &__value) const noexcept {
+        const_iterator __it =
+            this->template _M_finger_bound<false>(__finger, __value);
+        return __it != this->end() && _M_comp(__value, *__it) ? this->end()
+                                                               : __it;
+    }
+
+    // 游标的查找，见 _M_path_bound 和 _TreeCursor
+    using _CursorPath = _RbTreePath;
+
+    template <class, class, class> friend struct _TreeCursor;
+
+    template <bool _Upper, class _Tv>
+    iterator _M_cursor_bound(_RbTreePath &__path,
+                             _Tv const &__value) noexcept {
+        return this->_M_prevent_end(
+            _Base::template _M_path_bound<_NodeImpl, _Upper>(__path, __value,
+                                                             _M_comp));
+    }
+
+    template <bool _Upper, class _Tv>
+    const_iterator _M_cursor_bound(_RbTreePath &__path,
+                                   _Tv const &__value) const noexcept {
+        return this->_M_prevent_end(
+            _Base::template _M_path_bound<_NodeImpl, _Upper>(__path, __value,
+                                                             _M_comp));
+    }
+
+    template <class _KeyIt, class _OutIt>
+    _OutIt _M_find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) {
+        this->template _M_find_nodes<_NodeImpl>(
+            __first, __last, _M_comp, [&](_RbTreeNode *__node) {
+                *__out++ = this->_M_prevent_end(__node);
+            });
+        return __out;
+    }
+
+    template <class _KeyIt, class _OutIt>
+    _OutIt _M_find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) const {
+        this->template _M_find_nodes<_NodeImpl>(
+            __first, __last, _M_comp, [&](_RbTreeNode *__node) {
+                *__out++ = this->_M_prevent_end(__node);
+            });
+        return __out;
+    }
+
+    template <class _KeyIt, class _OutIt>
+    _OutIt _M_contains_many(_KeyIt __first, _KeyIt __last,
+                            _OutIt __out) const {
+        this->template _M_find_nodes<_NodeImpl>(
+            __first, __last, _M_comp,
+            [&](_RbTreeNode *__node) { *__out++ = __node != nullptr; });
+        return __out;
+    }
+
     iterator _M_prevent_end(_RbTreeNode *__node) noexcept {
         return __node == nullptr ? end() : __node;
     }
@@ -929,9 +2434,9 @@ struct _RbTreeImpl : protected _RbTreeBase {
         return this->_M_prevent_rend(this->_M_max_node());
     }
 
-    iterator end() noexcept { return &_M_block->_M_root; }
+    iterator end() noexcept { return _M_block; }
 
-    reverse_iterator rend() noexcept { return &_M_block->_M_root; }
+    reverse_iterator rend() noexcept { return _M_block; }
 
     const_iterator begin() const noexcept {
         return this->_M_prevent_end(this->_M_min_node());
@@ -941,9 +2446,9 @@ struct _RbTreeImpl : protected _RbTreeBase {
         return this->_M_prevent_rend(this->_M_max_node());
     }
 
-    const_iterator end() const noexcept { return &_M_block->_M_root; }
+    const_iterator end() const noexcept { return _M_block; }
 
-    const_reverse_iterator rend() const noexcept { return &_M_block->_M_root; }
+    const_reverse_iterator rend() const noexcept { return _M_block; }
 
 #ifndef NDEBUG
     template <class _Ostream>
@@ -962,19 +2467,17 @@ struct _RbTreeImpl : protected _RbTreeBase {
             }
             __os << ' ';
 #endif
-            __os << (__node->_M_color == _S_black ? 'B' : 'R');
+            __os << (__node->_M_color() == _S_black ? 'B' : 'R');
             __os << ' ';
             if (__node->_M_left) {
-                if (__node->_M_left->_M_parent != __node ||
-                    __node->_M_left->_M_pparent != &__node->_M_left) {
+                if (__node->_M_left->_M_parent() != __node) {
                     __os << '*';
                 }
             }
             _M_print(__os, __node->_M_left);
             __os << ' ';
             if (__node->_M_right) {
-                if (__node->_M_right->_M_parent != __node ||
-                    __node->_M_right->_M_pparent != &__node->_M_right) {
+                if (__node->_M_right->_M_parent() != __node) {
                     __os << '*';
                 }
             }
@@ -994,8 +2497,50 @@ struct _RbTreeImpl : protected _RbTreeBase {
     bool empty() const noexcept { return this->_M_block->_M_root == nullptr; }
 
     size_t size() const noexcept {
+        if constexpr (_RbTreeHasSize<_Augment>::value) {
+            return _Augment::_S_size(this->_M_block->_M_root);
+        }
         return std::distance(this->begin(), this->end());
     }
 };
 
+// map/set 的查找游标：记住上一次查找在树中的路径，下一次从路径末端退回
+// 几层再往下走（见 _M_path_bound），连续查找相近的键时不必每次从根开始，
+// 相距很远时也和从根查找差不多。B 树后端每次从根查找。
+// 容器的任何插入、删除都会使游标失效，之后要先 reset()
+template <class _Tree, class _Iterator, class _Key> struct _TreeCursor {
+  private:
+    _Tree *_M_tree;
+    typename std::remove_const_t<_Tree>::_CursorPath _M_path;
+
+  public:
+    explicit _TreeCursor(_Tree &__tree) noexcept
+        : _M_tree(std::addressof(__tree)) {}
+
+    void reset() noexcept { _M_path._M_reset(); }
+
+    _Iterator lower_bound(_Key const &__key) noexcept {
+        return _M_tree->template _M_cursor_bound<false>(_M_path, __key);
+    }
+
+    _Iterator upper_bound(_Key const &__key) noexcept {
+        return _M_tree->template _M_cursor_bound<true>(_M_path, __key);
+    }
+
+    // 等价元素有多个时返回第一个
+    _Iterator find(_Key const &__key) noexcept {
+        _Iterator __it = this->lower_bound(__key);
+        return __it != _M_tree->end() && _M_tree->_M_comp(__key, *__it)
+                   ? _M_tree->end()
+                   : __it;
+    }
+};
+
+// map/set 的最后一个模板参数选择底层实现：默认是红黑树和它的增强策略，
+// _btree.hpp 为 _BTreeTag 特化成 B 树
+template <class _Tp, class _Compare, class _Alloc, class _Tag>
+struct _TreeImplSelect {
+    using type = _RbTreeImpl<_Tp, _Compare, _Alloc, _Tag>;
+};
+
 #endif // !__RBTREE__
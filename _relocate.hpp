@@ -0,0 +1,74 @@
+#ifndef __RELOCATE__
+#define __RELOCATE__
+
+/*
+
+ -- 平凡搬迁（trivially relocatable）支持 --
+
+ 搬迁 = 在新地址移动构造 + 析构旧地址的对象。
+ 对于绝大多数类型（int、POD、unique_ptr、vector 自身……），这一对操作
+ 等价于按字节拷贝，因此容器在扩容、插入、删除时可以直接 memmove。
+
+*/
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace mstl {
+
+// 平凡可复制的类型自动满足；用户类型可以通过特化选择加入：
+//   template <> struct mstl::is_trivially_relocatable<MyType> : std::true_type {};
+template <typename T>
+struct is_trivially_relocatable
+    : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+// pair 的赋值运算符不是平凡的，但只要两个成员都能按字节搬迁，pair 也可以
+template <typename T1, typename T2>
+struct is_trivially_relocatable<std::pair<T1, T2>>
+    : std::bool_constant<
+          is_trivially_relocatable<std::remove_const_t<T1>>::value &&
+          is_trivially_relocatable<std::remove_const_t<T2>>::value> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+// 把 [first, last) 搬迁到 dest，允许区间重叠；
+// 调用后源区间中不与目标重叠的部分视为未初始化内存（不再析构）
+template <typename T>
+T *trivially_relocate(T *first, T *last, T *dest) noexcept {
+    static_assert(is_trivially_relocatable_v<T>,
+                  "T is not trivially relocatable");
+    std::size_t n = last - first;
+    if (n != 0 && first != dest) [[likely]] {
+        std::memmove(static_cast<void *>(dest),
+                     static_cast<void const *>(first), n * sizeof(T));
+    }
+    return dest + n;
+}
+
+// 分配器可以额外提供
+//   T *reallocate(T *p, size_t old_n, size_t new_n, size_t used);
+// 按字节把块搬到新容量（例如 mremap），容器对可平凡搬迁的元素会优先使用它
+template <typename Alloc, typename = void>
+struct allocator_has_reallocate : std::false_type {};
+
+template <typename Alloc>
+struct allocator_has_reallocate<
+    Alloc, decltype((void)std::declval<Alloc &>().reallocate(
+               std::declval<typename Alloc::value_type *>(), std::size_t(),
+               std::size_t(), std::size_t()))> : std::true_type {};
+
+template <typename Alloc>
+inline constexpr bool allocator_has_reallocate_v =
+    allocator_has_reallocate<Alloc>::value;
+
+} // namespace mstl
+
+#endif // !__RELOCATE__
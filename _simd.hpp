@@ -0,0 +1,296 @@
+#ifndef __SIMD__
+#define __SIMD__
+
+/*
+
+ -- 连续内存上的向量化比较/查找内核 --
+
+ 指令集在编译期选择：定义了 __AVX2__（-mavx2）时每次处理 32 字节，
+ x86-64 默认的 SSE2 每次处理 16 字节，其余平台退化为标量循环。
+ 只对整数、枚举、指针（可按字节比较）以及 float/double 走向量化路径，
+ 浮点使用有序相等比较，因此 NaN、+0/-0 的语义与 operator== 完全一致。
+
+*/
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <version>
+
+#if defined(__AVX2__)
+#define _LIBPENGCXX_SIMD_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) ||                                 \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define _LIBPENGCXX_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace mstl {
+
+// 可以按字节比较相等的标量类型
+template <class _Tp>
+inline constexpr bool __is_bitwise_comparable_v =
+    (std::is_integral_v<_Tp> || std::is_enum_v<_Tp> ||
+     std::is_pointer_v<_Tp>) &&
+    std::has_unique_object_representations_v<_Tp> && sizeof(_Tp) <= 8;
+
+template <class _Tp>
+inline constexpr bool __is_simd_comparable_v =
+    __is_bitwise_comparable_v<_Tp> || std::is_same_v<_Tp, float> ||
+    std::is_same_v<_Tp, double>;
+
+// 两个迭代器都是指向同一种可向量化类型的指针
+template <class _It1, class _It2, class = void>
+inline constexpr bool __is_simd_range_v = false;
+
+template <class _It1, class _It2>
+inline constexpr bool __is_simd_range_v<
+    _It1, _It2,
+    std::enable_if_t<std::is_pointer_v<_It1> && std::is_pointer_v<_It2>>> =
+    std::is_same_v<std::remove_cv_t<std::remove_pointer_t<_It1>>,
+                   std::remove_cv_t<std::remove_pointer_t<_It2>>> &&
+    __is_simd_comparable_v<std::remove_cv_t<std::remove_pointer_t<_It1>>>;
+
+#if defined(_LIBPENGCXX_SIMD_AVX2) || defined(_LIBPENGCXX_SIMD_SSE2)
+#define _LIBPENGCXX_SIMD 1
+
+#if defined(_LIBPENGCXX_SIMD_AVX2)
+using __simd_reg = __m256i;
+#else
+using __simd_reg = __m128i;
+#endif
+
+inline constexpr std::size_t __simd_width = sizeof(__simd_reg);
+
+inline __simd_reg __simd_load(void const *__p) noexcept {
+#if defined(_LIBPENGCXX_SIMD_AVX2)
+    return _mm256_loadu_si256(static_cast<__m256i const *>(__p));
+#else
+    return _mm_loadu_si128(static_cast<__m128i const *>(__p));
+#endif
+}
+
+// 逐元素相等比较：相等的元素对应的通道全为 1，否则全为 0
+template <class _Tp>
+__simd_reg __simd_eq_lanes(__simd_reg __x, __simd_reg __y) noexcept {
+#if defined(_LIBPENGCXX_SIMD_AVX2)
+    if constexpr (std::is_same_v<_Tp, float>) {
+        return _mm256_castps_si256(_mm256_cmp_ps(
+            _mm256_castsi256_ps(__x), _mm256_castsi256_ps(__y), _CMP_EQ_OQ));
+    } else if constexpr (std::is_same_v<_Tp, double>) {
+        return _mm256_castpd_si256(_mm256_cmp_pd(
+            _mm256_castsi256_pd(__x), _mm256_castsi256_pd(__y), _CMP_EQ_OQ));
+    } else if constexpr (sizeof(_Tp) == 1) {
+        return _mm256_cmpeq_epi8(__x, __y);
+    } else if constexpr (sizeof(_Tp) == 2) {
+        return _mm256_cmpeq_epi16(__x, __y);
+    } else if constexpr (sizeof(_Tp) == 4) {
+        return _mm256_cmpeq_epi32(__x, __y);
+    } else {
+        return _mm256_cmpeq_epi64(__x, __y);
+    }
+#else
+    if constexpr (std::is_same_v<_Tp, float>) {
+        return _mm_castps_si128(
+            _mm_cmpeq_ps(_mm_castsi128_ps(__x), _mm_castsi128_ps(__y)));
+    } else if constexpr (std::is_same_v<_Tp, double>) {
+        return _mm_castpd_si128(
+            _mm_cmpeq_pd(_mm_castsi128_pd(__x), _mm_castsi128_pd(__y)));
+    } else if constexpr (sizeof(_Tp) == 1) {
+        return _mm_cmpeq_epi8(__x, __y);
+    } else if constexpr (sizeof(_Tp) == 2) {
+        return _mm_cmpeq_epi16(__x, __y);
+    } else if constexpr (sizeof(_Tp) == 4) {
+        return _mm_cmpeq_epi32(__x, __y);
+    } else {
+        // SSE2 没有 64 位整数比较：两个 32 位半边都相等才算相等
+        __m128i __r = _mm_cmpeq_epi32(__x, __y);
+        return _mm_and_si128(__r,
+                             _mm_shuffle_epi32(__r, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+#endif
+}
+
+// 每个字节一位的掩码，元素相等时它的所有字节位都为 1
+inline std::uint32_t __simd_movemask(__simd_reg __r) noexcept {
+#if defined(_LIBPENGCXX_SIMD_AVX2)
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(__r));
+#else
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(__r));
+#endif
+}
+
+// 按 _Size 字节宽的通道做减法；相等通道为 -1，减去即计数加一
+template <std::size_t _Size>
+__simd_reg __simd_sub_lanes(__simd_reg __acc, __simd_reg __m) noexcept {
+#if defined(_LIBPENGCXX_SIMD_AVX2)
+    if constexpr (_Size == 1)
+        return _mm256_sub_epi8(__acc, __m);
+    else if constexpr (_Size == 2)
+        return _mm256_sub_epi16(__acc, __m);
+    else if constexpr (_Size == 4)
+        return _mm256_sub_epi32(__acc, __m);
+    else
+        return _mm256_sub_epi64(__acc, __m);
+#else
+    if constexpr (_Size == 1)
+        return _mm_sub_epi8(__acc, __m);
+    else if constexpr (_Size == 2)
+        return _mm_sub_epi16(__acc, __m);
+    else if constexpr (_Size == 4)
+        return _mm_sub_epi32(__acc, __m);
+    else
+        return _mm_sub_epi64(__acc, __m);
+#endif
+}
+
+inline constexpr std::uint32_t __simd_all_ones =
+    __simd_width == 32 ? 0xFFFFFFFFu : 0x0000FFFFu;
+#endif
+
+// 返回第一个 !(a[i] == b[i]) 的下标，全部相等时返回 n
+template <class _Tp>
+std::size_t __simd_mismatch(_Tp const *__a, _Tp const *__b,
+                            std::size_t __n) noexcept {
+    std::size_t __i = 0;
+#ifdef _LIBPENGCXX_SIMD
+    constexpr std::size_t __step = __simd_width / sizeof(_Tp);
+    std::size_t __nvec = __n - __n % __step;
+    for (; __i < __nvec; __i += __step) {
+        std::uint32_t __m = __simd_movemask(__simd_eq_lanes<_Tp>(
+            __simd_load(__a + __i), __simd_load(__b + __i)));
+        if (__m != __simd_all_ones) {
+            return __i + std::countr_zero(~__m) / sizeof(_Tp);
+        }
+    }
+#endif
+    for (; __i < __n; __i++) {
+        if (!(__a[__i] == __b[__i]))
+            return __i;
+    }
+    return __n;
+}
+
+// 返回第一个等于 value 的下标，找不到时返回 n
+template <class _Tp>
+std::size_t __simd_find(_Tp const *__a, std::size_t __n,
+                        _Tp const &__value) noexcept {
+    std::size_t __i = 0;
+#ifdef _LIBPENGCXX_SIMD
+    constexpr std::size_t __step = __simd_width / sizeof(_Tp);
+    _Tp __splat[__step];
+    std::fill_n(__splat, __step, __value);
+    __simd_reg __v = __simd_load(__splat);
+    std::size_t __nvec = __n - __n % __step;
+    for (; __i < __nvec; __i += __step) {
+        std::uint32_t __m = __simd_movemask(
+            __simd_eq_lanes<_Tp>(__simd_load(__a + __i), __v));
+        if (__m != 0) {
+            return __i + std::countr_zero(__m) / sizeof(_Tp);
+        }
+    }
+#endif
+    for (; __i < __n; __i++) {
+        if (__a[__i] == __value)
+            return __i;
+    }
+    return __n;
+}
+
+// 返回等于 value 的元素个数
+template <class _Tp>
+std::size_t __simd_count(_Tp const *__a, std::size_t __n,
+                         _Tp const &__value) noexcept {
+    std::size_t __i = 0;
+    std::size_t __count = 0;
+#ifdef _LIBPENGCXX_SIMD
+    constexpr std::size_t __step = __simd_width / sizeof(_Tp);
+    // 窄通道的计数器会溢出，每累加 __flush 轮就汇总一次
+    constexpr std::size_t __flush = sizeof(_Tp) == 1   ? 255
+                                    : sizeof(_Tp) == 2 ? 65535
+                                                       : std::size_t(1) << 30;
+    using _Lane = std::conditional_t<
+        sizeof(_Tp) == 1, std::uint8_t,
+        std::conditional_t<
+            sizeof(_Tp) == 2, std::uint16_t,
+            std::conditional_t<sizeof(_Tp) == 4, std::uint32_t,
+                               std::uint64_t>>>;
+    _Tp __splat[__step];
+    std::fill_n(__splat, __step, __value);
+    __simd_reg __v = __simd_load(__splat);
+    std::size_t __nvec = __n - __n % __step;
+    while (__i < __nvec) {
+        std::size_t __stop = std::min(__nvec, __i + __flush * __step);
+        __simd_reg __acc{};
+        for (; __i < __stop; __i += __step) {
+            __acc = __simd_sub_lanes<sizeof(_Tp)>(
+                __acc, __simd_eq_lanes<_Tp>(__simd_load(__a + __i), __v));
+        }
+        _Lane __lanes[__step];
+        std::memcpy(__lanes, &__acc, sizeof(__acc));
+        for (std::size_t __k = 0; __k < __step; __k++) {
+            __count += __lanes[__k];
+        }
+    }
+#endif
+    for (; __i < __n; __i++) {
+        if (__a[__i] == __value)
+            ++__count;
+    }
+    return __count;
+}
+
+// 供 _LIBPENGCXX_DEFINE_COMPARISON 使用：连续的可向量化区间走上面的内核，
+// 其他情况退回 std::equal / std::lexicographical_compare_three_way
+template <class _It1, class _It2>
+bool __range_equal(_It1 __first1, _It1 __last1, _It2 __first2,
+                   _It2 __last2) noexcept {
+    if constexpr (__is_simd_range_v<_It1, _It2>) {
+        std::size_t __n = __last1 - __first1;
+        if (__n != std::size_t(__last2 - __first2))
+            return false;
+        if constexpr (__is_bitwise_comparable_v<
+                          std::remove_cv_t<std::remove_pointer_t<_It1>>>) {
+            return __n == 0 ||
+                   std::memcmp(__first1, __first2, __n * sizeof(*__first1)) ==
+                       0;
+        } else {
+            return mstl::__simd_mismatch<
+                       std::remove_cv_t<std::remove_pointer_t<_It1>>>(
+                       __first1, __first2, __n) == __n;
+        }
+    } else {
+        return std::equal(__first1, __last1, __first2, __last2);
+    }
+}
+
+#ifdef __cpp_lib_three_way_comparison
+template <class _It1, class _It2>
+auto __range_compare_three_way(_It1 __first1, _It1 __last1, _It2 __first2,
+                               _It2 __last2) noexcept {
+    if constexpr (__is_simd_range_v<_It1, _It2>) {
+        std::size_t __n1 = __last1 - __first1;
+        std::size_t __n2 = __last2 - __first2;
+        std::size_t __n = std::min(__n1, __n2);
+        std::size_t __i = mstl::__simd_mismatch<
+            std::remove_cv_t<std::remove_pointer_t<_It1>>>(__first1, __first2,
+                                                           __n);
+        using _Cat = decltype(*__first1 <=> *__first2);
+        if (__i != __n)
+            return _Cat(__first1[__i] <=> __first2[__i]);
+        return _Cat(__n1 <=> __n2);
+    } else {
+        return std::lexicographical_compare_three_way(__first1, __last1,
+                                                      __first2, __last2);
+    }
+}
+#endif
+
+} // namespace mstl
+
+#endif // !__SIMD__
@@ -0,0 +1,234 @@
+#ifndef __AGGREGATE_MAP__
+#define __AGGREGATE_MAP__
+
+/*
+
+ -- 区间聚合 map --
+
+ 每个节点额外记录子树里所有 mapped 的聚合值，range_aggregate(lo, hi)
+ 求键落在 [lo, hi) 内的聚合只要 O(log n)，不必逐个遍历。
+
+ - 聚合操作 _Op 提供 data_type、identity()、lift(mapped) 和满足结合律的
+   combine(a, b)。结果按键的顺序组合，不要求交换律；
+ - 内置 sum_aggregate、min_aggregate、max_aggregate；
+ - 迭代器都是只读的，mapped 只能通过 insert_or_assign 修改，聚合值始终
+   与内容一致。
+
+*/
+
+#include "_common.hpp"
+#include "map.hpp"
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <utility>
+
+namespace mstl {
+
+template <class _Tp> struct sum_aggregate {
+    using data_type = _Tp;
+
+    static _Tp identity() noexcept { return _Tp(); }
+
+    static _Tp lift(_Tp const &__value) noexcept { return __value; }
+
+    static _Tp combine(_Tp const &__lhs, _Tp const &__rhs) noexcept {
+        return __lhs + __rhs;
+    }
+};
+
+template <class _Tp> struct min_aggregate {
+    using data_type = _Tp;
+
+    static _Tp identity() noexcept { return std::numeric_limits<_Tp>::max(); }
+
+    static _Tp lift(_Tp const &__value) noexcept { return __value; }
+
+    static _Tp combine(_Tp const &__lhs, _Tp const &__rhs) noexcept {
+        return __rhs < __lhs ? __rhs : __lhs;
+    }
+};
+
+template <class _Tp> struct max_aggregate {
+    using data_type = _Tp;
+
+    static _Tp identity() noexcept {
+        return std::numeric_limits<_Tp>::lowest();
+    }
+
+    static _Tp lift(_Tp const &__value) noexcept { return __value; }
+
+    static _Tp combine(_Tp const &__lhs, _Tp const &__rhs) noexcept {
+        return __lhs < __rhs ? __rhs : __lhs;
+    }
+};
+
+// 节点的聚合 = 左子树聚合 + 自己的 mapped + 右子树聚合
+template <class _Op> struct _AggregateMapPolicy {
+    using data_type = typename _Op::data_type;
+
+    template <class _Node> static void update(_Node &__node) noexcept {
+        data_type __data = _Op::lift(__node.value().second);
+        if (__node.left() != nullptr) {
+            __data = _Op::combine(__node.left()->data(), __data);
+        }
+        if (__node.right() != nullptr) {
+            __data = _Op::combine(__data, __node.right()->data());
+        }
+        __node.data() = __data;
+    }
+};
+
+template <class _Key, class _Mapped, class _Op = sum_aggregate<_Mapped>,
+          class _Compare = std::less<_Key>,
+          class _Alloc = std::allocator<std::pair<_Key const, _Mapped>>>
+struct aggregate_map : private augmented_map<_Key, _Mapped,
+                                             _AggregateMapPolicy<_Op>,
+                                             _Compare, _Alloc> {
+  private:
+    using _Impl = augmented_map<_Key, _Mapped, _AggregateMapPolicy<_Op>,
+                                _Compare, _Alloc>;
+    using _Data = typename _Op::data_type;
+
+  public:
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using value_type = std::pair<_Key const, _Mapped>;
+    using aggregate_type = _Data;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using const_iterator = typename _Impl::const_iterator;
+    using iterator = const_iterator;
+
+    aggregate_map() = default;
+
+    aggregate_map(std::initializer_list<value_type> __ilist)
+        : _Impl(__ilist) {}
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    explicit aggregate_map(_InputIt __first, _InputIt __last)
+        : _Impl(__first, __last) {}
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    aggregate_map(sorted_unique_t, _InputIt __first, _InputIt __last)
+        : _Impl(sorted_unique, __first, __last) {}
+
+    aggregate_map(aggregate_map &&) = default;
+    aggregate_map &operator=(aggregate_map &&) = default;
+    aggregate_map(aggregate_map const &) = default;
+    aggregate_map &operator=(aggregate_map const &) = default;
+
+    // mapped 参与聚合，不能经由迭代器修改，begin/end 统一返回只读迭代器
+    const_iterator begin() const noexcept { return _Impl::begin(); }
+
+    const_iterator end() const noexcept { return _Impl::end(); }
+
+    using _Impl::clear;
+    using _Impl::contains;
+    using _Impl::count;
+    using _Impl::empty;
+    using _Impl::size;
+
+    const_iterator find(_Key const &__key) const noexcept {
+        return _Impl::find(__key);
+    }
+
+    _Mapped const &at(_Key const &__key) const { return _Impl::at(__key); }
+
+    std::pair<const_iterator, bool> insert(value_type const &__value) {
+        return _Impl::insert(__value);
+    }
+
+    std::pair<const_iterator, bool> insert(value_type &&__value) {
+        return _Impl::insert(std::move(__value));
+    }
+
+    template <class... _Ts>
+    std::pair<const_iterator, bool> emplace(_Ts &&...__value) {
+        return _Impl::emplace(std::forward<_Ts>(__value)...);
+    }
+
+    template <class... _Ms>
+    std::pair<const_iterator, bool> try_emplace(_Key const &__key,
+                                                _Ms &&...__mapped) {
+        return _Impl::try_emplace(__key, std::forward<_Ms>(__mapped)...);
+    }
+
+    // 键已存在时改写 mapped 并重算它到根的聚合
+    template <class _Mp>
+    std::pair<const_iterator, bool> insert_or_assign(_Key const &__key,
+                                                     _Mp &&__mapped) {
+        auto __result = _Impl::try_emplace(__key, std::forward<_Mp>(__mapped));
+        if (!__result.second) {
+            __result.first->second = std::forward<_Mp>(__mapped);
+            this->refresh(__result.first);
+        }
+        return __result;
+    }
+
+    std::size_t erase(_Key const &__key) { return _Impl::erase(__key); }
+
+    const_iterator erase(const_iterator __it) noexcept {
+        return _Impl::erase(__it);
+    }
+
+    // 全部元素的聚合，空表返回 identity()
+    _Data aggregate() const noexcept {
+        auto const *__root = this->root_node();
+        return __root != nullptr ? __root->data() : _Op::identity();
+    }
+
+    // 键落在 [__lo, __hi) 内的元素的聚合。先找到第一个落在区间内的
+    // 分叉节点，再沿左边界收集后缀、沿右边界收集前缀，各 O(log n)
+    _Data range_aggregate(_Key const &__lo, _Key const &__hi) const noexcept {
+        auto const *__node = this->root_node();
+        while (__node != nullptr) {
+            if (this->_M_comp(__node->value(), __lo)) {
+                __node = __node->right();
+            } else if (!this->_M_comp(__node->value(), __hi)) {
+                __node = __node->left();
+            } else {
+                break;
+            }
+        }
+        if (__node == nullptr) {
+            return _Op::identity();
+        }
+        _Data __result = _Op::lift(__node->value().second);
+        // 左子树里键 >= __lo 的部分，从右往左拼在前面
+        for (auto const *__cur = __node->left(); __cur != nullptr;) {
+            if (!this->_M_comp(__cur->value(), __lo)) {
+                _Data __part = _Op::lift(__cur->value().second);
+                if (__cur->right() != nullptr) {
+                    __part = _Op::combine(__part, __cur->right()->data());
+                }
+                __result = _Op::combine(__part, __result);
+                __cur = __cur->left();
+            } else {
+                __cur = __cur->right();
+            }
+        }
+        // 右子树里键 < __hi 的部分，从左往右拼在后面
+        for (auto const *__cur = __node->right(); __cur != nullptr;) {
+            if (this->_M_comp(__cur->value(), __hi)) {
+                _Data __part = _Op::lift(__cur->value().second);
+                if (__cur->left() != nullptr) {
+                    __part = _Op::combine(__cur->left()->data(), __part);
+                }
+                __result = _Op::combine(__result, __part);
+                __cur = __cur->right();
+            } else {
+                __cur = __cur->left();
+            }
+        }
+        return __result;
+    }
+};
+
+} // namespace mstl
+
+#endif // !__AGGREGATE_MAP__
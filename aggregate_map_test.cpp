@@ -0,0 +1,26 @@
+#include "aggregate_map.hpp"
+#include <cstdio>
+
+int main() {
+    // 每秒的成交量，按时间段求和
+    mstl::aggregate_map<int, long> volume;
+    for (int t = 0; t < 60; t++) {
+        volume.try_emplace(t, 100 + t);
+    }
+    printf("total = %ld\n", volume.aggregate());
+    printf("volume[10, 20) = %ld\n", volume.range_aggregate(10, 20));
+    volume.insert_or_assign(15, 0);
+    printf("after reset 15: volume[10, 20) = %ld\n",
+           volume.range_aggregate(10, 20));
+    volume.erase(10);
+    printf("after erase 10: volume[10, 20) = %ld\n",
+           volume.range_aggregate(10, 20));
+
+    // 区间最低价
+    mstl::aggregate_map<int, int, mstl::min_aggregate<int>> low = {
+        {1, 52}, {2, 48}, {3, 50}, {4, 47}, {5, 49}};
+    printf("low[1, 4) = %d, low[3, 6) = %d\n", low.range_aggregate(1, 4),
+           low.range_aggregate(3, 6));
+    printf("low[6, 9) is empty: %d\n",
+           low.range_aggregate(6, 9) == mstl::min_aggregate<int>::identity());
+}
@@ -0,0 +1,53 @@
+#ifndef __ALGORITHM__
+#define __ALGORITHM__
+
+#include "_common.hpp"
+#include "_simd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace mstl {
+
+// 适用于 vector/small_vector/array 等连续容器的查找函数：
+// 元素是整数、枚举、指针或 float/double 且 value 类型与元素类型相同时，
+// 走 _simd.hpp 中的向量化内核，否则退回 std::find / std::count
+
+template <class _Container, class _Tp>
+inline constexpr bool __is_simd_search_v =
+    std::is_pointer_v<decltype(std::declval<_Container &>().begin())> &&
+    std::is_same_v<std::remove_cv_t<_Tp>,
+                   typename std::remove_cv_t<_Container>::value_type> &&
+    __is_simd_comparable_v<std::remove_cv_t<_Tp>>;
+
+template <class _Container, class _Tp>
+auto find(_Container &__c, _Tp const &__value) noexcept {
+    if constexpr (__is_simd_search_v<_Container, _Tp>) {
+        auto __first = __c.begin();
+        return __first + mstl::__simd_find<std::remove_cv_t<_Tp>>(
+                             __first, __c.end() - __first, __value);
+    } else {
+        return std::find(__c.begin(), __c.end(), __value);
+    }
+}
+
+template <class _Container, class _Tp>
+std::size_t count(_Container const &__c, _Tp const &__value) noexcept {
+    if constexpr (__is_simd_search_v<_Container const, _Tp>) {
+        auto __first = __c.begin();
+        return mstl::__simd_count<std::remove_cv_t<_Tp>>(
+            __first, __c.end() - __first, __value);
+    } else {
+        return std::count(__c.begin(), __c.end(), __value);
+    }
+}
+
+template <class _Container, class _Tp>
+bool contains(_Container const &__c, _Tp const &__value) noexcept {
+    return mstl::find(__c, __value) != __c.end();
+}
+
+} // namespace mstl
+
+#endif // !__ALGORITHM__
@@ -0,0 +1,65 @@
+#include "algorithm.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+template <typename F> static double measure(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+template <typename T> static void run(const char *name) {
+    constexpr std::size_t n = 1 << 20;
+    constexpr int rounds = 200;
+    mstl::vector<T> a(n), b(n);
+    for (std::size_t i = 0; i < n; i++) {
+        a[i] = b[i] = T(i % 1000);
+    }
+    b[n - 1] = T(-1);
+    T needle = T(-1);
+    a[n - 1] = needle;
+
+    std::size_t sink = 0;
+    double t_cmp_std = measure([&] {
+        for (int r = 0; r < rounds; r++)
+            sink += std::lexicographical_compare_three_way(
+                        a.begin(), a.end(), b.begin(), b.end()) < 0;
+    });
+    double t_cmp = measure([&] {
+        for (int r = 0; r < rounds; r++)
+            sink += (a <=> b) < 0;
+    });
+    double t_find_std = measure([&] {
+        for (int r = 0; r < rounds; r++)
+            sink += std::find(a.begin(), a.end(), needle) - a.begin();
+    });
+    double t_find = measure([&] {
+        for (int r = 0; r < rounds; r++)
+            sink += mstl::find(a, needle) - a.begin();
+    });
+    double t_count_std = measure([&] {
+        for (int r = 0; r < rounds; r++)
+            sink += std::count(a.begin(), a.end(), T(7));
+    });
+    double t_count = measure([&] {
+        for (int r = 0; r < rounds; r++)
+            sink += mstl::count(a, T(7));
+    });
+    printf("%-7s <=> %7.2f / %7.2f ms  find %7.2f / %7.2f ms  "
+           "count %7.2f / %7.2f ms  (std / mstl, sink=%zd)\n",
+           name, t_cmp_std, t_cmp, t_find_std, t_find, t_count_std, t_count,
+           sink);
+}
+
+int main() {
+    run<signed char>("int8");
+    run<short>("int16");
+    run<int>("int32");
+    run<long>("int64");
+    run<float>("float");
+    run<double>("double");
+}
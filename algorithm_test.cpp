@@ -0,0 +1,39 @@
+#include "algorithm.hpp"
+#include "array.hpp"
+#include "vector.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+int main() {
+    mstl::vector<int> keys;
+    for (int i = 0; i < 100; i++) {
+        keys.push_back(i % 37);
+    }
+    printf("find(36) at %zd\n", mstl::find(keys, 36) - keys.begin()); // 36
+    printf("count(5) = %zd\n", mstl::count(keys, 5));                 // 3
+    printf("contains(37) = %d\n", mstl::contains(keys, 37));           // 0
+
+    mstl::vector<int> copy = keys;
+    printf("keys == copy: %d\n", keys == copy); // 1
+    copy[70] = -1;
+    printf("keys == copy: %d\n", keys == copy);     // 0
+    printf("keys > copy: %d\n", keys > copy);       // 1
+    copy.pop_back();
+    printf("copy < keys: %d\n", copy < keys); // 1
+
+    mstl::vector<double> xs{0.0, 1.5, NAN, 2.5, -0.0};
+    mstl::vector<double> ys{-0.0, 1.5, NAN, 2.5, 0.0};
+    printf("find(2.5) at %zd\n", mstl::find(xs, 2.5) - xs.begin()); // 3
+    printf("count(0.0) = %zd\n", mstl::count(xs, 0.0));              // 2
+    printf("xs == ys: %d\n", xs == ys);                              // 0 (NaN)
+
+    mstl::array<short, 20> a{};
+    a[17] = 9;
+    printf("array find(9) at %zd\n", mstl::find(a, (short)9) - a.begin()); // 17
+    printf("array count(0) = %zd\n", mstl::count(a, (short)0));           // 19
+
+    mstl::vector<std::string> strs{"a", "b", "a"};
+    printf("strs count(a) = %zd\n", mstl::count(strs, "a")); // 2
+}
@@ -0,0 +1,38 @@
+#ifndef __BTREE_MAP__
+#define __BTREE_MAP__
+
+/*
+
+ -- B 树 map --
+
+ 接口与 map/multi_map 完全相同，只是底层换成 _btree.hpp 的 B 树：元素
+ 数量远大于缓存时查找每层只有一次缺失，遍历基本是顺序访问内存。
+ 代价是插入删除会使所有迭代器和引用失效。
+
+ _NodeBytes 是每个节点的目标大小，默认 256 字节（四个缓存行）。
+
+*/
+
+#include "_btree.hpp"
+#include "map.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace mstl {
+
+template <class _Key, class _Mapped, class _Compare = std::less<_Key>,
+          class _Alloc = std::allocator<std::pair<_Key const, _Mapped>>,
+          std::size_t _NodeBytes = 256>
+using btree_map = map<_Key, _Mapped, _Compare, _Alloc, _BTreeTag<_NodeBytes>>;
+
+template <class _Key, class _Mapped, class _Compare = std::less<_Key>,
+          class _Alloc = std::allocator<std::pair<_Key const, _Mapped>>,
+          std::size_t _NodeBytes = 256>
+using btree_multi_map =
+    multi_map<_Key, _Mapped, _Compare, _Alloc, _BTreeTag<_NodeBytes>>;
+
+} // namespace mstl
+
+#endif // !__BTREE_MAP__
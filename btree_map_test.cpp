@@ -0,0 +1,83 @@
+#include "btree_map.hpp"
+#include <cstdio>
+#include <string>
+
+// 记录拷贝次数的键，移动不抛异常
+struct counted_key {
+    static inline int copies = 0;
+    int value;
+
+    counted_key(int v) : value(v) {}
+    counted_key(counted_key const &that) : value(that.value) { ++copies; }
+    counted_key(counted_key &&that) noexcept : value(that.value) {}
+
+    bool operator<(counted_key const &that) const {
+        return value < that.value;
+    }
+};
+
+int main() {
+    // 接口与 mstl::map 相同，只是底层换成 B 树
+    mstl::btree_map<std::string, int, std::less<>> table;
+    table["delay"] = 12;
+    table["timeout"] = 42;
+    table.emplace("retries", 3);
+    for (auto const &kv : table) {
+        printf("%s=%d\n", kv.first.c_str(), kv.second);
+    }
+    printf("find(\"timeout\") = %d, contains(\"x\") = %d\n",
+           table.find("timeout")->second, table.contains("x"));
+
+    // 元素较多时分裂成多层，按顺序遍历和区间查找都不变
+    mstl::btree_map<int, int> squares;
+    for (int i = 1000; i > 0; i--) {
+        squares.emplace(i, i * i);
+    }
+    for (int i = 1; i <= 1000; i += 2) {
+        squares.erase(i);
+    }
+    for (auto it = squares.find(100); it != squares.end() && it->first < 112;
+         ++it) {
+        printf("%d->%d ", it->first, it->second);
+    }
+    printf("\nsize = %zd, min = %d, max = %d\n", squares.size(),
+           squares.begin()->first, squares.rbegin()->first);
+
+    // 节点句柄：元素在两张表之间转移，不重新构造
+    mstl::btree_map<std::string, int, std::less<>> archive;
+    auto nh = table.extract("delay");
+    nh.mapped() += 100;
+    auto [it, inserted] = archive.insert(std::move(nh));
+    printf("moved %s=%d (%d), table size = %zd\n", it->first.c_str(),
+           it->second, inserted, table.size());
+
+    mstl::btree_multi_map<int, std::string> events;
+    events.emplace(2, "b");
+    events.emplace(1, "a");
+    events.emplace(2, "c");
+    printf("count(2) = %zd\n", events.count(2));
+    std::size_t erased = events.erase(2);
+    printf("erase(2) = %zd, size = %zd\n", erased, events.size());
+
+    // 每个节点的字节数可以调整
+    mstl::btree_map<long, long, std::less<long>,
+                    std::allocator<std::pair<long const, long>>, 512>
+        wide;
+    for (long i = 0; i < 100; i++) {
+        wide.emplace_hint(wide.end(), i, -i);
+    }
+    printf("wide[42] = %ld\n", wide.at(42));
+
+    // 删除时元素在节点内和节点间挪动，const 的键也是移动而不是拷贝
+    mstl::btree_map<counted_key, int> keyed;
+    for (int i = 0; i < 1000; i++) {
+        keyed.emplace(i, i);
+    }
+    counted_key::copies = 0;
+    for (int i = 0; i < 1000; i += 3) {
+        keyed.erase(i);
+    }
+    printf("size = %zd, key copies while erasing = %d\n", keyed.size(),
+           counted_key::copies); // 666, 0
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef __BTREE_SET__
+#define __BTREE_SET__
+
+/*
+
+ -- B 树 set --
+
+ 接口与 set/multi_set 完全相同，底层换成 _btree.hpp 的 B 树，
+ 插入删除会使所有迭代器和引用失效。
+
+*/
+
+#include "_btree.hpp"
+#include "set.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace mstl {
+
+template <class _Tp, class _Compare = std::less<_Tp>,
+          class _Alloc = std::allocator<_Tp>, std::size_t _NodeBytes = 256>
+using btree_set = set<_Tp, _Compare, _Alloc, _BTreeTag<_NodeBytes>>;
+
+template <class _Tp, class _Compare = std::less<_Tp>,
+          class _Alloc = std::allocator<_Tp>, std::size_t _NodeBytes = 256>
+using btree_multi_set = multi_set<_Tp, _Compare, _Alloc, _BTreeTag<_NodeBytes>>;
+
+} // namespace mstl
+
+#endif // !__BTREE_SET__
@@ -0,0 +1,36 @@
+#include "btree_set.hpp"
+#include <cstdio>
+#include <iterator>
+
+int main() {
+    mstl::btree_set<int> s;
+    for (int i = 0; i < 200; i++) {
+        s.insert((i * 37) % 200);
+    }
+    printf("size = %zd, min = %d, max = %d\n", s.size(), *s.begin(),
+           *s.rbegin());
+    s.erase(s.find(100));
+    printf("find(100) = %d, lower_bound(100) = %d\n", s.find(100) != s.end(),
+           *s.lower_bound(100));
+    for (auto it = s.rbegin(); it != s.rend() && *it > 190; ++it) {
+        printf("%d ", *it);
+    }
+    printf("\n");
+
+    int sorted[] = {1, 1, 2, 3, 3, 3, 8};
+    mstl::btree_multi_set<int> bulk(mstl::sorted_equivalent, sorted,
+                                    sorted + 7);
+    printf("bulk count(3) = %zd, size = %zd\n", bulk.count(3), bulk.size());
+    // 提示在插入值之前时，插在等价区间的最前面
+    auto pos = bulk.insert(std::next(bulk.begin(), 2), 3);
+    printf("hinted insert at %td\n", std::distance(bulk.begin(), pos));
+    mstl::btree_multi_set<int> moved;
+    moved.insert(bulk.extract(bulk.find(3)));
+    moved.insert(bulk.extract(bulk.find(8)));
+    printf("bulk size = %zd, moved:", bulk.size());
+    for (int i : moved) {
+        printf(" %d", i);
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,175 @@
+#ifndef __INTERVAL_MAP__
+#define __INTERVAL_MAP__
+
+/*
+
+ -- 区间 map --
+
+ 键是半开区间 [lo, hi)，按 (lo, hi) 排序，允许重叠和重复。每个节点额外
+ 记录子树中最大的右端点，查询与某个区间相交的元素时整棵不可能相交的
+ 子树直接跳过：
+
+ - find_overlap(lo, hi) 找按顺序第一个相交的区间，O(log n)；
+ - for_each_overlap(lo, hi, f) 依次访问所有相交的区间，O(k log n)，
+   k 为相交的个数，通常接近 O(log n + k)。
+
+ 右端点存放在节点里，_Key 必须是平凡类型（时间戳、整数偏移等），
+ 比较器必须可以默认构造。
+
+*/
+
+#include "map.hpp"
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace mstl {
+
+template <class _Key, class _Compare> struct _IntervalLess {
+    [[no_unique_address]] _Compare _M_comp;
+
+    bool operator()(std::pair<_Key, _Key> const &__lhs,
+                    std::pair<_Key, _Key> const &__rhs) const noexcept {
+        if (this->_M_comp(__lhs.first, __rhs.first)) {
+            return true;
+        }
+        if (this->_M_comp(__rhs.first, __lhs.first)) {
+            return false;
+        }
+        return this->_M_comp(__lhs.second, __rhs.second);
+    }
+};
+
+// 节点记录子树中最大的右端点
+template <class _Key, class _Compare> struct _IntervalMapPolicy {
+    using data_type = _Key;
+
+    template <class _Node> static void update(_Node &__node) noexcept {
+        _Compare __comp;
+        _Key __max = __node.value().first.second;
+        if (__node.left() != nullptr &&
+            __comp(__max, __node.left()->data())) {
+            __max = __node.left()->data();
+        }
+        if (__node.right() != nullptr &&
+            __comp(__max, __node.right()->data())) {
+            __max = __node.right()->data();
+        }
+        __node.data() = __max;
+    }
+};
+
+template <class _Key, class _Mapped, class _Compare = std::less<_Key>,
+          class _Alloc =
+              std::allocator<std::pair<std::pair<_Key, _Key> const, _Mapped>>>
+struct interval_map
+    : augmented_multi_map<std::pair<_Key, _Key>, _Mapped,
+                          _IntervalMapPolicy<_Key, _Compare>,
+                          _IntervalLess<_Key, _Compare>, _Alloc> {
+  private:
+    using _Impl = augmented_multi_map<std::pair<_Key, _Key>, _Mapped,
+                                      _IntervalMapPolicy<_Key, _Compare>,
+                                      _IntervalLess<_Key, _Compare>, _Alloc>;
+    using _Node = _RbTreeDataNode<typename _Impl::value_type, _Key>;
+
+  public:
+    using interval_type = std::pair<_Key, _Key>;
+    using typename _Impl::const_iterator;
+    using typename _Impl::iterator;
+    using typename _Impl::value_type;
+
+    interval_map() = default;
+
+    interval_map(std::initializer_list<value_type> __ilist)
+        : _Impl(__ilist) {}
+
+    interval_map(interval_map &&) = default;
+    interval_map &operator=(interval_map &&) = default;
+    interval_map(interval_map const &) = default;
+    interval_map &operator=(interval_map const &) = default;
+
+    // 按 (lo, hi) 顺序第一个与 [__lo, __hi) 相交的区间，没有时返回 end()
+    iterator find_overlap(_Key const &__lo, _Key const &__hi) noexcept {
+        return this->_M_prevent_end(this->_M_find_overlap(__lo, __hi));
+    }
+
+    const_iterator find_overlap(_Key const &__lo,
+                                _Key const &__hi) const noexcept {
+        return this->_M_prevent_end(this->_M_find_overlap(__lo, __hi));
+    }
+
+    // 按顺序对每个与 [__lo, __hi) 相交的元素调用 __f(value_type &)
+    template <class _Fn>
+    void for_each_overlap(_Key const &__lo, _Key const &__hi, _Fn &&__f) {
+        auto __visit = [&__f](_Node const *__node) {
+            __f(const_cast<value_type &>(__node->value()));
+        };
+        this->_M_for_each_overlap(this->root_node(), __lo, __hi, __visit);
+    }
+
+    template <class _Fn>
+    void for_each_overlap(_Key const &__lo, _Key const &__hi,
+                          _Fn &&__f) const {
+        auto __visit = [&__f](_Node const *__node) { __f(__node->value()); };
+        this->_M_for_each_overlap(this->root_node(), __lo, __hi, __visit);
+    }
+
+  private:
+    bool _M_overlaps(_Node const *__node, _Key const &__lo,
+                     _Key const &__hi) const noexcept {
+        interval_type const &__range = __node->value().first;
+        return this->_M_comp_key(__range.first, __hi) &&
+               this->_M_comp_key(__lo, __range.second);
+    }
+
+    bool _M_comp_key(_Key const &__lhs, _Key const &__rhs) const noexcept {
+        return _Compare()(__lhs, __rhs);
+    }
+
+    // 左子树的最大右端点超过 __lo 时，要么相交的区间就在左子树里，
+    // 要么左子树那个区间的左端点已经 >= __hi，右边更不会相交
+    _RbTreeNode *_M_find_overlap(_Key const &__lo,
+                                 _Key const &__hi) const noexcept {
+        _Node const *__node = this->root_node();
+        while (__node != nullptr) {
+            if (__node->left() != nullptr &&
+                this->_M_comp_key(__lo, __node->left()->data())) {
+                __node = __node->left();
+                continue;
+            }
+            if (this->_M_overlaps(__node, __lo, __hi)) {
+                return const_cast<_Node *>(__node);
+            }
+            if (!this->_M_comp_key(__node->value().first.first, __hi)) {
+                return nullptr;
+            }
+            __node = __node->right();
+        }
+        return nullptr;
+    }
+
+    template <class _Visit>
+    void _M_for_each_overlap(_Node const *__node, _Key const &__lo,
+                             _Key const &__hi, _Visit &__visit) const {
+        // 子树中最大的右端点都不超过 __lo，整棵跳过
+        if (__node == nullptr || !this->_M_comp_key(__lo, __node->data())) {
+            return;
+        }
+        this->_M_for_each_overlap(__node->left(), __lo, __hi, __visit);
+        // 左端点 >= __hi，它和右子树都不会相交
+        if (!this->_M_comp_key(__node->value().first.first, __hi)) {
+            return;
+        }
+        if (this->_M_comp_key(__lo, __node->value().first.second)) {
+            __visit(__node);
+        }
+        this->_M_for_each_overlap(__node->right(), __lo, __hi, __visit);
+    }
+};
+
+} // namespace mstl
+
+#endif // !__INTERVAL_MAP__
@@ -0,0 +1,31 @@
+#include "interval_map.hpp"
+#include <cstdio>
+#include <string>
+
+int main() {
+    // 会议室预订，区间为 [开始, 结束) 的分钟数
+    mstl::interval_map<int, std::string> bookings;
+    bookings.emplace(std::make_pair(540, 600), "standup");
+    bookings.emplace(std::make_pair(570, 660), "design review");
+    bookings.emplace(std::make_pair(720, 780), "lunch");
+    bookings.emplace(std::make_pair(600, 615), "1:1");
+
+    auto it = bookings.find_overlap(600, 610);
+    printf("first overlap with [600, 610): %s\n",
+           it != bookings.end() ? it->second.c_str() : "none");
+    it = bookings.find_overlap(660, 720);
+    printf("first overlap with [660, 720): %s\n",
+           it != bookings.end() ? it->second.c_str() : "none");
+
+    printf("overlaps with [590, 730):");
+    bookings.for_each_overlap(590, 730, [](auto const &entry) {
+        printf(" %s[%d, %d)", entry.second.c_str(), entry.first.first,
+               entry.first.second);
+    });
+    printf("\n");
+
+    bookings.erase(bookings.find(std::make_pair(570, 660)));
+    printf("after cancelling the review, [620, 700) is %s\n",
+           bookings.find_overlap(620, 700) == bookings.end() ? "free"
+                                                              : "taken");
+}
@@ -7,6 +7,8 @@
 #include <functional>
 #include <memory>
 #include <stdexcept>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace mstl {
@@ -46,12 +48,15 @@ struct _RbTreeValueCompare<
     _RbTreeValueCompare(_Compare __comp = _Compare()) noexcept
         : _M_comp(__comp) {}
 
+    // 两边都是 _Value 时走下面的非模板重载，否则非 const 的值会有歧义
     template <class _Lhs>
+        requires(!std::is_same_v<std::remove_cvref_t<_Lhs>, _Value>)
     bool operator()(_Lhs &&__lhs, _Value const &__rhs) const noexcept {
         return this->_M_comp(__lhs, __rhs.first);
     }
 
     template <class _Rhs>
+        requires(!std::is_same_v<std::remove_cvref_t<_Rhs>, _Value>)
     bool operator()(_Value const &__lhs, _Rhs &&__rhs) const noexcept {
         return this->_M_comp(__lhs.first, __rhs);
     }
@@ -61,14 +66,55 @@ struct _RbTreeValueCompare<
     }
 
     using is_transparent = typename _Compare::is_transparent;
+
+    struct _RbTreeIsMap;
+};
+
+// emplace 的参数里能否不构造值就拿到键：(key, mapped)、pair<key, ...>
+// 以及 piecewise_construct 且键元组只有一个键。能拿到时先查找再分配
+template <class _Key, class... _Args> struct _RbTreeEmplaceKey {
+    static constexpr bool value = false;
+};
+
+template <class _Key, class _Kv, class _Mv>
+struct _RbTreeEmplaceKey<_Key, _Kv, _Mv> {
+    static constexpr bool value = std::is_same_v<_Kv, _Key>;
+
+    static _Kv const &_S_key(_Kv const &__key, _Mv const &) noexcept {
+        return __key;
+    }
+};
+
+template <class _Key, class _Kv, class _Mv>
+struct _RbTreeEmplaceKey<_Key, std::pair<_Kv, _Mv>> {
+    static constexpr bool value = std::is_same_v<std::remove_cv_t<_Kv>, _Key>;
+
+    static _Kv const &_S_key(std::pair<_Kv, _Mv> const &__pair) noexcept {
+        return __pair.first;
+    }
+};
+
+template <class _Key, class _Kv, class _Mt>
+struct _RbTreeEmplaceKey<_Key, std::piecewise_construct_t, std::tuple<_Kv>,
+                         _Mt> {
+    static constexpr bool value =
+        std::is_same_v<std::remove_cvref_t<_Kv>, _Key>;
+
+    static auto const &_S_key(std::piecewise_construct_t,
+                              std::tuple<_Kv> const &__key,
+                              _Mt const &) noexcept {
+        return std::get<0>(__key);
+    }
 };
 
 template <class _Key, class _Mapped, class _Compare = std::less<_Key>,
-          class _Alloc = std::allocator<std::pair<_Key const, _Mapped>>>
+          class _Alloc = std::allocator<std::pair<_Key const, _Mapped>>,
+          class _TreeTag = _RbTreeNoAugment>
 struct map
-    : _RbTreeImpl<std::pair<_Key const, _Mapped>,
-                  _RbTreeValueCompare<_Compare, std::pair<_Key const, _Mapped>>,
-                  _Alloc> {
+    : _TreeImplSelect<
+          std::pair<_Key const, _Mapped>,
+          _RbTreeValueCompare<_Compare, std::pair<_Key const, _Mapped>>,
+          _Alloc, _TreeTag>::type {
     using key_type = _Key;
     using mapped_type = _Mapped;
     using value_type = std::pair<_Key const, _Mapped>;
@@ -77,52 +123,57 @@ struct map
 
   private:
     using _ValueComp = _RbTreeValueCompare<_Compare, value_type>;
+    using _Impl = typename _TreeImplSelect<value_type, _ValueComp, _Alloc,
+                                           _TreeTag>::type;
 
   public:
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::iterator;
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::const_iterator;
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::node_type;
+    using typename _Impl::iterator;
+    using typename _Impl::const_iterator;
+    using typename _Impl::node_type;
+    // 连续查找相近的键时用游标，见 _TreeCursor
+    using cursor = _TreeCursor<_Impl, iterator, _Key>;
+    using const_cursor = _TreeCursor<_Impl const, const_iterator, _Key>;
 
     map() = default;
 
-    explicit map(_Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {}
+    explicit map(_Compare __comp) : _Impl(__comp) {}
 
     map(std::initializer_list<value_type> __ilist) {
-        _M_single_insert(__ilist.begin(), __ilist.end());
+        this->_M_single_insert(__ilist.begin(), __ilist.end());
     }
 
     explicit map(std::initializer_list<value_type> __ilist, _Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {
-        _M_single_insert(__ilist.begin(), __ilist.end());
+        : _Impl(__comp) {
+        this->_M_single_insert(__ilist.begin(), __ilist.end());
     }
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     explicit map(_InputIt __first, _InputIt __last) {
-        _M_single_insert(__first, __last);
+        this->_M_single_insert(__first, __last);
     }
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     explicit map(_InputIt __first, _InputIt __last, _Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {
-        _M_single_insert(__first, __last);
+        : _Impl(__comp) {
+        this->_M_single_insert(__first, __last);
+    }
+
+    // 区间按键严格递增，线性时间建树
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    map(sorted_unique_t, _InputIt __first, _InputIt __last,
+        _Compare __comp = _Compare())
+        : _Impl(__comp) {
+        this->_M_single_insert(__first, __last, true);
     }
 
     map(map &&) = default;
     map &operator=(map &&) = default;
 
-    map(map const &__that) : _RbTreeImpl<value_type, _ValueComp, _Alloc>() {
-        this->_M_single_insert(__that.begin(), __that.end());
-    }
-
-    map &operator=(map const &__that) {
-        if (&__that != this) {
-            this->assign(__that.begin(), __that.end());
-        }
-        return *this;
-    }
+    map(map const &) = default;
+    map &operator=(map const &) = default;
 
     map &operator=(std::initializer_list<value_type> __ilist) {
         this->assign(__ilist);
@@ -156,6 +207,37 @@ struct map
         return this->_M_find(__key);
     }
 
+    // 以 __finger 为起点查找，见 _RbTreeImpl::_M_finger_bound
+    iterator find(const_iterator __finger, _Key const &__key) noexcept {
+        return this->_M_finger_find(__finger, __key);
+    }
+
+    const_iterator find(const_iterator __finger,
+                        _Key const &__key) const noexcept {
+        return this->_M_finger_find(__finger, __key);
+    }
+
+    using _Impl::lower_bound;
+    using _Impl::upper_bound;
+
+    iterator lower_bound(const_iterator __finger, _Key const &__key) noexcept {
+        return this->template _M_finger_bound<false>(__finger, __key);
+    }
+
+    const_iterator lower_bound(const_iterator __finger,
+                               _Key const &__key) const noexcept {
+        return this->template _M_finger_bound<false>(__finger, __key);
+    }
+
+    iterator upper_bound(const_iterator __finger, _Key const &__key) noexcept {
+        return this->template _M_finger_bound<true>(__finger, __key);
+    }
+
+    const_iterator upper_bound(const_iterator __finger,
+                               _Key const &__key) const noexcept {
+        return this->template _M_finger_bound<true>(__finger, __key);
+    }
+
     std::pair<iterator, bool> insert(value_type &&__value) {
         return this->_M_single_emplace(std::move(__value));
     }
@@ -203,34 +285,26 @@ struct map
     template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(
                              _ValueComp, _Kv, value_type)>
     _Mapped &operator[](_Kv const &__key) {
-        iterator __it = this->_M_find(__key);
-        if (__it == this->end()) {
-            __it = this->_M_single_emplace(std::piecewise_construct,
-                                           std::forward_as_tuple(__key),
-                                           std::forward_as_tuple())
-                       .first;
-        }
-        return __it->second;
+        return this
+            ->_M_single_emplace_key(__key, std::piecewise_construct,
+                                    std::forward_as_tuple(__key),
+                                    std::forward_as_tuple())
+            .first->second;
     }
 
     _Mapped &operator[](_Key const &__key) {
-        iterator __it = this->_M_find(__key);
-        if (__it == this->end()) {
-            __it = this->_M_single_emplace(std::piecewise_construct,
-                                           std::forward_as_tuple(__key),
-                                           std::forward_as_tuple())
-                       .first;
-        }
-        return __it->second;
+        return this->try_emplace(__key).first->second;
+    }
+
+    _Mapped &operator[](_Key &&__key) {
+        return this->try_emplace(std::move(__key)).first->second;
     }
 
     template <class _Mp,
               class = std::enable_if_t<std::is_convertible_v<_Mp, _Mapped>>>
     std::pair<iterator, bool> insert_or_assign(_Key const &__key,
                                                _Mp &&__mapped) {
-        std::pair<iterator, bool> __result = this->_M_single_emplace(
-            std::piecewise_construct, std::forward_as_tuple(__key),
-            std::forward_as_tuple(std::forward<_Mp>(__mapped)));
+        auto __result = this->try_emplace(__key, std::forward<_Mp>(__mapped));
         if (!__result.second) {
             __result.first->second = std::forward<_Mp>(__mapped);
         }
@@ -240,9 +314,8 @@ struct map
     template <class _Mp,
               class = std::enable_if_t<std::is_convertible_v<_Mp, _Mapped>>>
     std::pair<iterator, bool> insert_or_assign(_Key &&__key, _Mp &&__mapped) {
-        std::pair<iterator, bool> __result = this->_M_single_emplace(
-            std::piecewise_construct, std::forward_as_tuple(std::move(__key)),
-            std::forward_as_tuple(std::forward<_Mp>(__mapped)));
+        auto __result =
+            this->try_emplace(std::move(__key), std::forward<_Mp>(__mapped));
         if (!__result.second) {
             __result.first->second = std::forward<_Mp>(__mapped);
         }
@@ -250,40 +323,69 @@ struct map
     }
 
     template <class... Vs> std::pair<iterator, bool> emplace(Vs &&...__value) {
-        return this->_M_single_emplace(std::forward<Vs>(__value)...);
+        using _EmplaceKey = _RbTreeEmplaceKey<_Key, std::remove_cvref_t<Vs>...>;
+        if constexpr (_EmplaceKey::value) {
+            return this->_M_single_emplace_key(_EmplaceKey::_S_key(__value...),
+                                               std::forward<Vs>(__value)...);
+        } else {
+            return this->_M_single_emplace(std::forward<Vs>(__value)...);
+        }
+    }
+
+    // 新键紧挨着 __hint 时不必从根查找，按递增顺序追加时传 end() 即可
+    template <class... _Ts>
+    iterator emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        return this->_M_single_emplace_hint(__hint,
+                                            std::forward<_Ts>(__value)...);
+    }
+
+    iterator insert(const_iterator __hint, value_type &&__value) {
+        return this->_M_single_emplace_hint(__hint, std::move(__value));
+    }
+
+    iterator insert(const_iterator __hint, value_type const &__value) {
+        return this->_M_single_emplace_hint(__hint, __value);
     }
 
+    // 先按键查找，键已存在时不会分配节点、构造 mapped，参数也不会被移走
     template <class... _Ms>
     std::pair<iterator, bool> try_emplace(_Key &&__key, _Ms &&...__mapped) {
-        return this->_M_single_emplace(
-            std::piecewise_construct, std::forward_as_tuple(std::move(__key)),
+        return this->_M_single_emplace_key(
+            __key, std::piecewise_construct,
+            std::forward_as_tuple(std::move(__key)),
             std::forward_as_tuple(std::forward<_Ms>(__mapped)...));
     }
 
     template <class... _Ms>
     std::pair<iterator, bool> try_emplace(_Key const &__key,
                                           _Ms &&...__mapped) {
-        return this->_M_single_emplace(
-            std::piecewise_construct, std::forward_as_tuple(__key),
+        return this->_M_single_emplace_key(
+            __key, std::piecewise_construct, std::forward_as_tuple(__key),
             std::forward_as_tuple(std::forward<_Ms>(__mapped)...));
     }
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
-    iterator insert(_InputIt __first, _InputIt __last) {
-        return this->_M_single_insert(__first, __last);
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_single_insert(__first, __last);
     }
 
-    using _RbTreeImpl<value_type, _ValueComp, _Alloc>::assign;
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(sorted_unique_t, _InputIt __first, _InputIt __last) {
+        this->_M_single_insert(__first, __last, true);
+    }
+
+    using _Impl::assign;
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
-    iterator assign(_InputIt __first, _InputIt __last) {
+    void assign(_InputIt __first, _InputIt __last) {
         this->clear();
-        return this->_M_single_insert(__first, __last);
+        this->_M_single_insert(__first, __last);
     }
 
-    using _RbTreeImpl<value_type, _ValueComp, _Alloc>::erase;
+    using _Impl::erase;
 
     template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(
                              _ValueComp, _Kv, value_type)>
@@ -313,6 +415,35 @@ struct map
         return this->_M_contains(__value);
     }
 
+    // 依次把每个键的 find 结果写入 __out，见 _RbTreeBase::_M_find_nodes
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) {
+        return this->_M_find_many(__first, __last, __out);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) const {
+        return this->_M_find_many(__first, __last, __out);
+    }
+
+    // 同 find_many，写入的是 contains 的结果
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt contains_many(_KeyIt __first, _KeyIt __last, _OutIt __out) const {
+        return this->_M_contains_many(__first, __last, __out);
+    }
+
+    std::pair<iterator, bool> insert(node_type __nh) {
+        return _Impl::insert(std::move(__nh));
+    }
+
+    using _Impl::extract;
+
     template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(
                              _ValueComp, _Kv, value_type)>
     node_type extract(_Kv &&__key) {
@@ -324,14 +455,56 @@ struct map
         iterator __it = this->_M_find(__key);
         return __it != this->end() ? this->extract(__it) : node_type();
     }
+
+    // 以下集合运算把 __that 的节点直接挪过来或释放，不重新分配，结束后
+    // __that 为空。等价元素保留原有的
+    void set_union(map &&__that) { this->_M_set_union(__that); }
+
+    // 只保留在 __that 中也有的元素
+    void set_intersection(map &&__that) { this->_M_set_intersection(__that); }
+
+    // 去掉在 __that 中也有的元素
+    void set_difference(map &&__that) { this->_M_set_difference(__that); }
+
+    // 同 std::map::merge：键已存在的元素留在 __that 里
+    void merge(map &__that) { this->template _M_merge<true>(__that); }
+
+    void merge(map &&__that) { this->template _M_merge<true>(__that); }
+
+    // 以下并行操作的约束见 _RbTreeImpl::_S_fork_height
+
+    // 与 insert(__first, __last) 结果相同：已有的键不覆盖，区间内重复的
+    // 键保留先出现的
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(
+        std::random_access_iterator, _RandIt)>
+    void insert_bulk(_RandIt __first, _RandIt __last) {
+        this->template _M_parallel_insert<true>(__first, __last);
+    }
+
+    // 结果同 set_union
+    void union_with(map &&__that) {
+        this->_M_parallel_set_union(__that);
+    }
+
+    // 对每个元素调用 __f(value_type &)，不保证顺序
+    template <class _Fn> void for_each_parallel(_Fn &&__f) {
+        this->_M_parallel_for_each(__f);
+    }
+
+    template <class _Fn> void for_each_parallel(_Fn &&__f) const {
+        auto __visit = [&__f](value_type const &__value) { __f(__value); };
+        this->_M_parallel_for_each(__visit);
+    }
 };
 
 template <class _Key, class _Mapped, class _Compare = std::less<_Key>,
-          class _Alloc = std::allocator<std::pair<_Key const, _Mapped>>>
+          class _Alloc = std::allocator<std::pair<_Key const, _Mapped>>,
+          class _TreeTag = _RbTreeNoAugment>
 struct multi_map
-    : _RbTreeImpl<std::pair<_Key const, _Mapped>,
-                  _RbTreeValueCompare<_Compare, std::pair<_Key const, _Mapped>>,
-                  _Alloc> {
+    : _TreeImplSelect<
+          std::pair<_Key const, _Mapped>,
+          _RbTreeValueCompare<_Compare, std::pair<_Key const, _Mapped>>,
+          _Alloc, _TreeTag>::type {
     using key_type = _Key;
     using mapped_type = _Mapped;
     using value_type = std::pair<_Key const, _Mapped>;
@@ -340,54 +513,58 @@ struct multi_map
 
   private:
     using _ValueComp = _RbTreeValueCompare<_Compare, value_type>;
+    using _Impl = typename _TreeImplSelect<value_type, _ValueComp, _Alloc,
+                                           _TreeTag>::type;
 
   public:
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::iterator;
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::const_iterator;
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::node_type;
+    using typename _Impl::iterator;
+    using typename _Impl::const_iterator;
+    using typename _Impl::node_type;
+    // 连续查找相近的键时用游标，见 _TreeCursor
+    using cursor = _TreeCursor<_Impl, iterator, _Key>;
+    using const_cursor = _TreeCursor<_Impl const, const_iterator, _Key>;
 
     multi_map() = default;
 
-    explicit multi_map(_Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {}
+    explicit multi_map(_Compare __comp) : _Impl(__comp) {}
 
     multi_map(std::initializer_list<value_type> __ilist) {
-        _M_multi_insert(__ilist.begin(), __ilist.end());
+        this->_M_multi_insert(__ilist.begin(), __ilist.end());
     }
 
     explicit multi_map(std::initializer_list<value_type> __ilist,
                        _Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {
-        _M_multi_insert(__ilist.begin(), __ilist.end());
+        : _Impl(__comp) {
+        this->_M_multi_insert(__ilist.begin(), __ilist.end());
     }
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     explicit multi_map(_InputIt __first, _InputIt __last) {
-        _M_multi_insert(__first, __last);
+        this->_M_multi_insert(__first, __last);
     }
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     explicit multi_map(_InputIt __first, _InputIt __last, _Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {
-        _M_multi_insert(__first, __last);
+        : _Impl(__comp) {
+        this->_M_multi_insert(__first, __last);
+    }
+
+    // 区间按键非递减，线性时间建树
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    multi_map(sorted_equivalent_t, _InputIt __first, _InputIt __last,
+              _Compare __comp = _Compare())
+        : _Impl(__comp) {
+        this->_M_multi_insert(__first, __last, true);
     }
 
     multi_map(multi_map &&) = default;
     multi_map &operator=(multi_map &&) = default;
 
-    multi_map(multi_map const &__that)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>() {
-        this->_M_multi_insert(__that.begin(), __that.end());
-    }
-
-    multi_map &operator=(multi_map const &__that) {
-        if (&__that != this) {
-            this->assign(__that.begin(), __that.end());
-        }
-        return *this;
-    }
+    multi_map(multi_map const &) = default;
+    multi_map &operator=(multi_map const &) = default;
 
     multi_map &operator=(std::initializer_list<value_type> __ilist) {
         this->assign(__ilist);
@@ -421,17 +598,62 @@ struct multi_map
         return this->_M_find(__key);
     }
 
-    std::pair<iterator, bool> insert(value_type &&__value) {
-        return this->_M_single_emplace(std::move(__value));
+    // 以 __finger 为起点查找，见 _RbTreeImpl::_M_finger_bound
+    iterator find(const_iterator __finger, _Key const &__key) noexcept {
+        return this->_M_finger_find(__finger, __key);
     }
 
-    std::pair<iterator, bool> insert(value_type const &__value) {
-        return this->_M_single_emplace(__value);
+    const_iterator find(const_iterator __finger,
+                        _Key const &__key) const noexcept {
+        return this->_M_finger_find(__finger, __key);
     }
 
+    using _Impl::lower_bound;
+    using _Impl::upper_bound;
+
+    iterator lower_bound(const_iterator __finger, _Key const &__key) noexcept {
+        return this->template _M_finger_bound<false>(__finger, __key);
+    }
+
+    const_iterator lower_bound(const_iterator __finger,
+                               _Key const &__key) const noexcept {
+        return this->template _M_finger_bound<false>(__finger, __key);
+    }
+
+    iterator upper_bound(const_iterator __finger, _Key const &__key) noexcept {
+        return this->template _M_finger_bound<true>(__finger, __key);
+    }
+
+    const_iterator upper_bound(const_iterator __finger,
+                               _Key const &__key) const noexcept {
+        return this->template _M_finger_bound<true>(__finger, __key);
+    }
+
+    iterator insert(value_type &&__value) {
+        return this->_M_multi_emplace(std::move(__value));
+    }
+
+    iterator insert(value_type const &__value) {
+        return this->_M_multi_emplace(__value);
+    }
+
+    template <class... _Ts> iterator emplace(_Ts &&...__value) {
+        return this->_M_multi_emplace(std::forward<_Ts>(__value)...);
+    }
+
+    // 等价键插在 __hint 之前尽可能近的位置
     template <class... _Ts>
-    std::pair<iterator, bool> emplace(_Ts &&...__value) {
-        return this->_M_single_emplace(std::forward<_Ts>(__value)...);
+    iterator emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        return this->_M_multi_emplace_hint(__hint,
+                                           std::forward<_Ts>(__value)...);
+    }
+
+    iterator insert(const_iterator __hint, value_type &&__value) {
+        return this->_M_multi_emplace_hint(__hint, std::move(__value));
+    }
+
+    iterator insert(const_iterator __hint, value_type const &__value) {
+        return this->_M_multi_emplace_hint(__hint, __value);
     }
 
     template <class... _Ts>
@@ -450,28 +672,34 @@ struct multi_map
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
-    iterator insert(_InputIt __first, _InputIt __last) {
-        return this->_M_single_insert(__first, __last);
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_multi_insert(__first, __last);
     }
 
-    using _RbTreeImpl<value_type, _ValueComp, _Alloc>::assign;
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(sorted_equivalent_t, _InputIt __first, _InputIt __last) {
+        this->_M_multi_insert(__first, __last, true);
+    }
+
+    using _Impl::assign;
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
-    iterator assign(_InputIt __first, _InputIt __last) {
+    void assign(_InputIt __first, _InputIt __last) {
         this->clear();
-        return this->_M_single_insert(__first, __last);
+        this->_M_multi_insert(__first, __last);
     }
 
-    using _RbTreeImpl<value_type, _ValueComp, _Alloc>::erase;
+    using _Impl::erase;
 
     template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(
                              _ValueComp, _Kv, value_type)>
     size_t erase(_Kv &&__key) {
-        return this->_M_single_erase(__key);
+        return this->_M_multi_erase(__key);
     }
 
-    size_t erase(_Key const &__key) { return this->_M_single_erase(__key); }
+    size_t erase(_Key const &__key) { return this->_M_multi_erase(__key); }
 
     template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(
                              _ValueComp, _Kv, value_type)>
@@ -493,6 +721,35 @@ struct multi_map
         return this->_M_contains(__value);
     }
 
+    // 依次把每个键的 find 结果写入 __out，见 _RbTreeBase::_M_find_nodes
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) {
+        return this->_M_find_many(__first, __last, __out);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) const {
+        return this->_M_find_many(__first, __last, __out);
+    }
+
+    // 同 find_many，写入的是 contains 的结果
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt contains_many(_KeyIt __first, _KeyIt __last, _OutIt __out) const {
+        return this->_M_contains_many(__first, __last, __out);
+    }
+
+    iterator insert(node_type __nh) {
+        return this->_M_multi_insert_handle(std::move(__nh));
+    }
+
+    using _Impl::extract;
+
     template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(
                              _ValueComp, _Kv, value_type)>
     node_type extract(_Kv &&__key) {
@@ -504,7 +761,48 @@ struct multi_map
         iterator __it = this->_M_find(__key);
         return __it != this->end() ? this->extract(__it) : node_type();
     }
+
+    // 把 __that 的节点全部挪过来，不重新分配，等价元素排在原有的之后
+    void merge(multi_map &__that) { this->template _M_merge<false>(__that); }
+
+    void merge(multi_map &&__that) { this->template _M_merge<false>(__that); }
+
+    // 以下并行操作的约束见 _RbTreeImpl::_S_fork_height
+
+    // 与 insert(__first, __last) 结果相同，等价元素排在已有的之后
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(
+        std::random_access_iterator, _RandIt)>
+    void insert_bulk(_RandIt __first, _RandIt __last) {
+        this->template _M_parallel_insert<false>(__first, __last);
+    }
+
+    // 对每个元素调用 __f(value_type &)，不保证顺序
+    template <class _Fn> void for_each_parallel(_Fn &&__f) {
+        this->_M_parallel_for_each(__f);
+    }
+
+    template <class _Fn> void for_each_parallel(_Fn &&__f) const {
+        auto __visit = [&__f](value_type const &__value) { __f(__value); };
+        this->_M_parallel_for_each(__visit);
+    }
 };
+
+// 自定义增强：_Policy 见 _RbTreePolicyAugment，查询从 root_node() 开始；
+// 通过迭代器改了参与计算的 mapped 以后要调用 refresh(it)
+template <class _Key, class _Mapped, class _Policy,
+          class _Compare = std::less<_Key>,
+          class _Alloc = std::allocator<std::pair<_Key const, _Mapped>>>
+using augmented_map =
+    map<_Key, _Mapped, _Compare, _Alloc,
+        _RbTreePolicyAugment<std::pair<_Key const, _Mapped>, _Policy>>;
+
+template <class _Key, class _Mapped, class _Policy,
+          class _Compare = std::less<_Key>,
+          class _Alloc = std::allocator<std::pair<_Key const, _Mapped>>>
+using augmented_multi_map =
+    multi_map<_Key, _Mapped, _Compare, _Alloc,
+              _RbTreePolicyAugment<std::pair<_Key const, _Mapped>, _Policy>>;
+
 } // namespace mstl
 
 #endif // !__MAP__
@@ -0,0 +1,585 @@
+#include "aggregate_map.hpp"
+#include "btree_map.hpp"
+#include "interval_map.hpp"
+#include "map.hpp"
+#include "pool_allocator.hpp"
+#include "set.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <typename F> static double measure(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+template <typename Map> static long checksum(Map const &m) {
+    long sum = 0;
+    for (auto const &kv : m) {
+        sum += kv.second;
+    }
+    return sum;
+}
+
+// 从已排序的快照加载：逐个插入 vs 整段区间构造
+static void bench_bulk_build(std::size_t n) {
+    std::vector<std::pair<long, long>> snapshot;
+    snapshot.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+        snapshot.emplace_back(long(i) * 3, long(i));
+    }
+
+    // 只计建树时间，析构放在计时之外
+    long sink = 0;
+    mstl::map<long, long> m1, m2, m3;
+    std::map<long, long> m4;
+    double t_each = measure([&] {
+        for (auto const &kv : snapshot) {
+            m1.insert(kv);
+        }
+    });
+    double t_range = measure([&] {
+        m2 = mstl::map<long, long>(snapshot.begin(), snapshot.end());
+    });
+    double t_sorted = measure([&] {
+        m3 = mstl::map<long, long>(mstl::sorted_unique, snapshot.begin(),
+                                   snapshot.end());
+    });
+    double t_std = measure([&] {
+        m4 = std::map<long, long>(snapshot.begin(), snapshot.end());
+    });
+    sink += checksum(m1) + checksum(m2) + checksum(m3) + checksum(m4);
+    printf("bulk build %zd sorted pairs (sink %ld)\n", n, sink);
+    printf("  mstl::map insert one by one   %8.2f ms\n", t_each);
+    printf("  mstl::map(first, last)        %8.2f ms\n", t_range);
+    printf("  mstl::map(sorted_unique, ...) %8.2f ms\n", t_sorted);
+    printf("  std::map(first, last)         %8.2f ms\n", t_std);
+}
+
+// 按递增时间戳追加：逐个 insert vs emplace_hint(end())
+static void bench_append(std::size_t n) {
+    long sink = 0;
+    mstl::map<long, long> m1, m2;
+    std::map<long, long> m3;
+    double t_insert = measure([&] {
+        for (std::size_t i = 0; i < n; i++) {
+            m1.emplace(long(i), long(i));
+        }
+    });
+    double t_hint = measure([&] {
+        for (std::size_t i = 0; i < n; i++) {
+            m2.emplace_hint(m2.end(), long(i), long(i));
+        }
+    });
+    double t_std = measure([&] {
+        for (std::size_t i = 0; i < n; i++) {
+            m3.emplace_hint(m3.end(), long(i), long(i));
+        }
+    });
+    sink += checksum(m1) + checksum(m2) + checksum(m3);
+    printf("append %zd increasing keys (sink %ld)\n", n, sink);
+    printf("  mstl::map emplace             %8.2f ms\n", t_insert);
+    printf("  mstl::map emplace_hint(end()) %8.2f ms\n", t_hint);
+    printf("  std::map emplace_hint(end())  %8.2f ms\n", t_std);
+}
+
+// 析构一棵按随机顺序插入建成的大树
+static void bench_teardown(std::size_t n) {
+    std::mt19937_64 rng(7);
+    std::vector<std::pair<long, long>> snapshot;
+    snapshot.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+        snapshot.emplace_back(long(rng() >> 1), long(i));
+    }
+    auto *m1 = new mstl::map<long, long>(snapshot.begin(), snapshot.end());
+    auto *m2 =
+        new mstl::pool_map<long, long>(snapshot.begin(), snapshot.end());
+    auto *m3 = new std::map<long, long>(snapshot.begin(), snapshot.end());
+    double t_mstl = measure([&] { delete m1; });
+    double t_pool = measure([&] { delete m2; });
+    double t_std = measure([&] { delete m3; });
+    printf("destroy %zd entries\n", n);
+    printf("  mstl::map                     %8.2f ms\n", t_mstl);
+    printf("  mstl::pool_map                %8.2f ms\n", t_pool);
+    printf("  std::map                      %8.2f ms\n", t_std);
+}
+
+// 复制一份大配置表：拷贝构造与拷贝赋值（赋值目标已有同样多的节点）
+static void bench_copy(std::size_t n) {
+    std::mt19937_64 rng(11);
+    mstl::map<long, long> src;
+    std::map<long, long> std_src;
+    for (std::size_t i = 0; i < n; i++) {
+        long k = long(rng() >> 1);
+        src.emplace(k, long(i));
+        std_src.emplace(k, long(i));
+    }
+    long sink = 0;
+    mstl::map<long, long> dst(src);
+    double t_ctor = measure([&] {
+        mstl::map<long, long> copy(src);
+        sink += long(copy.empty());
+    });
+    double t_assign = measure([&] { dst = src; });
+    double t_std = measure([&] {
+        std::map<long, long> copy(std_src);
+        sink += long(copy.empty());
+    });
+    sink += checksum(dst);
+    printf("copy %zd entries (sink %ld)\n", n, sink);
+    printf("  mstl::map copy construct      %8.2f ms\n", t_ctor);
+    printf("  mstl::map copy assign         %8.2f ms\n", t_assign);
+    printf("  std::map copy construct       %8.2f ms\n", t_std);
+}
+
+// 键大多已存在的 insert-if-absent：重复键不应再分配节点
+static void bench_insert_existing(std::size_t n, std::size_t rounds) {
+    std::mt19937_64 rng(13);
+    std::vector<long> keys(n);
+    for (auto &k : keys) {
+        k = long(rng() >> 1);
+    }
+    mstl::map<long, std::string> m;
+    std::map<long, std::string> std_m;
+    for (long k : keys) {
+        m.emplace(k, "initial value that does not fit in SSO");
+        std_m.emplace(k, "initial value that does not fit in SSO");
+    }
+    long sink = 0;
+    double t_emplace = measure([&] {
+        for (std::size_t r = 0; r < rounds; r++) {
+            for (long k : keys) {
+                sink += m.emplace(k, "a value that does not fit in SSO").second;
+            }
+        }
+    });
+    double t_try = measure([&] {
+        for (std::size_t r = 0; r < rounds; r++) {
+            for (long k : keys) {
+                sink +=
+                    m.try_emplace(k, "a value that does not fit in SSO").second;
+            }
+        }
+    });
+    double t_std = measure([&] {
+        for (std::size_t r = 0; r < rounds; r++) {
+            for (long k : keys) {
+                sink += std_m.emplace(k, "a value that does not fit in SSO")
+                            .second;
+            }
+        }
+    });
+    printf("insert %zd existing keys x %zd (sink %ld)\n", n, rounds, sink);
+    printf("  mstl::map emplace             %8.2f ms\n", t_emplace);
+    printf("  mstl::map try_emplace         %8.2f ms\n", t_try);
+    printf("  std::map emplace              %8.2f ms\n", t_std);
+}
+
+// 百分位与区间计数：ranked_multi_set 走子树大小，multi_set 只能数过去
+static void bench_percentile(std::size_t n, std::size_t queries) {
+    std::mt19937_64 rng(17);
+    std::vector<long> samples(n);
+    for (auto &x : samples) {
+        x = long(rng() % (n * 4));
+    }
+    mstl::multi_set<long> plain;
+    mstl::ranked_multi_set<long> ranked;
+    double t_plain_ins = measure([&] {
+        for (long x : samples) {
+            plain.insert(x);
+        }
+    });
+    double t_ranked_ins = measure([&] {
+        for (long x : samples) {
+            ranked.insert(x);
+        }
+    });
+    long sink = 0;
+    double t_plain = measure([&] {
+        for (std::size_t q = 0; q < queries; q++) {
+            auto it = plain.begin();
+            std::advance(it, n * (q % 100) / 100);
+            sink += *it;
+            long lo = long(rng() % (n * 4));
+            sink += std::distance(plain.lower_bound(lo),
+                                  plain.lower_bound(lo + long(n)));
+        }
+    });
+    double t_ranked = measure([&] {
+        for (std::size_t q = 0; q < queries; q++) {
+            sink += *ranked.nth(n * (q % 100) / 100);
+            long lo = long(rng() % (n * 4));
+            sink += long(ranked.count_range(lo, lo + long(n)));
+        }
+    });
+    printf("percentile over %zd samples, %zd queries (sink %ld)\n", n,
+           queries, sink);
+    printf("  multi_set insert              %8.2f ms\n", t_plain_ins);
+    printf("  ranked_multi_set insert       %8.2f ms\n", t_ranked_ins);
+    printf("  multi_set advance+distance    %8.2f ms\n", t_plain);
+    printf("  ranked_multi_set nth+count    %8.2f ms\n", t_ranked);
+}
+
+// 时间段聚合与区间相交：增强树剪枝 vs 逐个遍历
+static void bench_augmented(std::size_t n, std::size_t queries) {
+    std::mt19937_64 rng(19);
+    mstl::aggregate_map<long, long> volume;
+    mstl::map<long, long> plain;
+    mstl::interval_map<long, long> spans;
+    std::vector<std::pair<long, long>> span_list;
+    for (std::size_t i = 0; i < n; i++) {
+        long t = long(i) * 10;
+        long v = long(rng() % 1000);
+        volume.try_emplace(t, v);
+        plain.try_emplace(t, v);
+        long len = 1 + long(rng() % 100);
+        spans.emplace(std::make_pair(t, t + len), v);
+        span_list.emplace_back(t, t + len);
+    }
+    long sink = 0;
+    long horizon = long(n) * 10;
+    double t_scan = measure([&] {
+        for (std::size_t q = 0; q < queries; q++) {
+            long lo = long(rng() % std::uint64_t(horizon));
+            long hi = lo + horizon / 10;
+            for (auto it = plain.begin(); it != plain.end(); ++it) {
+                if (it->first >= lo && it->first < hi) {
+                    sink += it->second;
+                }
+            }
+        }
+    });
+    double t_agg = measure([&] {
+        for (std::size_t q = 0; q < queries; q++) {
+            long lo = long(rng() % std::uint64_t(horizon));
+            sink += volume.range_aggregate(lo, lo + horizon / 10);
+        }
+    });
+    double t_span_scan = measure([&] {
+        for (std::size_t q = 0; q < queries; q++) {
+            long lo = long(rng() % std::uint64_t(horizon));
+            for (auto const &span : span_list) {
+                if (span.first < lo + 50 && lo < span.second) {
+                    sink++;
+                }
+            }
+        }
+    });
+    double t_span = measure([&] {
+        for (std::size_t q = 0; q < queries; q++) {
+            long lo = long(rng() % std::uint64_t(horizon));
+            spans.for_each_overlap(lo, lo + 50, [&](auto const &) { sink++; });
+        }
+    });
+    printf("augmented queries over %zd entries, %zd queries (sink %ld)\n", n,
+           queries, sink);
+    printf("  map scan for range sum        %8.2f ms\n", t_scan);
+    printf("  aggregate_map range_aggregate %8.2f ms\n", t_agg);
+    printf("  vector scan for overlaps      %8.2f ms\n", t_span_scan);
+    printf("  interval_map for_each_overlap %8.2f ms\n", t_span);
+}
+
+// 当作优先队列用：反复取 begin() 再 erase(begin())
+static void bench_pop_min(std::size_t n) {
+    std::mt19937_64 rng(29);
+    std::vector<long> keys(n);
+    for (auto &k : keys) {
+        k = long(rng());
+    }
+    mstl::multi_map<long, long> m1;
+    std::multimap<long, long> m2;
+    for (long k : keys) {
+        m1.emplace(k, k);
+        m2.emplace(k, k);
+    }
+    long sink = 0;
+    double t_mstl = measure([&] {
+        while (!m1.empty()) {
+            sink += m1.begin()->second;
+            m1.erase(m1.begin());
+        }
+    });
+    double t_std = measure([&] {
+        while (!m2.empty()) {
+            sink += m2.begin()->second;
+            m2.erase(m2.begin());
+        }
+    });
+    printf("pop min %zd times (sink %ld)\n", n, sink);
+    printf("  mstl::multi_map               %8.2f ms\n", t_mstl);
+    printf("  std::multimap                 %8.2f ms\n", t_std);
+}
+
+// 集合运算：join/split 挪动节点 vs 逐个插入/查找/删除。运算会清空参数，
+// 每轮先在计时之外拷贝出输入
+static void bench_set_algebra(std::size_t n, std::size_t m,
+                              std::size_t rounds) {
+    std::mt19937_64 rng(31);
+    mstl::set<long> big, small;
+    // size() 要遍历整棵树，这里自己计数
+    for (std::size_t k = 0; k < n;) {
+        k += big.insert(long(rng() % (n * 4))).second;
+    }
+    for (std::size_t k = 0; k < m;) {
+        k += small.insert(long(rng() % (n * 4))).second;
+    }
+    long sink = 0;
+    double t_union = 0, t_union_loop = 0, t_inter = 0, t_inter_loop = 0;
+    double t_diff = 0, t_diff_loop = 0;
+    for (std::size_t r = 0; r < rounds; r++) {
+        mstl::set<long> a1(big), a2(big), a3(big), a4(big), a5(big);
+        mstl::set<long> b1(small), b2(small), b3(small);
+        t_union += measure([&] { a1.set_union(std::move(b1)); });
+        t_union_loop += measure([&] {
+            for (long x : small) {
+                a2.insert(x);
+            }
+        });
+        t_inter += measure([&] { a3.set_intersection(std::move(b2)); });
+        mstl::set<long> kept;
+        t_inter_loop += measure([&] {
+            for (long x : small) {
+                if (big.contains(x)) {
+                    kept.insert(x);
+                }
+            }
+        });
+        t_diff += measure([&] { a4.set_difference(std::move(b3)); });
+        t_diff_loop += measure([&] {
+            for (long x : small) {
+                a5.erase(x);
+            }
+        });
+        sink += long(a1.size() + a2.size() + a3.size() + kept.size() +
+                     a4.size() + a5.size());
+    }
+    printf("set algebra %zd with %zd x %zd (sink %ld)\n", n, m, rounds, sink);
+    printf("  set_union                     %8.2f ms\n", t_union);
+    printf("  insert one by one             %8.2f ms\n", t_union_loop);
+    printf("  set_intersection              %8.2f ms\n", t_inter);
+    printf("  contains + insert             %8.2f ms\n", t_inter_loop);
+    printf("  set_difference                %8.2f ms\n", t_diff);
+    printf("  erase one by one              %8.2f ms\n", t_diff_loop);
+}
+
+// 并行批量操作 vs 串行版本；单核机器上 fork 层数为 0，两者走同一条路径
+static void bench_parallel(std::size_t n) {
+    std::mt19937_64 rng(37);
+    std::vector<std::pair<long, long>> input(n);
+    for (auto &kv : input) {
+        kv = {long(rng() % (n * 2)), 0};
+    }
+    long sink = 0;
+    double t_serial = measure([&] {
+        mstl::map<long, long> m(input.begin(), input.end());
+        sink += m.begin()->first;
+    });
+    mstl::map<long, long> m;
+    double t_bulk = measure([&] { m.insert_bulk(input.begin(), input.end()); });
+    double t_each = measure([&] {
+        for (auto &kv : m) {
+            kv.second += kv.first;
+        }
+    });
+    double t_each_par = measure([&] {
+        m.for_each_parallel([](auto &kv) { kv.second += kv.first; });
+    });
+    mstl::map<long, long> a(m), b(m), c(m), d(m);
+    double t_union = measure([&] { a.set_union(std::move(b)); });
+    double t_union_par = measure([&] { c.union_with(std::move(d)); });
+    sink += a.begin()->second + c.begin()->second;
+    // 叶子在工作线程上分配节点，线程退出后池里剩下的节点要能被下一轮
+    // 取回，否则每轮都切新的 slab
+    std::size_t slabs_before = 0;
+    for (int round = 0; round < 20; round++) {
+        mstl::pool_map<long, long> p;
+        p.insert_bulk(input.begin(), input.end());
+        sink += p.size();
+        if (round == 0) {
+            slabs_before = mstl::pool_slab_count();
+        }
+    }
+    printf("parallel %zd, %u threads (sink %ld)\n", n,
+           std::thread::hardware_concurrency(), sink);
+    printf("  insert(first, last)           %8.2f ms\n", t_serial);
+    printf("  insert_bulk                   %8.2f ms\n", t_bulk);
+    printf("  range for                     %8.2f ms\n", t_each);
+    printf("  for_each_parallel             %8.2f ms\n", t_each_par);
+    printf("  set_union                     %8.2f ms\n", t_union);
+    printf("  union_with                    %8.2f ms\n", t_union_par);
+    printf("  pool_map insert_bulk x20      %zd -> %zd slabs\n", slabs_before,
+           mstl::pool_slab_count());
+}
+
+// 成批查找：逐个 find vs find_many 交错下降 + 预取。表比缓存大时
+// 每次查找都是一串依赖的缓存缺失，交错之后几条路径的缺失可以重叠
+static void bench_find_many(std::size_t n, std::size_t batch,
+                            std::size_t rounds) {
+    std::mt19937_64 rng(41);
+    mstl::map<long, long> m;
+    for (std::size_t k = 0; k < n;) {
+        k += m.insert({long(rng() % (n * 2)), 0}).second;
+    }
+    std::vector<long> keys(batch);
+    std::vector<mstl::map<long, long>::iterator> found;
+    found.reserve(batch);
+    long sink = 0;
+    double t_loop = 0, t_many = 0, t_sorted_loop = 0, t_sorted_many = 0;
+    for (std::size_t r = 0; r < rounds; r++) {
+        for (long &key : keys) {
+            key = long(rng() % (n * 2));
+        }
+        for (int sorted = 0; sorted < 2; sorted++) {
+            if (sorted) {
+                std::sort(keys.begin(), keys.end());
+            }
+            (sorted ? t_sorted_loop : t_loop) += measure([&] {
+                for (long key : keys) {
+                    auto it = m.find(key);
+                    sink += it != m.end() ? it->first : 0;
+                }
+            });
+            (sorted ? t_sorted_many : t_many) += measure([&] {
+                found.clear();
+                m.find_many(keys.begin(), keys.end(),
+                            std::back_inserter(found));
+                for (auto it : found) {
+                    sink += it != m.end() ? it->first : 0;
+                }
+            });
+        }
+    }
+    printf("find_many %zd keys in %zd x %zd (sink %ld)\n", batch, n, rounds,
+           sink);
+    printf("  find one by one               %8.2f ms\n", t_loop);
+    printf("  find_many                     %8.2f ms\n", t_many);
+    printf("  find one by one, sorted keys  %8.2f ms\n", t_sorted_loop);
+    printf("  find_many, sorted keys        %8.2f ms\n", t_sorted_many);
+}
+
+// 局部性很强的查找：每个键都在上一个附近（随机游走，步长为 __step 个
+// 元素以内），从根查找 vs 以上次结果为起点的 finger 查找 vs 记住路径的
+// cursor
+static void bench_finger(std::size_t n, long step, std::size_t queries) {
+    mstl::set<long> s;
+    std::vector<long> sorted(n);
+    for (std::size_t i = 0; i < n; i++) {
+        sorted[i] = long(i) * 2;
+    }
+    s.insert(sorted.begin(), sorted.end());
+    std::mt19937_64 rng(43);
+    std::vector<long> keys(queries);
+    long key = long(n);
+    for (long &k : keys) {
+        key += long(rng() % std::uint64_t(step * 4 + 1)) - step * 2;
+        key = key < 0 ? -key : key >= long(n) * 2 ? long(n) * 4 - key - 2 : key;
+        k = key;
+    }
+    long sink = 0;
+    double t_root = measure([&] {
+        for (long k : keys) {
+            auto it = s.lower_bound(k);
+            sink += it != s.end() ? *it : 0;
+        }
+    });
+    double t_finger = measure([&] {
+        auto it = s.end();
+        for (long k : keys) {
+            it = s.lower_bound(it, k);
+            sink += it != s.end() ? *it : 0;
+        }
+    });
+    double t_cursor = measure([&] {
+        mstl::set<long>::cursor cur(s);
+        for (long k : keys) {
+            auto it = cur.lower_bound(k);
+            sink += it != s.end() ? *it : 0;
+        }
+    });
+    printf("finger %zd, step %ld, %zd queries (sink %ld)\n", n, step, queries,
+           sink);
+    printf("  lower_bound from root         %8.2f ms\n", t_root);
+    printf("  lower_bound from finger       %8.2f ms\n", t_finger);
+    printf("  lower_bound from cursor       %8.2f ms\n", t_cursor);
+}
+
+// 红黑树 vs B 树：随机插入、随机查找、顺序遍历、随机删除
+template <typename Map>
+static void bench_backend_one(char const *name, std::vector<long> const &keys,
+                              std::vector<long> const &probes) {
+    Map m;
+    long sink = 0;
+    double t_insert = measure([&] {
+        for (long k : keys) {
+            m.emplace(k, k);
+        }
+    });
+    double t_find = measure([&] {
+        for (long k : probes) {
+            auto it = m.find(k);
+            if (it != m.end()) {
+                sink += it->second;
+            }
+        }
+    });
+    double t_iter = measure([&] {
+        for (int r = 0; r < 10; r++) {
+            sink += checksum(m);
+        }
+    });
+    double t_erase = measure([&] {
+        for (long k : probes) {
+            sink += long(m.erase(k));
+        }
+    });
+    printf("  %-14s insert %7.2f find %7.2f iterate x10 %7.2f "
+           "erase %7.2f ms (sink %ld)\n",
+           name, t_insert, t_find, t_iter, t_erase, sink);
+}
+
+static void bench_backend(std::size_t n) {
+    std::mt19937_64 rng(23);
+    std::vector<long> keys(n), probes(n);
+    for (auto &k : keys) {
+        k = long(rng() % (n * 2));
+    }
+    for (auto &k : probes) {
+        k = long(rng() % (n * 2));
+    }
+    printf("backend, %zd random long keys\n", n);
+    bench_backend_one<mstl::map<long, long>>("mstl::map", keys, probes);
+    bench_backend_one<mstl::btree_map<long, long>>("btree_map", keys, probes);
+    bench_backend_one<std::map<long, long>>("std::map", keys, probes);
+}
+
+int main() {
+    bench_bulk_build(1000000);
+    bench_append(1000000);
+    bench_teardown(1000000);
+    bench_copy(1000000);
+    bench_insert_existing(100000, 10);
+    bench_percentile(200000, 100);
+    bench_augmented(200000, 100);
+    bench_backend(1000000);
+    bench_pop_min(1000000);
+    bench_set_algebra(100000, 100, 20);
+    bench_set_algebra(100000, 100000, 5);
+    bench_parallel(1000000);
+    bench_find_many(1000, 10000, 20);
+    bench_find_many(4000000, 10000, 20);
+    bench_finger(1000000, 4, 1000000);
+    bench_finger(1000000, 64, 1000000);
+    bench_finger(1000000, 1000, 1000000);
+    return 0;
+}
@@ -1,6 +1,10 @@
 #include "map.hpp"
+#include "pool_allocator.hpp"
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <string>
+#include <vector>
 
 int main() {
     std::cout << std::boolalpha;
@@ -15,6 +19,68 @@ int main() {
 
     std::cout << "at(delay): " << table.at("delay") << '\n';
     std::cout << "size: " << table.size() << '\n';
+    // 已排序的快照直接线性建树
+    std::pair<int, int> snapshot[] = {{1, 10}, {2, 20}, {3, 30}, {5, 50}};
+    mstl::map<int, int> loaded(mstl::sorted_unique, std::begin(snapshot),
+                               std::end(snapshot));
+    for (auto const &kv : loaded)
+        std::cout << kv.first << "->" << kv.second << ' ';
+    std::cout << '\n';
+
+    // 键已存在时 try_emplace 不分配节点，也不会移走参数
+    mstl::map<int, std::string> names;
+    names.try_emplace(1, "one");
+    std::string name = "uno";
+    auto [it, inserted] = names.try_emplace(1, std::move(name));
+    std::cout << "try_emplace(1): " << inserted << ' ' << it->second
+              << ", arg: " << name << '\n';
+    names.insert_or_assign(1, "eins");
+    std::cout << "insert_or_assign(1): " << names[1] << '\n';
+
+    // 当作优先队列：begin() 直接取缓存的最左节点
+    mstl::multi_map<int, std::string> tasks{{3, "c"}, {1, "a"}, {2, "b"}};
+    while (!tasks.empty()) {
+        std::cout << tasks.begin()->second << ' ';
+        tasks.erase(tasks.begin());
+    }
+    std::cout << '\n';
+
+    // 成批查找：结果按键的顺序写出，与逐个 find 相同
+    std::string wanted[] = {"delay", "missing"};
+    std::vector<mstl::map<std::string, int>::iterator> hits;
+    table.find_many(wanted, wanted + 2, std::back_inserter(hits));
+    bool present[2];
+    table.contains_many(wanted, wanted + 2, present);
+    std::cout << "find_many: " << hits[0]->second << ' '
+              << (hits[1] == table.end()) << ", contains_many: " << present[0]
+              << ' ' << present[1] << '\n';
+
+    // clear() 把整棵树的节点一串挂回池的空闲链表，再次插入时逐个取回
+    mstl::pool_map<int, int> pooled;
+    std::vector<void const *> freed;
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 500; i++) {
+            pooled.emplace(i * 7 % 500, i + round);
+        }
+        std::size_t reused = 0;
+        for (auto const &kv : pooled) {
+            reused += std::binary_search(freed.begin(), freed.end(), &kv);
+        }
+        auto last = std::prev(pooled.end());
+        std::cout << "pooled round " << round << ": "
+                  << std::distance(pooled.begin(), pooled.end())
+                  << " entries, last " << last->first << "->" << last->second
+                  << ", reused " << reused << " nodes\n";
+        freed.clear();
+        for (auto const &kv : pooled) {
+            freed.push_back(&kv);
+        }
+        std::sort(freed.begin(), freed.end());
+        pooled.clear();
+    }
+    std::cout << "pooled empty: " << pooled.empty() << '\n';
+
+    std::cout << "node overhead: " << sizeof(_RbTreeNode) << " bytes\n";
 
     return 0;
 }
@@ -0,0 +1,119 @@
+#ifndef __MMAP_ALLOCATOR__
+#define __MMAP_ALLOCATOR__
+
+/*
+
+ -- 大块内存直接走 mmap 的分配器 --
+
+ 小于 Threshold 字节的块仍由 std::allocator 分配；达到 Threshold 的块
+ 直接向内核 mmap，并提供 reallocate：两端都是大块时使用
+ mremap(MREMAP_MAYMOVE) 重新映射页表，不拷贝数据，也不会让峰值内存翻倍。
+ vector 对可平凡搬迁的元素会自动使用 reallocate（见 _relocate.hpp）。
+
+*/
+
+#include "_relocate.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace mstl {
+
+template <typename T, std::size_t Threshold = std::size_t(4) << 20>
+class mmap_allocator {
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using is_always_equal = std::true_type;
+
+    template <typename U> struct rebind {
+        using other = mmap_allocator<U, Threshold>;
+    };
+
+    static constexpr std::size_t threshold = Threshold;
+
+  private:
+    static std::size_t page_size() noexcept {
+        static const std::size_t size = sysconf(_SC_PAGESIZE);
+        return size;
+    }
+
+    static std::size_t round_to_page(std::size_t bytes) noexcept {
+        std::size_t page = page_size();
+        return (bytes + page - 1) / page * page;
+    }
+
+    static bool is_large(std::size_t n) noexcept {
+        return n * sizeof(T) >= Threshold;
+    }
+
+  public:
+    mmap_allocator() noexcept = default;
+
+    template <typename U>
+    mmap_allocator(mmap_allocator<U, Threshold> const &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        if (!is_large(n)) {
+            return std::allocator<T>().allocate(n);
+        }
+        void *p = mmap(nullptr, round_to_page(n * sizeof(T)),
+                       PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                       0);
+        if (p == MAP_FAILED) [[unlikely]]
+            throw std::bad_alloc();
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        if (!is_large(n)) {
+            std::allocator<T>().deallocate(p, n);
+            return;
+        }
+        munmap(p, round_to_page(n * sizeof(T)));
+    }
+
+    // 把容量为 old_n、前 used 个元素有效的块按字节搬到容量为 new_n 的块，
+    // 返回新地址；旧块随之失效。仅适用于可平凡搬迁的类型
+    T *reallocate(T *p, std::size_t old_n, std::size_t new_n,
+                  std::size_t used) {
+        static_assert(is_trivially_relocatable_v<T>,
+                      "reallocate requires a trivially relocatable type");
+#ifdef MREMAP_MAYMOVE
+        if (is_large(old_n) && is_large(new_n)) {
+            void *q = mremap(p, round_to_page(old_n * sizeof(T)),
+                             round_to_page(new_n * sizeof(T)), MREMAP_MAYMOVE);
+            if (q == MAP_FAILED) [[unlikely]]
+                throw std::bad_alloc();
+            return static_cast<T *>(q);
+        }
+#endif
+        T *q = allocate(new_n);
+        trivially_relocate(p, p + std::min(used, new_n), q);
+        deallocate(p, old_n);
+        return q;
+    }
+
+    template <typename U>
+    bool operator==(mmap_allocator<U, Threshold> const &) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(mmap_allocator<U, Threshold> const &) const noexcept {
+        return false;
+    }
+};
+
+template <typename T, typename Growth = growth_2x>
+using mmap_vector = vector<T, mmap_allocator<T>, Growth>;
+
+} // namespace mstl
+
+#endif // !__MMAP_ALLOCATOR__
@@ -0,0 +1,33 @@
+#include "mmap_allocator.hpp"
+#include <cstddef>
+#include <cstdio>
+
+int main() {
+    // 超过 4 MiB 之后扩容走 mremap，不再逐个拷贝
+    mstl::mmap_vector<int> arr;
+    for (int i = 0; i < 10000000; i++) {
+        arr.push_back(i);
+    }
+    long long sum = 0;
+    for (size_t i = 0; i < arr.size(); i++) {
+        sum += arr[i];
+    }
+    printf("arr.size() = %zd, arr.capacity() = %zd, sum = %lld\n",
+           arr.size(), arr.capacity(), sum);
+
+    arr.resize(3000000);
+    arr.shrink_to_fit();
+    printf("after shrink: size = %zd, cap = %zd, back = %d\n", arr.size(),
+           arr.capacity(), arr.back());
+
+    arr.resize(10);
+    arr.shrink_to_fit();
+    printf("small again: size = %zd, cap = %zd, back = %d\n", arr.size(),
+           arr.capacity(), arr.back());
+
+    mstl::mmap_vector<int> small{1, 2, 3};
+    small.insert(small.begin() + 1, 42);
+    for (size_t i = 0; i < small.size(); i++) {
+        printf("small[%zd] = %d\n", i, small[i]);
+    }
+}
@@ -0,0 +1,276 @@
+#ifndef __POOL_ALLOCATOR__
+#define __POOL_ALLOCATOR__
+
+/*
+
+ -- 节点池分配器 --
+
+ 单个对象的分配从大块 slab 中按固定大小切出，释放的节点挂进侵入式空闲
+ 链表，下次分配直接弹出，不再经过 malloc。适合 map/set/list 这类每个
+ 元素一个节点、又频繁增删的容器（例如订单簿）。
+
+ - 池按 (块大小, 对齐) 区分，同样大小的节点共用一个池；
+ - 每个线程一个池，分配与释放平时不加锁。节点可以在其它线程释放，
+   它会进入释放线程的空闲链表；
+ - 线程退出时，它的空闲链表和当前 slab 剩下的部分交给全局的孤儿链表；
+   线程的空闲节点超过 4 个 slab 时也整串交出去。任何线程用完当前 slab
+   后先从孤儿链表取一批，取不到才切新的 slab。所以只释放不分配的线程、
+   短命的线程不会让内存一直增长；
+ - slab 在进程生命周期内不归还给系统，所有 slab 串在一条全局链表上；
+ - 一次分配多个对象（n != 1）仍然走 std::allocator。
+
+*/
+
+#include "map.hpp"
+#include "set.hpp"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace mstl {
+
+// 所有池、所有线程的 slab 串成一条链，slab 的第一个块存放链表指针
+inline std::atomic<void *> &__pool_slabs() noexcept {
+    static std::atomic<void *> head{nullptr};
+    return head;
+}
+
+// 至今切出的 slab 总数，遍历全局链表
+inline std::size_t pool_slab_count() noexcept {
+    std::size_t count = 0;
+    for (void *slab = __pool_slabs().load(std::memory_order_acquire);
+         slab != nullptr; slab = *static_cast<void **>(slab)) {
+        count++;
+    }
+    return count;
+}
+
+template <std::size_t Size, std::size_t Align, std::size_t SlabBytes>
+class node_pool {
+    struct free_node {
+        free_node *next;
+    };
+
+    static constexpr std::size_t align =
+        Align > alignof(free_node) ? Align : alignof(free_node);
+    static constexpr std::size_t block =
+        ((Size > sizeof(free_node) ? Size : sizeof(free_node)) + align - 1) /
+        align * align;
+
+    static_assert(SlabBytes >= 2 * block, "slab too small for the node size");
+
+    static constexpr std::size_t slab_blocks = SlabBytes / block;
+
+    free_node *m_free = nullptr;
+    free_node *m_tail = nullptr; // 空闲链表的最后一个节点
+    std::size_t m_count = 0;     // 空闲链表的长度
+    unsigned char *m_cur = nullptr; // 当前 slab 中尚未切分的部分
+    unsigned char *m_end = nullptr;
+
+    // 线程交出的空闲节点首尾相接成一条链
+    struct orphan_list {
+        std::mutex lock;
+        free_node *head = nullptr;
+        free_node *tail = nullptr;
+    };
+
+    static orphan_list &orphans() noexcept {
+        static orphan_list list;
+        return list;
+    }
+
+    void refill() {
+        void *slab;
+        if constexpr (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            slab = ::operator new(SlabBytes, std::align_val_t(align));
+        } else {
+            slab = ::operator new(SlabBytes);
+        }
+        std::atomic<void *> &slabs = __pool_slabs();
+        void *head = slabs.load(std::memory_order_relaxed);
+        do {
+            *static_cast<void **>(slab) = head;
+        } while (!slabs.compare_exchange_weak(head, slab,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+        m_cur = static_cast<unsigned char *>(slab) + block;
+        m_end = static_cast<unsigned char *>(slab) + SlabBytes / block * block;
+    }
+
+    // 整条空闲链表交给孤儿链表
+    void release() noexcept {
+        if (m_free == nullptr) {
+            return;
+        }
+        orphan_list &list = orphans();
+        std::lock_guard<std::mutex> guard(list.lock);
+        m_tail->next = list.head;
+        list.head = m_free;
+        if (list.tail == nullptr) {
+            list.tail = m_tail;
+        }
+        m_free = m_tail = nullptr;
+        m_count = 0;
+    }
+
+    // 从孤儿链表取至多一个 slab 的节点。数节点时一直持有锁，否则别的
+    // 线程会看到空链表而去切新的 slab
+    bool adopt() {
+        orphan_list &list = orphans();
+        std::lock_guard<std::mutex> guard(list.lock);
+        if (list.head == nullptr) {
+            return false;
+        }
+        free_node *last = list.head;
+        std::size_t count = 1;
+        for (; count < slab_blocks && last != list.tail; count++) {
+            last = last->next;
+        }
+        m_free = list.head;
+        m_tail = last;
+        m_count = count;
+        list.head = last->next;
+        last->next = nullptr;
+        if (list.head == nullptr) {
+            list.tail = nullptr;
+        }
+        return true;
+    }
+
+  public:
+    static constexpr std::size_t block_size = block;
+    static constexpr std::size_t slab_size = SlabBytes;
+
+    node_pool() noexcept = default;
+    node_pool(node_pool const &) = delete;
+    node_pool &operator=(node_pool const &) = delete;
+
+    // 线程退出：当前 slab 剩下的部分切成块，连同空闲链表一起交出去
+    ~node_pool() {
+        for (; m_cur != m_end; m_cur += block) {
+            deallocate(m_cur);
+        }
+        release();
+    }
+
+    static node_pool &local() noexcept {
+        static thread_local node_pool pool;
+        return pool;
+    }
+
+    void *allocate() {
+        if (m_free != nullptr) [[likely]] {
+            free_node *node = m_free;
+            m_free = node->next;
+            --m_count;
+            return node;
+        }
+        if (m_cur == m_end) [[unlikely]] {
+            if (adopt()) {
+                return allocate();
+            }
+            refill();
+        }
+        void *p = m_cur;
+        m_cur += block;
+        return p;
+    }
+
+    void deallocate(void *p) noexcept {
+        free_node *node = static_cast<free_node *>(p);
+        if (m_free == nullptr) {
+            m_tail = node;
+        }
+        node->next = m_free;
+        m_free = node;
+        if (++m_count > 4 * slab_blocks) [[unlikely]] {
+            release();
+        }
+    }
+
+    // head 到 tail 共 count 块，每块开头存放指向下一块的指针，
+    // 整串挂回空闲链表
+    void deallocate_chain(void *head, void *tail, std::size_t count) noexcept {
+        if (m_free == nullptr) {
+            m_tail = static_cast<free_node *>(tail);
+        }
+        static_cast<free_node *>(tail)->next = m_free;
+        m_free = static_cast<free_node *>(head);
+        m_count += count;
+        if (m_count > 4 * slab_blocks) {
+            release();
+        }
+    }
+};
+
+template <typename T, std::size_t SlabBytes = std::size_t(64) << 10>
+class pool_allocator {
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using is_always_equal = std::true_type;
+
+    template <typename U> struct rebind {
+        using other = pool_allocator<U, SlabBytes>;
+    };
+
+    using pool_type = node_pool<sizeof(T), alignof(T), SlabBytes>;
+
+    pool_allocator() noexcept = default;
+
+    template <typename U>
+    pool_allocator(pool_allocator<U, SlabBytes> const &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        if (n == 1) [[likely]] {
+            return static_cast<T *>(pool_type::local().allocate());
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        if (n == 1) [[likely]] {
+            pool_type::local().deallocate(p);
+            return;
+        }
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    // 一次释放一串共 n 个单个对象：每个对象开头的指针指向下一个，直到 last
+    void deallocate_chain(T *first, T *last, std::size_t n) noexcept {
+        pool_type::local().deallocate_chain(first, last, n);
+    }
+
+    template <typename U>
+    bool operator==(pool_allocator<U, SlabBytes> const &) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(pool_allocator<U, SlabBytes> const &) const noexcept {
+        return false;
+    }
+};
+
+template <class Key, class Mapped, class Compare = std::less<Key>>
+using pool_map =
+    map<Key, Mapped, Compare, pool_allocator<std::pair<Key const, Mapped>>>;
+
+template <class Key, class Mapped, class Compare = std::less<Key>>
+using pool_multi_map = multi_map<Key, Mapped, Compare,
+                                 pool_allocator<std::pair<Key const, Mapped>>>;
+
+template <class T, class Compare = std::less<T>>
+using pool_set = set<T, Compare, pool_allocator<T>>;
+
+template <class T, class Compare = std::less<T>>
+using pool_multi_set = multi_set<T, Compare, pool_allocator<T>>;
+
+} // namespace mstl
+
+#endif // !__POOL_ALLOCATOR__
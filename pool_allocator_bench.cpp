@@ -0,0 +1,52 @@
+#include "pool_allocator.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+template <typename F> static double measure(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+// 维持 live 个键，每轮删掉一个旧键、插入一个新键，模拟订单簿的增删
+template <typename Map>
+static void run(const char *name, std::vector<std::uint64_t> const &keys,
+                std::size_t live) {
+    Map m;
+    long sink = 0;
+    double t = measure([&] {
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            if (i >= live) {
+                m.erase(keys[i - live]);
+            }
+            m[keys[i]] = long(i);
+        }
+        for (auto &kv : m) {
+            sink += kv.second;
+        }
+    });
+    printf("%-28s churn %zd ops, %zd live: %8.2f ms (size %zd, sink %ld)\n",
+           name, keys.size(), live, t, m.size(), sink);
+}
+
+int main() {
+    constexpr std::size_t n = 1000000;
+    std::mt19937_64 rng(42);
+    std::vector<std::uint64_t> keys(n);
+    for (auto &k : keys) {
+        k = rng();
+    }
+
+    for (std::size_t live : {std::size_t(64), std::size_t(10000)}) {
+        run<std::map<std::uint64_t, long>>("std::map", keys, live);
+        run<mstl::map<std::uint64_t, long>>("mstl::map", keys, live);
+        run<mstl::pool_map<std::uint64_t, long>>("mstl::pool_map", keys, live);
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "pool_allocator.hpp"
+#include <cstdio>
+#include <string>
+#include <thread>
+
+int main() {
+    // 反复插入删除，释放的节点回到空闲链表后被下一次插入复用
+    mstl::pool_map<int, std::string> book;
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < 1000; i++) {
+            book[i] = std::to_string(i * round);
+        }
+        for (int i = 0; i < 1000; i += 2) {
+            book.erase(i);
+        }
+    }
+    printf("book.size() = %zd, book.at(999) = %s\n", book.size(),
+           book.at(999).c_str());
+
+    mstl::pool_set<int> set;
+    for (int x : {5, 3, 8, 1, 4}) {
+        set.insert(x);
+    }
+    set.erase(3);
+    for (int x : set) {
+        printf("%d ", x);
+    }
+    printf("\n");
+
+    // 同样大小的节点共用一个池：刚释放的节点立即被取回
+    using alloc = mstl::pool_allocator<long>;
+    alloc a;
+    long *p = a.allocate(1);
+    a.deallocate(p, 1);
+    long *q = a.allocate(1);
+    printf("reused: %s, block_size = %zd\n", p == q ? "yes" : "no",
+           alloc::pool_type::block_size);
+    a.deallocate(q, 1);
+
+    // 多个对象的分配仍然交给 std::allocator
+    long *arr = a.allocate(16);
+    arr[15] = 42;
+    printf("arr[15] = %ld\n", arr[15]);
+    a.deallocate(arr, 16);
+
+    // 在另一个线程释放节点也是安全的
+    mstl::pool_multi_map<int, int> shared;
+    for (int i = 0; i < 100; i++) {
+        shared.insert({i % 10, i});
+    }
+    std::thread([&] { shared.clear(); }).join();
+    printf("shared.size() = %zd\n", shared.size());
+
+    // 线程退出时把它的空闲节点和 slab 剩下的部分交出去，本线程这个大小
+    // 的池还是空的，第一次分配就取到那个 slab 里的块
+    struct record {
+        char bytes[72];
+    };
+    using record_alloc = mstl::pool_allocator<record>;
+    record *gone = nullptr;
+    std::thread([&] {
+        record_alloc r;
+        gone = r.allocate(1);
+        r.deallocate(gone, 1);
+    }).join();
+    record_alloc r;
+    record *adopted = r.allocate(1);
+    auto distance = reinterpret_cast<char *>(adopted) -
+                    reinterpret_cast<char *>(gone);
+    printf("adopted from exited thread: %s\n",
+           distance > -long(record_alloc::pool_type::slab_size) &&
+                   distance < long(record_alloc::pool_type::slab_size)
+               ? "yes"
+               : "no");
+    r.deallocate(adopted, 1);
+    return 0;
+}
@@ -1,6 +1,7 @@
 #ifndef __RAII__
 #define __RAII__
 
+#include "_relocate.hpp"
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
@@ -610,6 +611,13 @@ shared_ptr<T> dynamic_pointer_cast(shared_ptr<U> const &ptr) {
     }
 }
 
+// 智能指针内部只有裸指针，可以按字节搬迁
+template <typename T>
+struct is_trivially_relocatable<unique_ptr<T, deleter<T>>> : std::true_type {};
+
+template <typename T>
+struct is_trivially_relocatable<shared_ptr<T>> : std::true_type {};
+
 } // namespace mstl
 
 #endif // !__RAII__
@@ -11,34 +11,52 @@
 namespace mstl {
 
 template <class _Tp, class _Compare = std::less<_Tp>,
-          class _Alloc = std::allocator<_Tp>>
-struct set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
-    using typename _RbTreeImpl<_Tp const, _Compare, _Alloc>::const_iterator;
-    using typename _RbTreeImpl<_Tp const, _Compare, _Alloc>::node_type;
+          class _Alloc = std::allocator<_Tp>,
+          class _TreeTag = _RbTreeNoAugment>
+struct set
+    : _TreeImplSelect<_Tp const, _Compare, _Alloc, _TreeTag>::type {
+  private:
+    using _Impl =
+        typename _TreeImplSelect<_Tp const, _Compare, _Alloc, _TreeTag>::type;
+
+  public:
+    using typename _Impl::const_iterator;
+    using typename _Impl::node_type;
     using iterator = const_iterator;
+    // 连续查找相近的元素时用游标，见 _TreeCursor
+    using cursor = _TreeCursor<_Impl const, const_iterator, _Tp>;
+    using const_cursor = cursor;
     using value_type = _Tp;
     using size_type = std::size_t;
     using difference_type = std::ptrdiff_t;
 
     set() = default;
 
-    explicit set(_Compare __comp)
-        : _RbTreeImpl<_Tp const, _Compare, _Alloc>(__comp) {}
-
-    set(set &&) = default;
-    set &operator=(set &&) = default;
+    explicit set(_Compare __comp) : _Impl(__comp) {}
 
-    set(set const &__that) : _RbTreeImpl<_Tp const, _Compare, _Alloc>() {
-        this->_M_single_insert(__that.begin(), __that.end());
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    explicit set(_InputIt __first, _InputIt __last,
+                 _Compare __comp = _Compare())
+        : _Impl(__comp) {
+        this->_M_single_insert(__first, __last);
     }
 
-    set &operator=(set const &__that) {
-        if (&__that != this) {
-            this->assign(__that.begin(), __that.end());
-        }
-        return *this;
+    // 区间严格递增，线性时间建树
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    set(sorted_unique_t, _InputIt __first, _InputIt __last,
+        _Compare __comp = _Compare())
+        : _Impl(__comp) {
+        this->_M_single_insert(__first, __last, true);
     }
 
+    set(set &&) = default;
+    set &operator=(set &&) = default;
+
+    set(set const &) = default;
+    set &operator=(set const &) = default;
+
     set &operator=(std::initializer_list<_Tp> __ilist) {
         this->assign(__ilist);
         return *this;
@@ -53,7 +71,7 @@ struct set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
 
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
-    const_iterator find(_Tp &&__value) const noexcept {
+    const_iterator find(_Tv &&__value) const noexcept {
         return this->_M_find(__value);
     }
 
@@ -61,6 +79,25 @@ struct set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
         return this->_M_find(__value);
     }
 
+    // 以 __finger 为起点查找，见 _RbTreeImpl::_M_finger_bound
+    const_iterator find(const_iterator __finger,
+                        _Tp const &__value) const noexcept {
+        return this->_M_finger_find(__finger, __value);
+    }
+
+    using _Impl::lower_bound;
+    using _Impl::upper_bound;
+
+    const_iterator lower_bound(const_iterator __finger,
+                               _Tp const &__value) const noexcept {
+        return this->template _M_finger_bound<false>(__finger, __value);
+    }
+
+    const_iterator upper_bound(const_iterator __finger,
+                               _Tp const &__value) const noexcept {
+        return this->template _M_finger_bound<true>(__finger, __value);
+    }
+
     std::pair<iterator, bool> insert(_Tp &&__value) {
         return this->_M_single_emplace(std::move(__value));
     }
@@ -74,22 +111,42 @@ struct set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
         return this->_M_single_emplace(std::forward<_Ts>(__value)...);
     }
 
+    template <class... _Ts>
+    iterator emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        return this->_M_single_emplace_hint(__hint,
+                                            std::forward<_Ts>(__value)...);
+    }
+
+    iterator insert(const_iterator __hint, _Tp &&__value) {
+        return this->_M_single_emplace_hint(__hint, std::move(__value));
+    }
+
+    iterator insert(const_iterator __hint, _Tp const &__value) {
+        return this->_M_single_emplace_hint(__hint, __value);
+    }
+
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     void insert(_InputIt __first, _InputIt __last) {
-        return this->_M_single_insert(__first, __last);
+        this->_M_single_insert(__first, __last);
     }
 
-    using _RbTreeImpl<_Tp const, _Compare, _Alloc>::assign;
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(sorted_unique_t, _InputIt __first, _InputIt __last) {
+        this->_M_single_insert(__first, __last, true);
+    }
+
+    using _Impl::assign;
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     void assign(_InputIt __first, _InputIt __last) {
         this->clear();
-        return this->_M_single_insert(__first, __last);
+        this->_M_single_insert(__first, __last);
     }
 
-    using _RbTreeImpl<_Tp const, _Compare, _Alloc>::erase;
+    using _Impl::erase;
 
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
@@ -121,6 +178,35 @@ struct set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
         return this->_M_contains(__value);
     }
 
+    // 依次把每个键的 find 结果写入 __out，见 _RbTreeBase::_M_find_nodes
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) {
+        return this->_M_find_many(__first, __last, __out);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) const {
+        return this->_M_find_many(__first, __last, __out);
+    }
+
+    // 同 find_many，写入的是 contains 的结果
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt contains_many(_KeyIt __first, _KeyIt __last, _OutIt __out) const {
+        return this->_M_contains_many(__first, __last, __out);
+    }
+
+    std::pair<iterator, bool> insert(node_type __nh) {
+        return _Impl::insert(std::move(__nh));
+    }
+
+    using _Impl::extract;
+
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     node_type extract(_Tv &&__value) {
@@ -132,38 +218,91 @@ struct set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
         iterator __it = this->_M_find(__value);
         return __it != this->end() ? this->extract(__it) : node_type();
     }
+
+    // 以下集合运算把 __that 的节点直接挪过来或释放，不重新分配，结束后
+    // __that 为空。等价元素保留原有的
+    void set_union(set &&__that) { this->_M_set_union(__that); }
+
+    // 只保留在 __that 中也有的元素
+    void set_intersection(set &&__that) { this->_M_set_intersection(__that); }
+
+    // 去掉在 __that 中也有的元素
+    void set_difference(set &&__that) { this->_M_set_difference(__that); }
+
+    // 同 std::set::merge：键已存在的元素留在 __that 里
+    void merge(set &__that) { this->template _M_merge<true>(__that); }
+
+    void merge(set &&__that) { this->template _M_merge<true>(__that); }
+
+    // 以下并行操作的约束见 _RbTreeImpl::_S_fork_height
+
+    // 与 insert(__first, __last) 结果相同：已有的键不覆盖，区间内重复的
+    // 键保留先出现的
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(
+        std::random_access_iterator, _RandIt)>
+    void insert_bulk(_RandIt __first, _RandIt __last) {
+        this->template _M_parallel_insert<true>(__first, __last);
+    }
+
+    // 结果同 set_union
+    void union_with(set &&__that) {
+        this->_M_parallel_set_union(__that);
+    }
+
+    // 对每个元素调用 __f(_Tp const &)，不保证顺序
+    template <class _Fn> void for_each_parallel(_Fn &&__f) const {
+        auto __visit = [&__f](_Tp const &__value) { __f(__value); };
+        this->_M_parallel_for_each(__visit);
+    }
 };
 
 template <class _Tp, class _Compare = std::less<_Tp>,
-          class _Alloc = std::allocator<_Tp>>
-struct multi_set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
-    using typename _RbTreeImpl<_Tp const, _Compare, _Alloc>::const_iterator;
-    using typename _RbTreeImpl<_Tp const, _Compare, _Alloc>::node_type;
+          class _Alloc = std::allocator<_Tp>,
+          class _TreeTag = _RbTreeNoAugment>
+struct multi_set
+    : _TreeImplSelect<_Tp const, _Compare, _Alloc, _TreeTag>::type {
+  private:
+    using _Impl =
+        typename _TreeImplSelect<_Tp const, _Compare, _Alloc, _TreeTag>::type;
+
+  public:
+    using typename _Impl::const_iterator;
+    using typename _Impl::node_type;
     using iterator = const_iterator;
+    // 连续查找相近的元素时用游标，见 _TreeCursor
+    using cursor = _TreeCursor<_Impl const, const_iterator, _Tp>;
+    using const_cursor = cursor;
     using value_type = _Tp;
     using size_type = std::size_t;
     using difference_type = std::ptrdiff_t;
 
     multi_set() = default;
 
-    explicit multi_set(_Compare __comp)
-        : _RbTreeImpl<_Tp const, _Compare, _Alloc>(__comp) {}
+    explicit multi_set(_Compare __comp) : _Impl(__comp) {}
 
-    multi_set(multi_set &&) = default;
-    multi_set &operator=(multi_set &&) = default;
-
-    multi_set(multi_set const &__that)
-        : _RbTreeImpl<_Tp const, _Compare, _Alloc>() {
-        this->_M_multi_insert(__that.begin(), __that.end());
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    explicit multi_set(_InputIt __first, _InputIt __last,
+                       _Compare __comp = _Compare())
+        : _Impl(__comp) {
+        this->_M_multi_insert(__first, __last);
     }
 
-    multi_set &operator=(multi_set const &__that) {
-        if (&__that != this) {
-            this->assign(__that.begin(), __that.end());
-        }
-        return *this;
+    // 区间非递减，线性时间建树
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    multi_set(sorted_equivalent_t, _InputIt __first, _InputIt __last,
+              _Compare __comp = _Compare())
+        : _Impl(__comp) {
+        this->_M_multi_insert(__first, __last, true);
     }
 
+    multi_set(multi_set &&) = default;
+    multi_set &operator=(multi_set &&) = default;
+
+    multi_set(multi_set const &) = default;
+    multi_set &operator=(multi_set const &) = default;
+
     multi_set &operator=(std::initializer_list<_Tp> __ilist) {
         this->assign(__ilist);
         return *this;
@@ -178,7 +317,7 @@ struct multi_set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
 
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
-    const_iterator find(_Tp &&__value) const noexcept {
+    const_iterator find(_Tv &&__value) const noexcept {
         return this->_M_find(__value);
     }
 
@@ -186,6 +325,25 @@ struct multi_set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
         return this->_M_find(__value);
     }
 
+    // 以 __finger 为起点查找，见 _RbTreeImpl::_M_finger_bound
+    const_iterator find(const_iterator __finger,
+                        _Tp const &__value) const noexcept {
+        return this->_M_finger_find(__finger, __value);
+    }
+
+    using _Impl::lower_bound;
+    using _Impl::upper_bound;
+
+    const_iterator lower_bound(const_iterator __finger,
+                               _Tp const &__value) const noexcept {
+        return this->template _M_finger_bound<false>(__finger, __value);
+    }
+
+    const_iterator upper_bound(const_iterator __finger,
+                               _Tp const &__value) const noexcept {
+        return this->template _M_finger_bound<true>(__finger, __value);
+    }
+
     iterator insert(_Tp &&__value) {
         return this->_M_multi_emplace(std::move(__value));
     }
@@ -198,22 +356,42 @@ struct multi_set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
         return this->_M_multi_emplace(std::forward<_Ts>(__value)...);
     }
 
+    template <class... _Ts>
+    iterator emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        return this->_M_multi_emplace_hint(__hint,
+                                           std::forward<_Ts>(__value)...);
+    }
+
+    iterator insert(const_iterator __hint, _Tp &&__value) {
+        return this->_M_multi_emplace_hint(__hint, std::move(__value));
+    }
+
+    iterator insert(const_iterator __hint, _Tp const &__value) {
+        return this->_M_multi_emplace_hint(__hint, __value);
+    }
+
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     void insert(_InputIt __first, _InputIt __last) {
-        return this->_M_multi_insert(__first, __last);
+        this->_M_multi_insert(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(sorted_equivalent_t, _InputIt __first, _InputIt __last) {
+        this->_M_multi_insert(__first, __last, true);
     }
 
-    using _RbTreeImpl<_Tp const, _Compare, _Alloc>::assign;
+    using _Impl::assign;
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     void assign(_InputIt __first, _InputIt __last) {
         this->clear();
-        return this->_M_multi_insert(__first, __last);
+        this->_M_multi_insert(__first, __last);
     }
 
-    using _RbTreeImpl<_Tp const, _Compare, _Alloc>::erase;
+    using _Impl::erase;
 
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
@@ -245,6 +423,35 @@ struct multi_set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
         return this->_M_contains(__value);
     }
 
+    // 依次把每个键的 find 结果写入 __out，见 _RbTreeBase::_M_find_nodes
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) {
+        return this->_M_find_many(__first, __last, __out);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt find_many(_KeyIt __first, _KeyIt __last, _OutIt __out) const {
+        return this->_M_find_many(__first, __last, __out);
+    }
+
+    // 同 find_many，写入的是 contains 的结果
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::forward_iterator,
+                                                     _KeyIt),
+              class _OutIt>
+    _OutIt contains_many(_KeyIt __first, _KeyIt __last, _OutIt __out) const {
+        return this->_M_contains_many(__first, __last, __out);
+    }
+
+    iterator insert(node_type __nh) {
+        return this->_M_multi_insert_handle(std::move(__nh));
+    }
+
+    using _Impl::extract;
+
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     node_type extract(_Tv &&__value) {
@@ -256,8 +463,49 @@ struct multi_set : _RbTreeImpl<_Tp const, _Compare, _Alloc> {
         iterator __it = this->_M_find(__value);
         return __it != this->end() ? this->extract(__it) : node_type();
     }
+
+    // 把 __that 的节点全部挪过来，不重新分配，等价元素排在原有的之后
+    void merge(multi_set &__that) { this->template _M_merge<false>(__that); }
+
+    void merge(multi_set &&__that) { this->template _M_merge<false>(__that); }
+
+    // 以下并行操作的约束见 _RbTreeImpl::_S_fork_height
+
+    // 与 insert(__first, __last) 结果相同，等价元素排在已有的之后
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(
+        std::random_access_iterator, _RandIt)>
+    void insert_bulk(_RandIt __first, _RandIt __last) {
+        this->template _M_parallel_insert<false>(__first, __last);
+    }
+
+    // 对每个元素调用 __f(_Tp const &)，不保证顺序
+    template <class _Fn> void for_each_parallel(_Fn &&__f) const {
+        auto __visit = [&__f](_Tp const &__value) { __f(__value); };
+        this->_M_parallel_for_each(__visit);
+    }
 };
 
+// 附带子树大小的集合：nth、rank、count_range 和 size 都是 O(log n)
+// 或更快，代价是每个节点多一个 size_t，插入删除时多维护一条路径
+template <class _Tp, class _Compare = std::less<_Tp>,
+          class _Alloc = std::allocator<_Tp>>
+using ranked_set = set<_Tp, _Compare, _Alloc, _RbTreeSizeAugment>;
+
+template <class _Tp, class _Compare = std::less<_Tp>,
+          class _Alloc = std::allocator<_Tp>>
+using ranked_multi_set = multi_set<_Tp, _Compare, _Alloc, _RbTreeSizeAugment>;
+
+// 自定义增强：_Policy 见 _RbTreePolicyAugment，查询从 root_node() 开始
+template <class _Tp, class _Policy, class _Compare = std::less<_Tp>,
+          class _Alloc = std::allocator<_Tp>>
+using augmented_set =
+    set<_Tp, _Compare, _Alloc, _RbTreePolicyAugment<_Tp const, _Policy>>;
+
+template <class _Tp, class _Policy, class _Compare = std::less<_Tp>,
+          class _Alloc = std::allocator<_Tp>>
+using augmented_multi_set =
+    multi_set<_Tp, _Compare, _Alloc, _RbTreePolicyAugment<_Tp const, _Policy>>;
+
 } // namespace mstl
 
 #endif // !__SET__
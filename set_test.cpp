@@ -1,6 +1,11 @@
 #include "set.hpp"
+#include <atomic>
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
 
 int main() {
     mstl::multi_set<int> table;
@@ -43,4 +48,125 @@ int main() {
     for (int i : s) {
         printf("%d\n", i);
     }
+    int sorted[] = {1, 1, 2, 3, 3, 3, 8};
+    mstl::multi_set<int> bulk(mstl::sorted_equivalent, sorted, sorted + 7);
+    mstl::set<int> dedup(sorted, sorted + 7); // 有重复，逐个插入去重
+    printf("bulk count(3) = %zd, dedup size = %zd\n", bulk.count(3),
+           dedup.size());
+    // 按递增顺序追加时用 end() 作提示
+    auto hint = dedup.end();
+    for (int i = 10; i < 15; i++) {
+        hint = dedup.emplace_hint(dedup.end(), i);
+    }
+    printf("last hinted = %d, size = %zd\n", *hint, dedup.size());
+    // 提示在插入值之前时，插在等价区间的最前面，和 std::multiset 一致
+    int dups[] = {0, 1, 1, 2, 2, 3};
+    mstl::multi_set<int> hinted(mstl::sorted_equivalent, dups, dups + 6);
+    auto pos = hinted.insert(std::next(hinted.begin()), 2);
+    printf("hinted insert at %td\n", std::distance(hinted.begin(), pos));
+    // 拷贝赋值复用目标已有的节点：目标比来源大、小或为空
+    auto dump = [](char const *name, mstl::set<std::string> const &strs) {
+        printf("%s:", name);
+        for (auto const &str : strs) {
+            printf(" %s", str.c_str());
+        }
+        printf(" |");
+        for (auto rit = strs.rbegin(); rit != strs.rend(); ++rit) {
+            printf(" %s", rit->c_str());
+        }
+        printf("\n");
+    };
+    mstl::set<std::string> few, many, none;
+    for (int i = 0; i < 3; i++) {
+        few.insert(std::string(i + 1, char('a' + i)));
+    }
+    for (int i = 0; i < 8; i++) {
+        many.insert(std::string(2, char('p' + i)));
+    }
+    mstl::set<std::string> larger = many, smaller = few;
+    larger = few;
+    smaller = many;
+    none = few;
+    dump("larger = few", larger);
+    dump("smaller = many", smaller);
+    dump("none = few", none);
+    // 带子树大小的集合：按名次取元素和区间计数都不需要遍历
+    mstl::ranked_set<int> latency;
+    for (int i = 1; i <= 100; i++) {
+        latency.insert(i * 10);
+    }
+    printf("p50 = %d, p99 = %d\n", *latency.nth(latency.size() / 2),
+           *latency.nth(latency.size() * 99 / 100));
+    printf("rank(255) = %zd, count_range(100, 200) = %zd\n",
+           latency.rank(255), latency.count_range(100, 200));
+    // 集合运算直接挪动参数的节点，结束后参数为空
+    int digits[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int even_digits[] = {0, 2, 4, 6, 8}, odd_digits[] = {1, 3, 5};
+    mstl::set<int> evens(even_digits, even_digits + 5);
+    mstl::set<int> odds(odd_digits, odd_digits + 3);
+    mstl::set<int> low(digits, digits + 4);
+    evens.set_union(std::move(odds));
+    printf("union size = %zd, odds empty = %d\n", evens.size(),
+           odds.empty()); // 8, 1
+    evens.set_intersection(mstl::set<int>(low));
+    printf("intersection size = %zd\n", evens.size()); // 4
+    low.set_difference(mstl::set<int>(digits + 1, digits + 3));
+    for (int i : low) {
+        printf("difference %d\n", i); // 0 3
+    }
+    mstl::set<int> src(digits + 3, digits + 4);
+    src.insert(9);
+    low.merge(src); // 3 已存在，留在 src 里
+    printf("merged size = %zd, left in src = %d\n", low.size(), *src.begin());
+    // 大批量建树按区间拆开并行进行，遍历时不保证顺序
+    std::vector<int> batch;
+    for (int i = 0; i < 10000; i++) {
+        batch.push_back(i * 7 % 5000);
+    }
+    mstl::set<int> bulk_set;
+    bulk_set.insert_bulk(batch.begin(), batch.end());
+    std::atomic<long> total{0};
+    bulk_set.for_each_parallel([&total](int i) { total += i; });
+    printf("bulk size = %zd, total = %ld\n", bulk_set.size(),
+           total.load()); // 5000, 12497500
+    // 键一个挨着一个时，以上次的结果为起点查找
+    auto finger = bulk_set.end();
+    for (int key : {100, 101, 103, 4999, 6000}) {
+        finger = bulk_set.lower_bound(finger, key);
+        printf("lower_bound(%d) = %d\n", key,
+               finger != bulk_set.end() ? *finger : -1); // -1 表示 end()
+    }
+    // 随机的 finger 和 cursor 查到的应当与从根查找一致；multi_set 里从根
+    // find 可能停在任一个相等元素上，只比较是否找到
+    mstl::multi_set<int> spread;
+    for (int i = 0; i < 3000; i++) {
+        spread.insert(rand() % 2000 * 2);
+    }
+    mstl::set<int>::cursor cursor(bulk_set);
+    mstl::multi_set<int>::cursor spread_cursor(spread);
+    int mismatches = 0;
+    for (int i = 0; i < 20000; i++) {
+        int key = rand() % 8100 - 50;
+        auto from = std::next(bulk_set.begin(), rand() % 5000);
+        auto lower = bulk_set.lower_bound(key);
+        auto upper = bulk_set.upper_bound(key);
+        mismatches += bulk_set.lower_bound(from, key) != lower;
+        mismatches += bulk_set.upper_bound(from, key) != upper;
+        mismatches += bulk_set.find(from, key) != bulk_set.find(key);
+        mismatches += cursor.lower_bound(key) != lower;
+        mismatches += cursor.upper_bound(key) != upper;
+        mismatches += cursor.find(key) != bulk_set.find(key);
+        auto spread_from = std::next(spread.begin(), rand() % 3000);
+        auto spread_lower = spread.lower_bound(key);
+        auto spread_upper = spread.upper_bound(key);
+        bool spread_found = spread.find(key) != spread.end();
+        mismatches += spread.lower_bound(spread_from, key) != spread_lower;
+        mismatches += spread.upper_bound(spread_from, key) != spread_upper;
+        mismatches +=
+            (spread.find(spread_from, key) != spread.end()) != spread_found;
+        mismatches += spread_cursor.lower_bound(key) != spread_lower;
+        mismatches += spread_cursor.upper_bound(key) != spread_upper;
+        mismatches += (spread_cursor.find(key) != spread.end()) != spread_found;
+    }
+    printf("finger/cursor mismatches = %d\n", mismatches); // 0
 }
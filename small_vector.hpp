@@ -0,0 +1,529 @@
+#ifndef __SMALL_VECTOR__
+#define __SMALL_VECTOR__
+
+#include "_common.hpp"
+#include "_relocate.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace mstl {
+
+// 前 N 个元素存放在对象内部的缓冲区中，超过 N 个才向 Alloc 申请堆内存
+// 接口与 mstl::vector 保持一致，可以直接替换
+template <typename T, std::size_t N, typename Alloc = std::allocator<T>>
+class small_vector {
+    static_assert(N > 0, "small_vector requires N > 0");
+
+  public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using diff_type = std::ptrdiff_t;
+    using ptr = T *;
+    using const_ptr = T const *;
+    using ref = T &;
+    using const_ref = T const &;
+    using it = T *;
+    using const_it = T const *;
+    using rev_it = std::reverse_iterator<T *>;
+    using const_rev_it = std::reverse_iterator<T const *>;
+
+    static constexpr std::size_t inline_capacity = N;
+
+  private:
+    T *m_data;
+    std::size_t m_size;
+    std::size_t m_cap;
+    [[no_unique_address]] Alloc m_alloc;
+    union {
+        T m_buf[N];
+    }; // union 阻止元素的自动构造，由 m_size 决定哪些槽位是活的
+
+    template <typename... Args> void construct_at(T *ptr, Args &&...args) {
+#if __cpp_lib_constexpr_dynamic_alloc >= 201907L
+        std::construct_at(ptr, std::forward<Args>(args)...);
+#else
+        new (ptr) T(std::forward<Args>(args)...);
+#endif
+    }
+
+    void destroy_at(T *ptr) noexcept {
+#if __cpp_lib_constexpr_dynamic_alloc >= 201907L
+        std::destroy_at(ptr);
+#else
+        ptr->~T();
+#endif
+    }
+
+    bool is_inline() const noexcept { return m_data == m_buf; }
+
+    void reset_inline() noexcept {
+        m_data = m_buf;
+        m_size = 0;
+        m_cap = N;
+    }
+
+    // 把 [src, src + n) 搬迁到不重叠的未初始化内存 dest
+    void relocate_n(T *src, size_t n, T *dest) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            trivially_relocate(src, src + n, dest);
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                construct_at(&dest[i], std::move_if_noexcept(src[i]));
+            }
+            for (size_t i = 0; i < n; i++) {
+                destroy_at(&src[i]);
+            }
+        }
+    }
+
+    // 把 [j, m_size) 整体后移 n 位，为插入腾出 [j, j + n) 的未初始化空间
+    void open_gap(size_t j, size_t n) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            trivially_relocate(m_data + j, m_data + m_size, m_data + j + n);
+        } else {
+            for (size_t i = m_size; i > j; i--) {
+                construct_at(&m_data[i + n - 1], std::move(m_data[i - 1]));
+                destroy_at(&m_data[i - 1]);
+            }
+        }
+    }
+
+    void destroy_all() noexcept {
+        for (size_t i = 0; i < m_size; i++) {
+            destroy_at(&m_data[i]);
+        }
+        if (!is_inline()) {
+            m_alloc.deallocate(m_data, m_cap);
+        }
+    }
+
+    // 接管 that 的元素：堆上的直接偷指针，内联的逐个搬迁
+    void steal(small_vector &that) {
+        if (that.is_inline()) {
+            reset_inline();
+            relocate_n(that.m_data, that.m_size, m_data);
+            m_size = that.m_size;
+        } else {
+            m_data = that.m_data;
+            m_size = that.m_size;
+            m_cap = that.m_cap;
+        }
+        that.reset_inline();
+    }
+
+    // 构造函数
+  public:
+    small_vector() noexcept { reset_inline(); }
+
+    explicit small_vector(const Alloc &allocator) noexcept
+        : m_alloc(allocator) {
+        reset_inline();
+    }
+
+    small_vector(std::initializer_list<T> ilist,
+                 const Alloc &allocator = Alloc())
+        : small_vector(ilist.begin(), ilist.end(), allocator) {}
+
+    explicit small_vector(std::size_t n, const Alloc &allocator = Alloc())
+        : m_alloc(allocator) {
+        reset_inline();
+        reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            construct_at(&m_data[i]);
+        }
+        m_size = n;
+    }
+
+    small_vector(std::size_t n, const T &init_val,
+                 const Alloc &allocator = Alloc())
+        : m_alloc(allocator) {
+        reset_inline();
+        reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            construct_at(&m_data[i], init_val);
+        }
+        m_size = n;
+    }
+
+    template <
+        _LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::random_access_iterator, It)>
+    small_vector(It first, It last, const Alloc &allocator = Alloc())
+        : m_alloc(allocator) {
+        reset_inline();
+        size_t n = last - first;
+        reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            construct_at(&m_data[i], *first);
+            ++first;
+        }
+        m_size = n;
+    }
+
+    ~small_vector() noexcept { destroy_all(); }
+
+    // 深浅拷贝
+  public:
+    small_vector(small_vector &&that) noexcept(
+        std::is_nothrow_move_constructible_v<T>)
+        : m_alloc(std::move(that.m_alloc)) {
+        steal(that);
+    }
+
+    small_vector(small_vector &&that, const Alloc &allocate) noexcept(
+        std::is_nothrow_move_constructible_v<T>)
+        : m_alloc(allocate) {
+        steal(that);
+    }
+
+    small_vector &operator=(small_vector &&that) noexcept(
+        std::is_nothrow_move_constructible_v<T>) {
+        if (&that == this) [[unlikely]]
+            return *this;
+
+        destroy_all();
+        steal(that);
+        return *this;
+    }
+
+    void swap(small_vector &that) {
+        small_vector tmp(std::move(*this));
+        *this = std::move(that);
+        that = std::move(tmp);
+    }
+
+    small_vector(const small_vector &that) : m_alloc(that.m_alloc) {
+        reset_inline();
+        reserve(that.m_size);
+        for (size_t i = 0; i < that.m_size; i++) {
+            construct_at(&m_data[i], std::as_const(that.m_data[i]));
+        }
+        m_size = that.m_size;
+    }
+
+    small_vector(const small_vector &that, const Alloc &allocate)
+        : m_alloc(allocate) {
+        reset_inline();
+        reserve(that.m_size);
+        for (size_t i = 0; i < that.m_size; i++) {
+            construct_at(&m_data[i], std::as_const(that.m_data[i]));
+        }
+        m_size = that.m_size;
+    }
+
+    small_vector &operator=(const small_vector &that) {
+        if (&that == this) [[unlikely]]
+            return *this;
+
+        assign(that.begin(), that.end());
+        return *this;
+    }
+
+    // 内存管理
+  public:
+    void clear() noexcept {
+        for (size_t i = 0; i < m_size; i++) {
+            destroy_at(&m_data[i]);
+        }
+        m_size = 0;
+    }
+
+    void resize(size_t n) {
+        if (n < m_size) {
+            for (size_t i = n; i < m_size; i++) {
+                destroy_at(&m_data[i]);
+            }
+        } else if (n > m_size) {
+            reserve(n);
+            for (size_t i = m_size; i < n; i++) {
+                construct_at(&m_data[i]);
+            }
+        }
+        m_size = n;
+    }
+
+    void resize(size_t n, const T &default_val) {
+        if (n < m_size) {
+            for (size_t i = n; i < m_size; i++) {
+                destroy_at(&m_data[i]);
+            }
+        } else if (n > m_size) {
+            reserve(n);
+            for (size_t i = m_size; i < n; i++) {
+                construct_at(&m_data[i], default_val);
+            }
+        }
+        m_size = n;
+    }
+
+    // 元素个数不超过 N 时搬回内联缓冲区并释放堆内存
+    void shrink_to_fit() {
+        if (is_inline() || m_size == m_cap)
+            return;
+
+        auto old_data = m_data;
+        auto old_cap = m_cap;
+        if (m_size <= N) {
+            m_data = m_buf;
+            m_cap = N;
+        } else {
+            m_data = m_alloc.allocate(m_size);
+            m_cap = m_size;
+        }
+        relocate_n(old_data, m_size, m_data);
+        m_alloc.deallocate(old_data, old_cap);
+    }
+
+    void reserve(size_t n) {
+        if (n <= m_cap)
+            return;
+
+        n = std::max(n, m_cap * 2);
+
+        auto old_data = m_data;
+        bool was_inline = is_inline();
+        auto old_cap = m_cap;
+
+        m_data = m_alloc.allocate(n);
+        m_cap = n;
+        relocate_n(old_data, m_size, m_data);
+        if (!was_inline) {
+            m_alloc.deallocate(old_data, old_cap);
+        }
+    }
+
+    std::size_t capacity() const noexcept { return m_cap; }
+    std::size_t size() const noexcept { return m_size; }
+    inline bool empty() const noexcept { return m_size == 0; }
+    static constexpr std::size_t max_size() noexcept {
+        return std::numeric_limits<std::size_t>::max() / sizeof(T);
+    }
+    Alloc get_allocator() const noexcept { return m_alloc; }
+
+    // 访问
+  public:
+    T &operator[](size_t i) noexcept { return m_data[i]; }
+    const T &operator[](size_t i) const noexcept { return m_data[i]; }
+
+    T &at(size_t i) {
+        if (i >= m_size) [[unlikely]]
+            _LIBPENGCXX_THROW_OUT_OF_RANGE(i, m_size);
+        return m_data[i];
+    }
+    const T &at(size_t i) const {
+        if (i >= m_size) [[unlikely]]
+            _LIBPENGCXX_THROW_OUT_OF_RANGE(i, m_size);
+        return m_data[i];
+    }
+
+    T &front() noexcept { return *m_data; }
+    const T &front() const noexcept { return *m_data; }
+
+    T &back() noexcept { return m_data[m_size - 1]; }
+    const T &back() const noexcept { return m_data[m_size - 1]; }
+
+    T *data() noexcept { return m_data; }
+    const T *data() const noexcept { return m_data; }
+    const T *cdata() const noexcept { return m_data; }
+
+    T *begin() noexcept { return m_data; }
+    const T *begin() const noexcept { return m_data; }
+    const T *cbegin() const noexcept { return m_data; }
+    T *end() noexcept { return m_data + m_size; }
+    const T *end() const noexcept { return m_data + m_size; }
+    const T *cend() const noexcept { return m_data + m_size; }
+
+    std::reverse_iterator<T *> rbegin() noexcept {
+        return std::make_reverse_iterator(m_data + m_size);
+    }
+
+    std::reverse_iterator<T *> rend() noexcept {
+        return std::make_reverse_iterator(m_data);
+    }
+
+    std::reverse_iterator<const T *> rbegin() const noexcept {
+        return std::make_reverse_iterator(m_data + m_size);
+    }
+
+    std::reverse_iterator<const T *> rend() const noexcept {
+        return std::make_reverse_iterator(m_data);
+    }
+
+    std::reverse_iterator<const T *> crbegin() const noexcept {
+        return std::make_reverse_iterator(m_data + m_size);
+    }
+
+    std::reverse_iterator<const T *> crend() const noexcept {
+        return std::make_reverse_iterator(m_data);
+    }
+
+    // 数据操作
+  public:
+    void push_back(const T &lval) {
+        if (m_size + 1 > m_cap) [[unlikely]]
+            reserve(m_size + 1);
+        construct_at(&m_data[m_size], lval);
+        ++m_size;
+    }
+
+    void push_back(T &&rval) {
+        if (m_size + 1 > m_cap) [[unlikely]]
+            reserve(m_size + 1);
+        construct_at(&m_data[m_size], std::move(rval));
+        ++m_size;
+    }
+
+    template <typename... Args> T &emplace_back(Args &&...args) {
+        if (m_size + 1 > m_cap) [[unlikely]]
+            reserve(m_size + 1);
+        T *addr = &m_data[m_size];
+        construct_at(addr, std::forward<Args>(args)...);
+        ++m_size;
+        return *addr;
+    }
+
+    template <typename... Args> T *emplace(const T *it, Args &&...args) {
+        size_t j = it - m_data;
+        reserve(m_size + 1);
+        open_gap(j, 1);
+        ++m_size;
+        construct_at(&m_data[j], std::forward<Args>(args)...);
+        return m_data + j;
+    }
+
+    T *insert(const T *it, T &&val) {
+        size_t j = it - m_data;
+        reserve(m_size + 1);
+        open_gap(j, 1);
+        ++m_size;
+        construct_at(&m_data[j], std::move(val));
+        return m_data + j;
+    }
+
+    T *insert(const T *it, size_t n, const T &val) {
+        size_t j = it - m_data;
+        if (n == 0) [[unlikely]]
+            return const_cast<T *>(it);
+        reserve(m_size + n);
+        open_gap(j, n);
+        m_size += n;
+        for (size_t i = j; i < j + n; i++) {
+            construct_at(&m_data[i], val);
+        }
+        return m_data + j;
+    }
+
+    template <
+        _LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::random_access_iterator, It)>
+    T *insert(const T *it, It first, It last) {
+        size_t j = it - m_data;
+        size_t n = last - first;
+        if (n == 0) [[unlikely]]
+            return const_cast<T *>(it);
+        reserve(m_size + n);
+        open_gap(j, n);
+        m_size += n;
+        for (size_t i = j; i < j + n; i++) {
+            construct_at(&m_data[i], *first);
+            ++first;
+        }
+        return m_data + j;
+    }
+
+    T *insert(const T *it, std::initializer_list<T> ilist) {
+        return insert(it, ilist.begin(), ilist.end());
+    }
+
+    void pop_back() noexcept {
+        --m_size;
+        destroy_at(&m_data[m_size]);
+    }
+
+    T *erase(const T *it) noexcept(is_trivially_relocatable_v<T> ||
+                                   std::is_nothrow_move_assignable_v<T>) {
+        size_t i = it - m_data;
+        if constexpr (is_trivially_relocatable_v<T>) {
+            destroy_at(&m_data[i]);
+            trivially_relocate(m_data + i + 1, m_data + m_size, m_data + i);
+            --m_size;
+        } else {
+            for (size_t j = i + 1; j < m_size; j++) {
+                m_data[j - 1] = std::move(m_data[j]);
+            }
+            --m_size;
+            destroy_at(&m_data[m_size]);
+        }
+        return const_cast<T *>(it);
+    }
+
+    T *erase(T *first, T *last) noexcept(is_trivially_relocatable_v<T> ||
+                                         std::is_nothrow_move_assignable_v<T>) {
+        if (first == last) {
+            return first;
+        }
+        size_t diff = last - first;
+        if constexpr (is_trivially_relocatable_v<T>) {
+            for (T *p = first; p != last; ++p) {
+                destroy_at(p);
+            }
+            trivially_relocate(last, m_data + m_size, first);
+            m_size -= diff;
+        } else {
+            for (size_t j = last - m_data; j < m_size; j++) {
+                m_data[j - diff] = std::move(m_data[j]);
+            }
+            m_size -= diff;
+            for (size_t j = m_size; j < m_size + diff; j++) {
+                destroy_at(&m_data[j]);
+            }
+        }
+        return const_cast<T *>(first);
+    }
+
+    // 内存分配
+  public:
+    void assign(size_t n, const T &default_val) {
+        clear();
+        reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            construct_at(&m_data[i], default_val);
+        }
+        m_size = n;
+    }
+
+    template <
+        _LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::random_access_iterator, It)>
+    void assign(It first, It last) {
+        clear();
+        size_t n = last - first;
+        reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            construct_at(&m_data[i], *first);
+            ++first;
+        }
+        m_size = n;
+    }
+
+    void assign(std::initializer_list<T> ilist) {
+        assign(ilist.begin(), ilist.end());
+    }
+
+    small_vector &operator=(std::initializer_list<T> ilist) {
+        assign(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    // 比较函数
+  public:
+    _LIBPENGCXX_DEFINE_COMPARISON(small_vector);
+};
+
+} // namespace mstl
+
+#endif // !__SMALL_VECTOR__
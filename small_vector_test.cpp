@@ -0,0 +1,41 @@
+#include "small_vector.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+int main() {
+    mstl::small_vector<int, 4> arr;
+    for (int i = 0; i < 10; i++) {
+        arr.push_back(i);
+        // 前 4 个元素在内联缓冲区中，之后才申请堆内存
+        printf("arr.push_back(%d) size=%zd cap=%zd\n", i, arr.size(),
+               arr.capacity());
+    }
+    arr.insert(arr.begin() + 3, {40, 41, 42});
+    arr.erase(arr.begin() + 1, arr.begin() + 3);
+    for (size_t i = 0; i < arr.size(); i++) {
+        printf("arr[%zd] = %d\n", i, arr[i]);
+    }
+
+    arr.resize(3);
+    arr.shrink_to_fit();
+    printf("after shrink: size=%zd cap=%zd\n", arr.size(), arr.capacity());
+
+    mstl::small_vector<std::string, 2> strs{"a", "b"};
+    mstl::small_vector<std::string, 2> moved = std::move(strs);
+    moved.emplace(moved.begin(), "x");
+    mstl::small_vector<std::string, 2> copied = moved;
+    printf("moved == copied: %d\n", moved == copied);
+    copied.pop_back();
+    printf("moved > copied: %d\n", moved > copied);
+    copied.swap(moved);
+    // 空区间不应移动任何元素
+    copied.emplace_back(32, 'c');
+    copied.erase(copied.begin(), copied.begin());
+    for (size_t i = 0; i < copied.size(); i++) {
+        printf("copied[%zd] = %s\n", i, copied[i].c_str());
+    }
+    printf("strs.size() = %zd\n", strs.size());
+    printf("sizeof(small_vector<int, 4>) = %zd\n",
+           sizeof(mstl::small_vector<int, 4>));
+}
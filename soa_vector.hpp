@@ -0,0 +1,600 @@
+#ifndef __SOA_VECTOR__
+#define __SOA_VECTOR__
+
+/*
+
+ -- 按列存储的动态数组（structure of arrays）--
+
+ soa_vector<Ts...> 的每一行是一个 std::tuple<Ts...>，但每一列单独连续存放：
+ 只扫描其中一两个字段的循环不会把其他字段也拉进缓存行。
+ 所有列共用一次分配：容量为 cap 时块内依次是 cap 个 T0、cap 个 T1……，
+ 每一列按自身对齐。扩容与 vector::reserve 相同，由 Growth 策略决定新容量。
+
+ column<I>() 返回第 I 列的 std::span；operator[] 和迭代器产生引用元组
+ std::tuple<Ts &...>，可以直接用结构化绑定：
+   for (auto [id, x, y] : points) { ... }
+
+*/
+
+#include "_common.hpp"
+#include "_growth.hpp"
+#include "_relocate.hpp"
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace mstl {
+
+template <typename Alloc, typename Growth, typename... Ts>
+class basic_soa_vector {
+    static_assert(sizeof...(Ts) != 0, "soa_vector needs at least one column");
+
+  public:
+    using value_type = std::tuple<Ts...>;
+    using reference = std::tuple<Ts &...>;
+    using const_reference = std::tuple<Ts const &...>;
+    using allocator_type = Alloc;
+    using growth_policy = Growth;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    template <std::size_t I>
+    using column_type = std::tuple_element_t<I, value_type>;
+
+    static constexpr std::size_t columns = sizeof...(Ts);
+
+  private:
+    using Index = std::index_sequence_for<Ts...>;
+    using Offsets = std::array<std::size_t, sizeof...(Ts)>;
+
+    static constexpr std::size_t block_align = std::max({alignof(Ts)...});
+    static constexpr std::size_t row_bytes = (sizeof(Ts) + ...);
+
+    // 整块内存以 block_unit 为单位分配，保证满足所有列的对齐
+    struct alignas(block_align) block_unit {
+        std::byte bytes[block_align];
+    };
+
+    using BlockAlloc = typename std::allocator_traits<
+        Alloc>::template rebind_alloc<block_unit>;
+
+    // 第 0 列总是位于块首，因此 std::get<0>(m_cols) 同时也是块地址
+    std::tuple<Ts *...> m_cols;
+    std::size_t m_size;
+    std::size_t m_cap;
+    [[no_unique_address]] BlockAlloc m_alloc;
+
+    template <typename T, typename... Args>
+    static void construct_at(T *ptr, Args &&...args) {
+#if __cpp_lib_constexpr_dynamic_alloc >= 201907L
+        std::construct_at(ptr, std::forward<Args>(args)...);
+#else
+        new (ptr) T(std::forward<Args>(args)...);
+#endif
+    }
+
+    template <typename T> static void destroy_at(T *ptr) noexcept {
+#if __cpp_lib_constexpr_dynamic_alloc >= 201907L
+        std::destroy_at(ptr);
+#else
+        ptr->~T();
+#endif
+    }
+
+    template <typename F, std::size_t... Is>
+    static void for_each_column(F &&f, std::index_sequence<Is...>) {
+        (f(std::integral_constant<std::size_t, Is>()), ...);
+    }
+
+    template <typename F> static void for_each_column(F &&f) {
+        for_each_column(f, Index());
+    }
+
+    // 容量为 cap 时各列在块内的字节偏移，返回整块所需的 block_unit 个数
+    static std::size_t layout(std::size_t cap, Offsets &offsets) noexcept {
+        std::size_t bytes = 0;
+        std::size_t k = 0;
+        ((bytes = (bytes + alignof(Ts) - 1) / alignof(Ts) * alignof(Ts),
+          offsets[k++] = bytes, bytes += cap * sizeof(Ts)),
+         ...);
+        return (bytes + block_align - 1) / block_align;
+    }
+
+    static std::size_t block_units(std::size_t cap) noexcept {
+        Offsets offsets;
+        return layout(cap, offsets);
+    }
+
+    template <std::size_t... Is>
+    static std::tuple<Ts *...>
+    split_block(std::byte *base, Offsets const &offsets,
+                std::index_sequence<Is...>) noexcept {
+        return std::tuple<Ts *...>(
+            reinterpret_cast<Ts *>(base + offsets[Is])...);
+    }
+
+    std::tuple<Ts *...> allocate_columns(std::size_t cap) {
+        if (cap == 0)
+            return std::tuple<Ts *...>();
+        Offsets offsets;
+        std::size_t units = layout(cap, offsets);
+        auto base = reinterpret_cast<std::byte *>(m_alloc.allocate(units));
+        return split_block(base, offsets, Index());
+    }
+
+    void deallocate_columns(std::tuple<Ts *...> const &cols,
+                            std::size_t cap) noexcept {
+        if (cap != 0) {
+            auto block = reinterpret_cast<block_unit *>(std::get<0>(cols));
+            m_alloc.deallocate(block, block_units(cap));
+        }
+    }
+
+    // 把 m_size 行整体搬到容量为 cap 的新块
+    void reallocate_columns(std::size_t cap) {
+        auto cols = allocate_columns(cap);
+        for_each_column([&](auto I) {
+            using T = column_type<I>;
+            T *src = std::get<I>(m_cols);
+            T *dst = std::get<I>(cols);
+            if constexpr (is_trivially_relocatable_v<T>) {
+                trivially_relocate(src, src + m_size, dst);
+            } else {
+                for (std::size_t i = 0; i < m_size; i++) {
+                    construct_at(&dst[i], std::move_if_noexcept(src[i]));
+                    destroy_at(&src[i]);
+                }
+            }
+        });
+        deallocate_columns(m_cols, m_cap);
+        m_cols = cols;
+        m_cap = cap;
+    }
+
+    void destroy_rows(std::size_t first, std::size_t last) noexcept {
+        for_each_column([&](auto I) {
+            using T = column_type<I>;
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                T *col = std::get<I>(m_cols);
+                for (std::size_t i = first; i < last; i++) {
+                    destroy_at(&col[i]);
+                }
+            }
+        });
+    }
+
+    // 逐列构造第 i 行，某一列抛出异常时销毁该行已构造的列
+    template <std::size_t... Is, typename... Args>
+    void construct_row(std::size_t i, std::index_sequence<Is...>,
+                       Args &&...args) {
+        std::size_t built = 0;
+        try {
+            ((construct_at(std::get<Is>(m_cols) + i,
+                           std::forward<Args>(args)),
+              ++built),
+             ...);
+        } catch (...) {
+            for_each_column([&](auto I) {
+                if (I < built) {
+                    destroy_at(std::get<I>(m_cols) + i);
+                }
+            });
+            throw;
+        }
+    }
+
+    template <std::size_t... Is>
+    reference row(std::size_t i, std::index_sequence<Is...>) noexcept {
+        return reference(std::get<Is>(m_cols)[i]...);
+    }
+
+    template <std::size_t... Is>
+    const_reference row(std::size_t i,
+                        std::index_sequence<Is...>) const noexcept {
+        return const_reference(std::get<Is>(m_cols)[i]...);
+    }
+
+    // 迭代器直接保存各列指针，解引用时不必再经过容器
+  public:
+    template <bool Const> class basic_iterator {
+        using Cols = std::conditional_t<Const, std::tuple<Ts const *...>,
+                                        std::tuple<Ts *...>>;
+
+        Cols m_cols;
+        std::size_t m_index;
+
+        friend class basic_soa_vector;
+        template <bool> friend class basic_iterator;
+
+        basic_iterator(Cols const &cols, std::size_t index) noexcept
+            : m_cols(cols), m_index(index) {}
+
+      public:
+        // 解引用得到的是引用元组（代理），按 C++20 的惯例只在
+        // iterator_concept 中声明随机访问
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::tuple<Ts...>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, std::tuple<Ts const &...>,
+                                             std::tuple<Ts &...>>;
+
+        basic_iterator() noexcept : m_cols(), m_index(0) {}
+
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(basic_iterator<false> const &that) noexcept
+            : m_cols(that.m_cols), m_index(that.m_index) {}
+
+        reference operator*() const noexcept {
+            return std::apply(
+                [i = m_index](auto *...cols) { return reference(cols[i]...); },
+                m_cols);
+        }
+        reference operator[](difference_type n) const noexcept {
+            return *(*this + n);
+        }
+
+        basic_iterator &operator++() noexcept {
+            ++m_index;
+            return *this;
+        }
+        basic_iterator &operator--() noexcept {
+            --m_index;
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept {
+            basic_iterator tmp = *this;
+            ++m_index;
+            return tmp;
+        }
+        basic_iterator operator--(int) noexcept {
+            basic_iterator tmp = *this;
+            --m_index;
+            return tmp;
+        }
+
+        basic_iterator &operator+=(difference_type n) noexcept {
+            m_index += n;
+            return *this;
+        }
+        basic_iterator &operator-=(difference_type n) noexcept {
+            m_index -= n;
+            return *this;
+        }
+        basic_iterator operator+(difference_type n) const noexcept {
+            return basic_iterator(m_cols, m_index + n);
+        }
+        friend basic_iterator operator+(difference_type n,
+                                        basic_iterator const &it) noexcept {
+            return it + n;
+        }
+        basic_iterator operator-(difference_type n) const noexcept {
+            return basic_iterator(m_cols, m_index - n);
+        }
+        difference_type operator-(basic_iterator const &that) const noexcept {
+            return difference_type(m_index) - difference_type(that.m_index);
+        }
+
+        bool operator==(basic_iterator const &that) const noexcept {
+            return m_index == that.m_index;
+        }
+        auto operator<=>(basic_iterator const &that) const noexcept {
+            return m_index <=> that.m_index;
+        }
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // 构造函数
+  public:
+    basic_soa_vector() noexcept : m_cols(), m_size(0), m_cap(0) {}
+
+    explicit basic_soa_vector(const Alloc &allocator) noexcept
+        : m_cols(), m_size(0), m_cap(0), m_alloc(allocator) {}
+
+    explicit basic_soa_vector(std::size_t n, const Alloc &allocator = Alloc())
+        : basic_soa_vector(allocator) {
+        resize(n);
+    }
+
+    basic_soa_vector(std::size_t n, const value_type &init_val,
+                     const Alloc &allocator = Alloc())
+        : basic_soa_vector(allocator) {
+        resize(n, init_val);
+    }
+
+    basic_soa_vector(std::initializer_list<value_type> ilist,
+                     const Alloc &allocator = Alloc())
+        : basic_soa_vector(allocator) {
+        reserve(ilist.size());
+        for (auto const &val : ilist) {
+            push_back(val);
+        }
+    }
+
+    ~basic_soa_vector() noexcept {
+        destroy_rows(0, m_size);
+        deallocate_columns(m_cols, m_cap);
+    }
+
+    // 深浅拷贝
+  public:
+    basic_soa_vector(basic_soa_vector &&that) noexcept
+        : m_cols(that.m_cols), m_size(that.m_size), m_cap(that.m_cap),
+          m_alloc(std::move(that.m_alloc)) {
+        that.m_cols = std::tuple<Ts *...>();
+        that.m_size = 0;
+        that.m_cap = 0;
+    }
+
+    basic_soa_vector &operator=(basic_soa_vector &&that) noexcept {
+        if (&that == this) [[unlikely]]
+            return *this;
+
+        destroy_rows(0, m_size);
+        deallocate_columns(m_cols, m_cap);
+        m_cols = that.m_cols;
+        m_size = that.m_size;
+        m_cap = that.m_cap;
+        that.m_cols = std::tuple<Ts *...>();
+        that.m_size = 0;
+        that.m_cap = 0;
+        return *this;
+    }
+
+    basic_soa_vector(const basic_soa_vector &that)
+        : m_cols(), m_size(0), m_cap(0), m_alloc(that.m_alloc) {
+        try {
+            copy_from(that);
+        } catch (...) {
+            // 析构函数不会运行，reserve 分配的块在这里释放
+            deallocate_columns(m_cols, m_cap);
+            throw;
+        }
+    }
+
+    basic_soa_vector &operator=(const basic_soa_vector &that) {
+        if (&that == this) [[unlikely]]
+            return *this;
+
+        clear();
+        copy_from(that);
+        return *this;
+    }
+
+    basic_soa_vector &operator=(std::initializer_list<value_type> ilist) {
+        clear();
+        reserve(ilist.size());
+        for (auto const &val : ilist) {
+            push_back(val);
+        }
+        return *this;
+    }
+
+    void swap(basic_soa_vector &that) noexcept {
+        std::swap(m_cols, that.m_cols);
+        std::swap(m_size, that.m_size);
+        std::swap(m_cap, that.m_cap);
+        std::swap(m_alloc, that.m_alloc);
+    }
+
+  private:
+    // 要求 *this 为空：按列逐个拷贝。某个元素抛出异常时销毁已拷贝的
+    // 各列和当前列已拷贝的行，*this 仍为空
+    void copy_from(const basic_soa_vector &that) {
+        reserve(that.m_size);
+        std::size_t done_cols = 0;
+        std::size_t done_rows = 0;
+        try {
+            for_each_column([&](auto I) {
+                using T = column_type<I>;
+                T *dst = std::get<I>(m_cols);
+                T const *src = std::get<I>(that.m_cols);
+                if constexpr (std::is_trivially_copyable_v<T>) {
+                    if (that.m_size != 0) {
+                        std::memcpy(static_cast<void *>(dst),
+                                    static_cast<void const *>(src),
+                                    that.m_size * sizeof(T));
+                    }
+                } else {
+                    for (done_rows = 0; done_rows < that.m_size;
+                         done_rows++) {
+                        construct_at(&dst[done_rows], src[done_rows]);
+                    }
+                }
+                ++done_cols;
+            });
+        } catch (...) {
+            for_each_column([&](auto I) {
+                using T = column_type<I>;
+                if constexpr (!std::is_trivially_destructible_v<T>) {
+                    std::size_t n = I < done_cols    ? that.m_size
+                                    : I == done_cols ? done_rows
+                                                     : 0;
+                    T *col = std::get<I>(m_cols);
+                    for (std::size_t i = 0; i < n; i++) {
+                        destroy_at(&col[i]);
+                    }
+                }
+            });
+            throw;
+        }
+        m_size = that.m_size;
+    }
+
+    // 内存管理
+  public:
+    void clear() noexcept {
+        destroy_rows(0, m_size);
+        m_size = 0;
+    }
+
+    void reserve(std::size_t n) {
+        if (n <= m_cap)
+            return;
+
+        reallocate_columns(Growth::next_capacity(m_cap, n, row_bytes));
+    }
+
+    void shrink_to_fit() {
+        if (m_size == m_cap)
+            return;
+
+        reallocate_columns(m_size);
+    }
+
+    void resize(std::size_t n) {
+        if (n < m_size) {
+            destroy_rows(n, m_size);
+            m_size = n;
+        } else if (n > m_size) {
+            reserve(n);
+            for (; m_size < n; m_size++) {
+                construct_row(m_size, Index(), Ts()...);
+            }
+        }
+    }
+
+    void resize(std::size_t n, const value_type &default_val) {
+        if (n < m_size) {
+            destroy_rows(n, m_size);
+            m_size = n;
+        } else if (n > m_size) {
+            reserve(n);
+            for (; m_size < n; m_size++) {
+                std::apply(
+                    [&](auto const &...vals) {
+                        construct_row(m_size, Index(), vals...);
+                    },
+                    default_val);
+            }
+        }
+    }
+
+    std::size_t size() const noexcept { return m_size; }
+    std::size_t capacity() const noexcept { return m_cap; }
+    bool empty() const noexcept { return m_size == 0; }
+    static constexpr std::size_t max_size() noexcept {
+        return std::numeric_limits<std::size_t>::max() / row_bytes;
+    }
+    Alloc get_allocator() const noexcept { return Alloc(m_alloc); }
+
+    // 访问
+  public:
+    reference operator[](std::size_t i) noexcept { return row(i, Index()); }
+    const_reference operator[](std::size_t i) const noexcept {
+        return row(i, Index());
+    }
+
+    reference at(std::size_t i) {
+        if (i >= m_size) [[unlikely]]
+            _LIBPENGCXX_THROW_OUT_OF_RANGE(i, m_size);
+        return row(i, Index());
+    }
+    const_reference at(std::size_t i) const {
+        if (i >= m_size) [[unlikely]]
+            _LIBPENGCXX_THROW_OUT_OF_RANGE(i, m_size);
+        return row(i, Index());
+    }
+
+    reference front() noexcept { return row(0, Index()); }
+    const_reference front() const noexcept { return row(0, Index()); }
+
+    reference back() noexcept { return row(m_size - 1, Index()); }
+    const_reference back() const noexcept { return row(m_size - 1, Index()); }
+
+    // 第 I 列的连续视图，扫描单个字段时使用
+    template <std::size_t I> std::span<column_type<I>> column() noexcept {
+        return std::span<column_type<I>>(std::get<I>(m_cols), m_size);
+    }
+    template <std::size_t I>
+    std::span<column_type<I> const> column() const noexcept {
+        return std::span<column_type<I> const>(std::get<I>(m_cols), m_size);
+    }
+
+    template <std::size_t I> column_type<I> *data() noexcept {
+        return std::get<I>(m_cols);
+    }
+    template <std::size_t I> column_type<I> const *data() const noexcept {
+        return std::get<I>(m_cols);
+    }
+
+    iterator begin() noexcept { return iterator(m_cols, 0); }
+    const_iterator begin() const noexcept { return const_iterator(m_cols, 0); }
+    const_iterator cbegin() const noexcept {
+        return const_iterator(m_cols, 0);
+    }
+    iterator end() noexcept { return iterator(m_cols, m_size); }
+    const_iterator end() const noexcept {
+        return const_iterator(m_cols, m_size);
+    }
+    const_iterator cend() const noexcept {
+        return const_iterator(m_cols, m_size);
+    }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+    const_reverse_iterator crbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator crend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    // 数据操作
+  public:
+    void push_back(const value_type &lval) {
+        std::apply([&](auto const &...vals) { emplace_back(vals...); }, lval);
+    }
+
+    void push_back(value_type &&rval) {
+        std::apply([&](auto &&...vals) { emplace_back(std::move(vals)...); },
+                   rval);
+    }
+
+    // 每一列一个参数，分别用于构造该列的元素
+    template <typename... Args> reference emplace_back(Args &&...args) {
+        static_assert(sizeof...(Args) == sizeof...(Ts),
+                      "emplace_back takes one argument per column");
+        if (m_size == m_cap) [[unlikely]]
+            reserve(m_size + 1);
+        construct_row(m_size, Index(), std::forward<Args>(args)...);
+        return row(m_size++, Index());
+    }
+
+    void pop_back() noexcept {
+        destroy_rows(m_size - 1, m_size);
+        --m_size;
+    }
+
+    // 比较函数
+  public:
+    _LIBPENGCXX_DEFINE_COMPARISON(basic_soa_vector);
+};
+
+template <typename... Ts>
+using soa_vector =
+    basic_soa_vector<std::allocator<std::byte>, growth_2x, Ts...>;
+
+} // namespace mstl
+
+#endif // !__SOA_VECTOR__
@@ -0,0 +1,138 @@
+#include "soa_vector.hpp"
+#include <cstdio>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+struct Particle {
+    float x, y;
+};
+
+// 统计存活的实例数
+struct Tracked {
+    static inline int live = 0;
+    Tracked() { ++live; }
+    Tracked(Tracked const &) { ++live; }
+    ~Tracked() { --live; }
+};
+
+struct Picky {
+    int v;
+    Picky(int v) : v(v) {
+        if (v < 0) {
+            throw std::invalid_argument("negative");
+        }
+    }
+};
+
+// 拷贝到第 budget 次时抛异常
+struct Brittle {
+    static inline int budget = -1;
+    static inline int live = 0;
+    Brittle() { ++live; }
+    Brittle(Brittle const &) {
+        if (budget == 0) {
+            throw std::runtime_error("copy failed");
+        }
+        --budget;
+        ++live;
+    }
+    ~Brittle() { --live; }
+};
+
+int main() {
+    mstl::soa_vector<int, double, char> rows;
+    for (int i = 0; i < 6; i++) {
+        rows.emplace_back(i, i * 0.5, char('a' + i));
+        printf("rows.emplace_back(%d) size=%zd cap=%zd\n", i, rows.size(),
+               rows.capacity());
+    }
+    rows.push_back({6, 3.0, 'g'});
+
+    // 结构化绑定得到的是各列元素的引用
+    for (auto [id, w, tag] : rows) {
+        w *= 2;
+        printf("id=%d w=%.1f tag=%c\n", id, w, tag);
+    }
+
+    // 单独扫描一列：连续内存
+    double sum = 0;
+    for (double w : rows.column<1>()) {
+        sum += w;
+    }
+    printf("sum of column 1 = %.1f\n", sum);
+
+    auto ids = rows.column<0>();
+    printf("column<0>: size=%zd ids[3]=%d\n", ids.size(), ids[3]);
+    printf("std::get<2>(rows[4]) = %c\n", std::get<2>(rows[4]));
+    printf("rows.at(2): id=%d\n", std::get<0>(rows.at(2)));
+
+    auto it = rows.begin() + 2;
+    printf("*(begin + 2) id=%d, end - begin = %zd\n", std::get<0>(*it),
+           rows.end() - rows.begin());
+    for (auto rit = rows.rbegin(); rit != rows.rend(); ++rit) {
+        printf("%c ", std::get<2>(*rit));
+    }
+    printf("\n");
+
+    rows.pop_back();
+    rows.shrink_to_fit();
+    printf("after pop_back + shrink_to_fit size=%zd cap=%zd\n", rows.size(),
+           rows.capacity());
+
+    // 非平凡类型的列
+    mstl::soa_vector<std::string, int> names;
+    names.emplace_back("alice", 1);
+    names.emplace_back(std::string(40, 'b'), 2);
+    names.push_back({"carol", 3});
+    auto copy = names;
+    std::get<0>(copy.back()) += "!";
+    for (auto [name, n] : copy) {
+        printf("name=%s n=%d\n", name.c_str(), n);
+    }
+    printf("names == copy: %d\n", names == copy);
+    printf("names < copy: %d\n", names < copy);
+
+    auto moved = std::move(copy);
+    printf("moved.size() = %zd, copy.size() = %zd\n", moved.size(),
+           copy.size());
+
+    mstl::soa_vector<Particle, char> ps(3, {Particle{1, 2}, 'p'});
+    ps.resize(5);
+    for (auto [p, c] : ps) {
+        printf("(%.0f, %.0f) %d\n", p.x, p.y, c);
+    }
+
+    // 某一列构造失败时，该行已构造的列被销毁
+    mstl::soa_vector<Tracked, Picky> tp;
+    tp.emplace_back(Tracked(), 1);
+    try {
+        tp.emplace_back(Tracked(), -1);
+    } catch (std::invalid_argument const &) {
+        printf("emplace_back threw, size=%zd live=%d\n", tp.size(),
+               Tracked::live);
+    }
+
+    // 拷贝到一半抛异常：前面整列拷好的、当前列拷好的行都要销毁
+    mstl::soa_vector<Tracked, Brittle> tb;
+    for (int i = 0; i < 10; i++) {
+        tb.emplace_back(Tracked(), Brittle());
+    }
+    Brittle::budget = 5;
+    mstl::soa_vector<Tracked, Brittle> tb_copy;
+    tb_copy.emplace_back(Tracked(), Brittle());
+    try {
+        tb_copy = tb;
+    } catch (std::runtime_error const &) {
+        printf("copy threw, size=%zd\n", tb_copy.size());
+    }
+    try {
+        mstl::soa_vector<Tracked, Brittle> tb_fresh(tb);
+    } catch (std::runtime_error const &) {
+        Brittle::budget = -1;
+        printf("copy constructor threw\n");
+    }
+    printf("Tracked::live=%d Brittle::live=%d\n", Tracked::live,
+           Brittle::live); // 11 10（tp 里还有一个 Tracked）
+    return 0;
+}
@@ -0,0 +1,418 @@
+#ifndef __STABLE_VECTOR__
+#define __STABLE_VECTOR__
+
+/*
+
+ -- 分段存储的动态数组 --
+
+ 元素存放在固定大小的块（chunk）中，块表记录每个块的地址。
+ 增长时只追加新块，已有元素永远不会被移动：push_back/emplace_back/pop_back
+ 不会使指向其他元素的指针和引用失效，迭代器也保持有效。
+ 下标访问为 O(1)：块大小是 2 的幂，第 i 个元素位于
+ 第 i >> shift 块的第 i & mask 个位置。
+
+*/
+
+#include "_common.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace mstl {
+
+// 默认每块约 4 KiB，至少 16 个元素
+template <typename T>
+inline constexpr std::size_t stable_vector_default_chunk =
+    std::bit_ceil(std::max<std::size_t>(16, 4096 / sizeof(T)));
+
+template <typename T, std::size_t ChunkSize = stable_vector_default_chunk<T>,
+          typename Alloc = std::allocator<T>>
+class stable_vector {
+    static_assert(std::has_single_bit(ChunkSize),
+                  "ChunkSize must be a power of two");
+
+  public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using const_pointer = T const *;
+    using reference = T &;
+    using const_reference = T const &;
+
+    static constexpr std::size_t chunk_size = ChunkSize;
+
+  private:
+    static constexpr std::size_t shift = std::countr_zero(ChunkSize);
+    static constexpr std::size_t mask = ChunkSize - 1;
+
+    using ChunkTable = vector<
+        T *, typename std::allocator_traits<Alloc>::template rebind_alloc<T *>>;
+
+    ChunkTable m_chunks;
+    std::size_t m_size;
+    [[no_unique_address]] Alloc m_alloc;
+
+    template <typename... Args> void construct_at(T *ptr, Args &&...args) {
+#if __cpp_lib_constexpr_dynamic_alloc >= 201907L
+        std::construct_at(ptr, std::forward<Args>(args)...);
+#else
+        new (ptr) T(std::forward<Args>(args)...);
+#endif
+    }
+
+    void destroy_at(T *ptr) noexcept {
+#if __cpp_lib_constexpr_dynamic_alloc >= 201907L
+        std::destroy_at(ptr);
+#else
+        ptr->~T();
+#endif
+    }
+
+    T *slot(std::size_t i) const noexcept {
+        return m_chunks[i >> shift] + (i & mask);
+    }
+
+    // 先为块表留出位置再申请块，块表扩张失败时不会泄漏新块
+    void add_chunk() {
+        m_chunks.reserve(m_chunks.size() + 1);
+        m_chunks.push_back(m_alloc.allocate(ChunkSize));
+    }
+
+    void release_chunks(std::size_t keep) noexcept {
+        while (m_chunks.size() > keep) {
+            m_alloc.deallocate(m_chunks.back(), ChunkSize);
+            m_chunks.pop_back();
+        }
+    }
+
+    // 迭代器只记录容器和下标，块表扩张时依然有效
+  public:
+    template <bool Const> class basic_iterator {
+        using Owner = std::conditional_t<Const, stable_vector const,
+                                         stable_vector>;
+
+        Owner *m_owner;
+        std::size_t m_index;
+
+        friend class stable_vector;
+        template <bool> friend class basic_iterator;
+
+        basic_iterator(Owner *owner, std::size_t index) noexcept
+            : m_owner(owner), m_index(index) {}
+
+      public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, T const *, T *>;
+        using reference = std::conditional_t<Const, T const &, T &>;
+
+        basic_iterator() noexcept : m_owner(nullptr), m_index(0) {}
+
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(basic_iterator<false> const &that) noexcept
+            : m_owner(that.m_owner), m_index(that.m_index) {}
+
+        reference operator*() const noexcept {
+            return *m_owner->slot(m_index);
+        }
+        pointer operator->() const noexcept { return m_owner->slot(m_index); }
+        reference operator[](difference_type n) const noexcept {
+            return *m_owner->slot(m_index + n);
+        }
+
+        basic_iterator &operator++() noexcept {
+            ++m_index;
+            return *this;
+        }
+        basic_iterator &operator--() noexcept {
+            --m_index;
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept {
+            basic_iterator tmp = *this;
+            ++m_index;
+            return tmp;
+        }
+        basic_iterator operator--(int) noexcept {
+            basic_iterator tmp = *this;
+            --m_index;
+            return tmp;
+        }
+
+        basic_iterator &operator+=(difference_type n) noexcept {
+            m_index += n;
+            return *this;
+        }
+        basic_iterator &operator-=(difference_type n) noexcept {
+            m_index -= n;
+            return *this;
+        }
+        basic_iterator operator+(difference_type n) const noexcept {
+            return basic_iterator(m_owner, m_index + n);
+        }
+        friend basic_iterator operator+(difference_type n,
+                                        basic_iterator const &it) noexcept {
+            return it + n;
+        }
+        basic_iterator operator-(difference_type n) const noexcept {
+            return basic_iterator(m_owner, m_index - n);
+        }
+        difference_type operator-(basic_iterator const &that) const noexcept {
+            return difference_type(m_index) - difference_type(that.m_index);
+        }
+
+        bool operator==(basic_iterator const &that) const noexcept {
+            return m_index == that.m_index;
+        }
+        auto operator<=>(basic_iterator const &that) const noexcept {
+            return m_index <=> that.m_index;
+        }
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // 构造函数
+  public:
+    stable_vector() noexcept : m_size(0) {}
+
+    explicit stable_vector(const Alloc &allocator) noexcept
+        : m_size(0), m_alloc(allocator) {}
+
+    explicit stable_vector(std::size_t n, const Alloc &allocator = Alloc())
+        : m_size(0), m_alloc(allocator) {
+        resize(n);
+    }
+
+    stable_vector(std::size_t n, const T &init_val,
+                  const Alloc &allocator = Alloc())
+        : m_size(0), m_alloc(allocator) {
+        resize(n, init_val);
+    }
+
+    stable_vector(std::initializer_list<T> ilist,
+                  const Alloc &allocator = Alloc())
+        : stable_vector(ilist.begin(), ilist.end(), allocator) {}
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     InputIt)>
+    stable_vector(InputIt first, InputIt last,
+                  const Alloc &allocator = Alloc())
+        : m_size(0), m_alloc(allocator) {
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+
+    ~stable_vector() noexcept {
+        clear();
+        release_chunks(0);
+    }
+
+    // 深浅拷贝：块表整体转移，元素不动
+  public:
+    stable_vector(stable_vector &&that) noexcept
+        : m_chunks(std::move(that.m_chunks)), m_size(that.m_size),
+          m_alloc(std::move(that.m_alloc)) {
+        that.m_size = 0;
+    }
+
+    stable_vector &operator=(stable_vector &&that) noexcept {
+        if (&that == this) [[unlikely]]
+            return *this;
+
+        clear();
+        release_chunks(0);
+        m_chunks = std::move(that.m_chunks);
+        m_size = that.m_size;
+        that.m_size = 0;
+        return *this;
+    }
+
+    stable_vector(const stable_vector &that)
+        : m_size(0), m_alloc(that.m_alloc) {
+        reserve(that.m_size);
+        for (std::size_t i = 0; i < that.m_size; i++) {
+            emplace_back(that[i]);
+        }
+    }
+
+    stable_vector &operator=(const stable_vector &that) {
+        if (&that == this) [[unlikely]]
+            return *this;
+
+        clear();
+        reserve(that.m_size);
+        for (std::size_t i = 0; i < that.m_size; i++) {
+            emplace_back(that[i]);
+        }
+        return *this;
+    }
+
+    stable_vector &operator=(std::initializer_list<T> ilist) {
+        clear();
+        for (auto const &val : ilist) {
+            emplace_back(val);
+        }
+        return *this;
+    }
+
+    void swap(stable_vector &that) noexcept {
+        m_chunks.swap(that.m_chunks);
+        std::swap(m_size, that.m_size);
+        std::swap(m_alloc, that.m_alloc);
+    }
+
+    // 内存管理
+  public:
+    void clear() noexcept {
+        for (std::size_t i = 0; i < m_size; i++) {
+            destroy_at(slot(i));
+        }
+        m_size = 0;
+    }
+
+    // 预先分配足够的块，之后的 push_back 不再申请内存
+    void reserve(std::size_t n) {
+        std::size_t need = (n + mask) >> shift;
+        m_chunks.reserve(need);
+        while (m_chunks.size() < need) {
+            add_chunk();
+        }
+    }
+
+    // 释放末尾完全空闲的块
+    void shrink_to_fit() noexcept {
+        release_chunks((m_size + mask) >> shift);
+        m_chunks.shrink_to_fit();
+    }
+
+    void resize(std::size_t n) {
+        if (n < m_size) {
+            for (std::size_t i = n; i < m_size; i++) {
+                destroy_at(slot(i));
+            }
+            m_size = n;
+        } else {
+            reserve(n);
+            while (m_size < n) {
+                emplace_back();
+            }
+        }
+    }
+
+    void resize(std::size_t n, const T &default_val) {
+        if (n < m_size) {
+            for (std::size_t i = n; i < m_size; i++) {
+                destroy_at(slot(i));
+            }
+            m_size = n;
+        } else {
+            reserve(n);
+            while (m_size < n) {
+                emplace_back(default_val);
+            }
+        }
+    }
+
+    std::size_t size() const noexcept { return m_size; }
+    std::size_t capacity() const noexcept {
+        return m_chunks.size() * ChunkSize;
+    }
+    bool empty() const noexcept { return m_size == 0; }
+    static constexpr std::size_t max_size() noexcept {
+        return std::numeric_limits<std::size_t>::max() / sizeof(T);
+    }
+    Alloc get_allocator() const noexcept { return m_alloc; }
+
+    // 访问
+  public:
+    T &operator[](std::size_t i) noexcept { return *slot(i); }
+    const T &operator[](std::size_t i) const noexcept { return *slot(i); }
+
+    T &at(std::size_t i) {
+        if (i >= m_size) [[unlikely]]
+            _LIBPENGCXX_THROW_OUT_OF_RANGE(i, m_size);
+        return *slot(i);
+    }
+    const T &at(std::size_t i) const {
+        if (i >= m_size) [[unlikely]]
+            _LIBPENGCXX_THROW_OUT_OF_RANGE(i, m_size);
+        return *slot(i);
+    }
+
+    T &front() noexcept { return *slot(0); }
+    const T &front() const noexcept { return *slot(0); }
+
+    T &back() noexcept { return *slot(m_size - 1); }
+    const T &back() const noexcept { return *slot(m_size - 1); }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, m_size); }
+    const_iterator end() const noexcept {
+        return const_iterator(this, m_size);
+    }
+    const_iterator cend() const noexcept {
+        return const_iterator(this, m_size);
+    }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+    const_reverse_iterator crbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator crend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    // 数据操作
+  public:
+    void push_back(const T &lval) { emplace_back(lval); }
+
+    void push_back(T &&rval) { emplace_back(std::move(rval)); }
+
+    template <typename... Args> T &emplace_back(Args &&...args) {
+        if ((m_size & mask) == 0 && (m_size >> shift) == m_chunks.size())
+            [[unlikely]] {
+            add_chunk();
+        }
+        T *addr = slot(m_size);
+        construct_at(addr, std::forward<Args>(args)...);
+        ++m_size;
+        return *addr;
+    }
+
+    void pop_back() noexcept {
+        --m_size;
+        destroy_at(slot(m_size));
+    }
+
+    // 比较函数
+  public:
+    _LIBPENGCXX_DEFINE_COMPARISON(stable_vector);
+};
+
+} // namespace mstl
+
+#endif // !__STABLE_VECTOR__
@@ -0,0 +1,47 @@
+#include "stable_vector.hpp"
+#include "vector.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+int main() {
+    mstl::stable_vector<int, 4> arr;
+    arr.push_back(0);
+    int *first = &arr[0];
+    for (int i = 1; i < 10; i++) {
+        arr.push_back(i);
+        printf("arr.push_back(%d) size=%zd cap=%zd\n", i, arr.size(),
+               arr.capacity());
+    }
+    // 增长过程中元素从不移动
+    printf("first still valid: %d\n", first == &arr[0] && *first == 0);
+
+    auto it = arr.begin() + 3;
+    printf("*(begin + 3) = %d, end - begin = %zd\n", *it,
+           arr.end() - arr.begin());
+    printf("it[4] = %d, *(2 + it) = %d\n", it[4], *(2 + it));
+
+    // 迭代器是随机访问迭代器，可以直接用于其他容器的区间构造
+    mstl::vector<int> copy(arr.begin(), arr.end());
+    for (size_t i = 0; i < copy.size(); i++) {
+        printf("copy[%zd] = %d\n", i, copy[i]);
+    }
+    for (auto rit = arr.rbegin(); rit != arr.rend(); ++rit) {
+        printf("%d ", *rit);
+    }
+    printf("\n");
+
+    arr.pop_back();
+    arr.resize(3);
+    arr.shrink_to_fit();
+    printf("after shrink: size=%zd cap=%zd\n", arr.size(), arr.capacity());
+
+    mstl::stable_vector<std::string> strs{"a", "b", "c"};
+    mstl::stable_vector<std::string> other = strs;
+    printf("strs == other: %d\n", strs == other);
+    other.push_back("d");
+    printf("strs < other: %d\n", strs < other);
+    mstl::stable_vector<std::string> moved = std::move(other);
+    printf("moved.size() = %zd, other.size() = %zd\n", moved.size(),
+           other.size());
+}
@@ -0,0 +1,252 @@
+#ifndef __UNORDERED_MAP__
+#define __UNORDERED_MAP__
+
+#include "_common.hpp"
+#include "_hashtable.hpp"
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace mstl {
+
+template <class _Key, class _Mapped, class _Hash = std::hash<_Key>,
+          class _KeyEqual = std::equal_to<_Key>,
+          class _Alloc = std::allocator<std::pair<_Key const, _Mapped>>>
+struct unordered_map
+    : _HashTableImpl<std::pair<_Key const, _Mapped>, _Key, _HashTableSelect1st,
+                     _Hash, _KeyEqual, _Alloc> {
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using value_type = std::pair<_Key const, _Mapped>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = _Hash;
+    using key_equal = _KeyEqual;
+    using allocator_type = _Alloc;
+
+  private:
+    using _Impl = _HashTableImpl<value_type, _Key, _HashTableSelect1st, _Hash,
+                                 _KeyEqual, _Alloc>;
+
+  public:
+    using typename _Impl::iterator;
+    using typename _Impl::const_iterator;
+    using typename _Impl::node_type;
+
+    unordered_map() = default;
+
+    explicit unordered_map(std::size_t __bucket_count,
+                           _Hash __hash = _Hash(),
+                           _KeyEqual __eq = _KeyEqual())
+        : _Impl(__bucket_count, __hash, __eq) {}
+
+    unordered_map(std::initializer_list<value_type> __ilist) {
+        this->reserve(__ilist.size());
+        this->_M_single_insert(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    explicit unordered_map(_InputIt __first, _InputIt __last) {
+        this->_M_single_insert(__first, __last);
+    }
+
+    unordered_map(unordered_map &&) = default;
+    unordered_map &operator=(unordered_map &&) = default;
+    unordered_map(unordered_map const &) = default;
+    unordered_map &operator=(unordered_map const &) = default;
+
+    unordered_map &operator=(std::initializer_list<value_type> __ilist) {
+        this->clear();
+        this->_M_single_insert(__ilist.begin(), __ilist.end());
+        return *this;
+    }
+
+    template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Kv, _Key const &)>
+    iterator find(_Kv &&__key) {
+        return this->_M_find(__key);
+    }
+
+    template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Kv, _Key const &)>
+    const_iterator find(_Kv &&__key) const {
+        return this->_M_find(__key);
+    }
+
+    iterator find(_Key const &__key) { return this->_M_find(__key); }
+
+    const_iterator find(_Key const &__key) const {
+        return this->_M_find(__key);
+    }
+
+    template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Kv, _Key const &)>
+    _Mapped const &at(_Kv const &__key) const {
+        const_iterator __it = this->_M_find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("unordered_map::at");
+        }
+        return __it->second;
+    }
+
+    template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Kv, _Key const &)>
+    _Mapped &at(_Kv const &__key) {
+        iterator __it = this->_M_find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("unordered_map::at");
+        }
+        return __it->second;
+    }
+
+    _Mapped const &at(_Key const &__key) const {
+        const_iterator __it = this->_M_find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("unordered_map::at");
+        }
+        return __it->second;
+    }
+
+    _Mapped &at(_Key const &__key) {
+        iterator __it = this->_M_find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("unordered_map::at");
+        }
+        return __it->second;
+    }
+
+    _Mapped &operator[](_Key const &__key) {
+        return this->try_emplace(__key).first->second;
+    }
+
+    _Mapped &operator[](_Key &&__key) {
+        return this->try_emplace(std::move(__key)).first->second;
+    }
+
+    std::pair<iterator, bool> insert(value_type &&__value) {
+        return this->_M_insert_value(std::move(__value));
+    }
+
+    std::pair<iterator, bool> insert(value_type const &__value) {
+        return this->_M_insert_value(__value);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_single_insert(__first, __last);
+    }
+
+    void insert(std::initializer_list<value_type> __ilist) {
+        this->_M_single_insert(__ilist.begin(), __ilist.end());
+    }
+
+    using _Impl::insert;
+
+    template <class... _Ts>
+    std::pair<iterator, bool> emplace(_Ts &&...__value) {
+        return this->_M_single_emplace(std::forward<_Ts>(__value)...);
+    }
+
+    // 先按键查找，键已存在时不会构造 mapped，参数也不会被移走
+    template <class... _Ms>
+    std::pair<iterator, bool> try_emplace(_Key const &__key,
+                                          _Ms &&...__mapped) {
+        auto [__i, __inserted] = this->_M_find_or_prepare_insert(__key);
+        if (__inserted) {
+            this->_M_construct_at(
+                __i, std::piecewise_construct, std::forward_as_tuple(__key),
+                std::forward_as_tuple(std::forward<_Ms>(__mapped)...));
+        }
+        return {this->_M_iterator_at(__i), __inserted};
+    }
+
+    template <class... _Ms>
+    std::pair<iterator, bool> try_emplace(_Key &&__key, _Ms &&...__mapped) {
+        auto [__i, __inserted] = this->_M_find_or_prepare_insert(__key);
+        if (__inserted) {
+            this->_M_construct_at(
+                __i, std::piecewise_construct,
+                std::forward_as_tuple(std::move(__key)),
+                std::forward_as_tuple(std::forward<_Ms>(__mapped)...));
+        }
+        return {this->_M_iterator_at(__i), __inserted};
+    }
+
+    template <class _Mp,
+              class = std::enable_if_t<std::is_convertible_v<_Mp, _Mapped>>>
+    std::pair<iterator, bool> insert_or_assign(_Key const &__key,
+                                               _Mp &&__mapped) {
+        auto __result = this->try_emplace(__key, std::forward<_Mp>(__mapped));
+        if (!__result.second) {
+            __result.first->second = std::forward<_Mp>(__mapped);
+        }
+        return __result;
+    }
+
+    template <class _Mp,
+              class = std::enable_if_t<std::is_convertible_v<_Mp, _Mapped>>>
+    std::pair<iterator, bool> insert_or_assign(_Key &&__key, _Mp &&__mapped) {
+        auto __result =
+            this->try_emplace(std::move(__key), std::forward<_Mp>(__mapped));
+        if (!__result.second) {
+            __result.first->second = std::forward<_Mp>(__mapped);
+        }
+        return __result;
+    }
+
+    using _Impl::erase;
+
+    template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Kv, _Key const &)>
+    std::size_t erase(_Kv &&__key) {
+        return this->_M_single_erase(__key);
+    }
+
+    std::size_t erase(_Key const &__key) {
+        return this->_M_single_erase(__key);
+    }
+
+    template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Kv, _Key const &)>
+    std::size_t count(_Kv &&__key) const {
+        return this->_M_contains(__key) ? 1 : 0;
+    }
+
+    std::size_t count(_Key const &__key) const {
+        return this->_M_contains(__key) ? 1 : 0;
+    }
+
+    template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Kv, _Key const &)>
+    bool contains(_Kv &&__key) const {
+        return this->_M_contains(__key);
+    }
+
+    bool contains(_Key const &__key) const {
+        return this->_M_contains(__key);
+    }
+
+    using _Impl::extract;
+
+    template <class _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Kv, _Key const &)>
+    node_type extract(_Kv &&__key) {
+        iterator __it = this->_M_find(__key);
+        return __it != this->end() ? this->extract(__it) : node_type();
+    }
+
+    node_type extract(_Key const &__key) {
+        iterator __it = this->_M_find(__key);
+        return __it != this->end() ? this->extract(__it) : node_type();
+    }
+};
+
+} // namespace mstl
+
+#endif // !__UNORDERED_MAP__
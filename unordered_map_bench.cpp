@@ -0,0 +1,59 @@
+#include "map.hpp"
+#include "unordered_map.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+template <typename F> static double measure(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+// 插入 n 个随机键，然后各查找 n 次命中与不命中的键
+template <typename Map>
+static void run(const char *name, std::vector<std::uint64_t> const &keys,
+                std::vector<std::uint64_t> const &misses) {
+    Map m;
+    long sink = 0;
+    double t_insert = measure([&] {
+        for (auto k : keys) {
+            m[k] = long(k);
+        }
+    });
+    double t_hit = measure([&] {
+        for (auto k : keys) {
+            sink += m.find(k)->second;
+        }
+    });
+    double t_miss = measure([&] {
+        for (auto k : misses) {
+            sink += m.find(k) != m.end();
+        }
+    });
+    printf("%-24s insert: %8.2f ms  hit: %8.2f ms  miss: %8.2f ms"
+           "  (sink=%ld)\n",
+           name, t_insert, t_hit, t_miss, sink);
+}
+
+int main() {
+    std::size_t n = 1 << 20;
+    std::mt19937_64 rng(42);
+    std::vector<std::uint64_t> keys(n), misses(n);
+    for (auto &k : keys) {
+        k = rng() | 1;
+    }
+    for (auto &k : misses) {
+        k = rng() & ~std::uint64_t(1);
+    }
+    run<mstl::unordered_map<std::uint64_t, long>>("mstl::unordered_map", keys,
+                                                  misses);
+    run<std::unordered_map<std::uint64_t, long>>("std::unordered_map", keys,
+                                                 misses);
+    run<mstl::map<std::uint64_t, long>>("mstl::map", keys, misses);
+}
@@ -0,0 +1,103 @@
+#include "unordered_map.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// 拷贝到第 budget 次时抛异常
+struct picky_value {
+    static inline int budget = -1;
+    int value;
+
+    picky_value(int __value) : value(__value) {}
+
+    picky_value(picky_value const &that) : value(that.value) {
+        if (budget == 0) {
+            throw std::runtime_error("copy failed");
+        }
+        --budget;
+    }
+};
+
+// 透明哈希：可以直接用 string_view / const char* 查找 std::string 键
+struct string_hash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view sv) const noexcept {
+        return std::hash<std::string_view>()(sv);
+    }
+};
+
+int main() {
+    std::cout << std::boolalpha;
+    mstl::unordered_map<std::string, int> table;
+    table["delay"] = 12;
+    if (!table.contains("delay"))
+        table["delay"] = 32;
+    table["timeout"] = 42;
+    std::cout << "at(delay): " << table.at("delay") << '\n';
+    std::cout << "size: " << table.size() << '\n';
+
+    // try_emplace 键已存在时不构造 mapped
+    std::cout << "try_emplace(delay): "
+              << table.try_emplace("delay", 99).second << '\n';
+    std::cout << "insert_or_assign(delay): "
+              << table.insert_or_assign("delay", 99).second << '\n';
+    std::cout << "at(delay): " << table.at("delay") << '\n';
+
+    mstl::unordered_map<int, int> squares;
+    for (int i = 0; i < 1000; i++) {
+        squares.emplace(i, i * i);
+    }
+    std::cout << "size: " << squares.size()
+              << " bucket_count: " << squares.bucket_count() << '\n';
+    for (int i = 0; i < 1000; i += 2) {
+        squares.erase(i);
+    }
+    long sum = 0;
+    for (auto const &[k, v] : squares) {
+        sum += v;
+    }
+    std::cout << "size after erase: " << squares.size() << " sum: " << sum
+              << '\n';
+    std::cout << "find(998): " << (squares.find(998) != squares.end())
+              << " find(999): " << squares.find(999)->second << '\n';
+
+    // 节点句柄：从一个表取出，放进另一个表
+    mstl::unordered_map<int, int> other;
+    auto nh = squares.extract(999);
+    std::cout << "node: " << nh.key() << " -> " << nh.mapped() << '\n';
+    nh.mapped() = -1;
+    other.insert(std::move(nh));
+    std::cout << "moved: " << squares.contains(999) << ' ' << other.at(999)
+              << " empty handle: " << nh.empty() << '\n';
+
+    mstl::unordered_map<std::string, int, string_hash, std::equal_to<>> env{
+        {"HOME", 1}, {"PATH", 2}, {"SHELL", 3}};
+    std::string_view key = "PATH";
+    std::cout << "env.find(string_view): " << env.find(key)->second << '\n';
+    std::cout << "env.count(\"TERM\"): " << env.count("TERM") << '\n';
+
+    auto copy = env;
+    std::cout << "copy == env: " << (copy == env) << '\n';
+    copy["TERM"] = 4;
+    std::cout << "copy == env: " << (copy == env) << '\n';
+    copy.clear();
+    std::cout << "copy.empty(): " << copy.empty() << '\n';
+
+    // 拷贝到一半抛异常时，已拷贝的元素和表都只释放一次
+    mstl::unordered_map<int, picky_value> picky;
+    for (int i = 0; i < 100; i++) {
+        picky.emplace(i, i);
+    }
+    picky_value::budget = 50;
+    try {
+        auto picky_copy = picky;
+    } catch (std::runtime_error const &) {
+        std::cout << "copy threw\n";
+    }
+    picky_value::budget = -1;
+    std::cout << "picky.size(): " << picky.size() << '\n';
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+#ifndef __UNORDERED_SET__
+#define __UNORDERED_SET__
+
+#include "_common.hpp"
+#include "_hashtable.hpp"
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+namespace mstl {
+
+template <class _Tp, class _Hash = std::hash<_Tp>,
+          class _KeyEqual = std::equal_to<_Tp>,
+          class _Alloc = std::allocator<_Tp>>
+struct unordered_set
+    : _HashTableImpl<_Tp, _Tp, _HashTableIdentity, _Hash, _KeyEqual, _Alloc> {
+  private:
+    using _Impl =
+        _HashTableImpl<_Tp, _Tp, _HashTableIdentity, _Hash, _KeyEqual, _Alloc>;
+
+  public:
+    using typename _Impl::const_iterator;
+    using typename _Impl::node_type;
+    using iterator = const_iterator;
+    using key_type = _Tp;
+    using value_type = _Tp;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = _Hash;
+    using key_equal = _KeyEqual;
+    using allocator_type = _Alloc;
+
+    unordered_set() = default;
+
+    explicit unordered_set(std::size_t __bucket_count,
+                           _Hash __hash = _Hash(),
+                           _KeyEqual __eq = _KeyEqual())
+        : _Impl(__bucket_count, __hash, __eq) {}
+
+    unordered_set(std::initializer_list<_Tp> __ilist) {
+        this->reserve(__ilist.size());
+        this->_M_single_insert(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    explicit unordered_set(_InputIt __first, _InputIt __last) {
+        this->_M_single_insert(__first, __last);
+    }
+
+    unordered_set(unordered_set &&) = default;
+    unordered_set &operator=(unordered_set &&) = default;
+    unordered_set(unordered_set const &) = default;
+    unordered_set &operator=(unordered_set const &) = default;
+
+    unordered_set &operator=(std::initializer_list<_Tp> __ilist) {
+        this->clear();
+        this->_M_single_insert(__ilist.begin(), __ilist.end());
+        return *this;
+    }
+
+    // 集合的元素不可修改，begin/end 统一返回 const_iterator
+    const_iterator begin() const noexcept { return _Impl::begin(); }
+
+    const_iterator end() const noexcept { return _Impl::end(); }
+
+    template <class _Tv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Tv, _Tp const &)>
+    const_iterator find(_Tv &&__value) const {
+        return this->_M_find(__value);
+    }
+
+    const_iterator find(_Tp const &__value) const {
+        return this->_M_find(__value);
+    }
+
+    std::pair<iterator, bool> insert(_Tp &&__value) {
+        return this->_M_insert_value(std::move(__value));
+    }
+
+    std::pair<iterator, bool> insert(_Tp const &__value) {
+        return this->_M_insert_value(__value);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_single_insert(__first, __last);
+    }
+
+    void insert(std::initializer_list<_Tp> __ilist) {
+        this->_M_single_insert(__ilist.begin(), __ilist.end());
+    }
+
+    std::pair<iterator, bool> insert(node_type __nh) {
+        return _Impl::insert(std::move(__nh));
+    }
+
+    template <class... _Ts>
+    std::pair<iterator, bool> emplace(_Ts &&...__value) {
+        return this->_M_single_emplace(std::forward<_Ts>(__value)...);
+    }
+
+    using _Impl::erase;
+
+    template <class _Tv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Tv, _Tp const &)>
+    std::size_t erase(_Tv &&__value) {
+        return this->_M_single_erase(__value);
+    }
+
+    std::size_t erase(_Tp const &__value) {
+        return this->_M_single_erase(__value);
+    }
+
+    template <class _Tv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Tv, _Tp const &)>
+    std::size_t count(_Tv &&__value) const {
+        return this->_M_contains(__value) ? 1 : 0;
+    }
+
+    std::size_t count(_Tp const &__value) const {
+        return this->_M_contains(__value) ? 1 : 0;
+    }
+
+    template <class _Tv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Tv, _Tp const &)>
+    bool contains(_Tv &&__value) const {
+        return this->_M_contains(__value);
+    }
+
+    bool contains(_Tp const &__value) const {
+        return this->_M_contains(__value);
+    }
+
+    using _Impl::extract;
+
+    template <class _Tv, _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(
+                             _Hash, _KeyEqual, _Tv, _Tp const &)>
+    node_type extract(_Tv &&__value) {
+        const_iterator __it = this->_M_find(__value);
+        return __it != this->end() ? this->extract(__it) : node_type();
+    }
+
+    node_type extract(_Tp const &__value) {
+        const_iterator __it = this->_M_find(__value);
+        return __it != this->end() ? this->extract(__it) : node_type();
+    }
+};
+
+} // namespace mstl
+
+#endif // !__UNORDERED_SET__
@@ -0,0 +1,87 @@
+#include "unordered_set.hpp"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+// 计数用完后抛出异常的哈希函数
+struct flaky_hash {
+    static inline int budget = -1;
+
+    std::size_t operator()(std::string const &str) const {
+        if (budget == 0) {
+            throw std::runtime_error("hash failed");
+        }
+        --budget;
+        return std::hash<std::string>()(str);
+    }
+};
+
+int main() {
+    mstl::unordered_set<int> s;
+    s.insert(1);
+    s.insert(3);
+    s.insert(5);
+    s.insert(4);
+    printf("insert 4 = %d\n", s.insert(4).second); // 0
+    printf("insert 6 = %d\n", s.insert(6).second); // 1
+    printf("find 3 = %d\n", s.find(3) != s.end()); // 1
+    printf("find 2 = %d\n", s.find(2) != s.end()); // 0
+    s.erase(3);
+    printf("find 3 = %d\n", s.find(3) != s.end()); // 0
+    printf("size = %zd\n", s.size());              // 4
+
+    // 大量插入删除，覆盖 rehash 和墓碑复用
+    mstl::unordered_set<long> big;
+    for (long i = 0; i < 100000; i++) {
+        big.insert(i * 7919);
+    }
+    for (long i = 0; i < 100000; i += 3) {
+        big.erase(i * 7919);
+    }
+    long found = 0;
+    for (long i = 0; i < 100000; i++) {
+        found += big.contains(i * 7919);
+    }
+    printf("big.size() = %zd, found = %ld\n", big.size(), found);
+
+    mstl::unordered_set<std::string> words{"alpha", "beta", "gamma"};
+    words.emplace("delta");
+    words.emplace(5, 'x');
+    auto nh = words.extract("beta");
+    nh.value() = "BETA";
+    words.insert(std::move(nh));
+    size_t total = 0;
+    for (auto const &w : words) {
+        total += w.size();
+    }
+    printf("words.size() = %zd, total length = %zd, has BETA = %d\n",
+           words.size(), total, words.contains("BETA"));
+
+    words.reserve(1000);
+    printf("after reserve: bucket_count = %zd, size = %zd\n",
+           words.bucket_count(), words.size());
+    words.rehash(0);
+    printf("after rehash(0): bucket_count = %zd, has gamma = %d\n",
+           words.bucket_count(), words.contains("gamma"));
+
+    // rehash 中途哈希失败，表保持原样
+    mstl::unordered_set<std::string, flaky_hash> flaky;
+    for (int i = 0; i < 100; i++) {
+        flaky.insert(std::to_string(i) + std::string(20, '#'));
+    }
+    size_t buckets = flaky.bucket_count();
+    flaky_hash::budget = 50;
+    try {
+        flaky.reserve(1000);
+    } catch (std::runtime_error const &) {
+        printf("reserve threw\n");
+    }
+    flaky_hash::budget = -1;
+    size_t kept = 0;
+    for (int i = 0; i < 100; i++) {
+        kept += flaky.contains(std::to_string(i) + std::string(20, '#'));
+    }
+    printf("flaky: size = %zd, kept = %zd, same buckets = %d\n",
+           flaky.size(), kept, flaky.bucket_count() == buckets);
+    return 0;
+}
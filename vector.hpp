@@ -2,6 +2,8 @@
 #define __VECTOR__
 
 #include "_common.hpp"
+#include "_growth.hpp"
+#include "_relocate.hpp"
 #include <cstddef>
 #include <initializer_list>
 #include <iterator>
@@ -12,10 +14,21 @@
 
 namespace mstl {
 
-template <typename T, typename Alloc = std::allocator<T>> class vector {
+// 默认初始化标签：元素只做默认初始化，平凡类型的内容保持未初始化
+struct default_init_t {
+    explicit default_init_t() = default;
+};
+
+inline constexpr default_init_t default_init{};
+
+// Growth 为扩容策略，见 _growth.hpp
+template <typename T, typename Alloc = std::allocator<T>,
+          typename Growth = growth_2x>
+class vector {
   public:
     using value_type = T;
     using allocator_type = Alloc;
+    using growth_policy = Growth;
     using size_type = std::size_t;
     using diff_type = std::ptrdiff_t;
     using ptr = T *;
@@ -33,6 +46,10 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
     std::size_t m_cap;
     [[no_unique_address]] Alloc m_alloc;
 
+    // 分配器支持按字节重新分配（如 mremap）时，扩容/收缩不再逐个搬迁
+    static constexpr bool use_reallocate =
+        is_trivially_relocatable_v<T> && allocator_has_reallocate_v<Alloc>;
+
     template <typename... Args> void construct_at(T *ptr, Args &&...args) {
 #if __cpp_lib_constexpr_dynamic_alloc >= 201907L
         std::construct_at(ptr, std::forward<Args>(args)...);
@@ -49,6 +66,26 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
 #endif
     }
 
+    void default_init_n(T *ptr, size_t n) {
+        if constexpr (!std::is_trivially_default_constructible_v<T>) {
+            for (size_t i = 0; i < n; i++) {
+                new (&ptr[i]) T;
+            }
+        }
+    }
+
+    // 把 [j, m_size) 整体后移 n 位，为插入腾出 [j, j + n) 的未初始化空间
+    void open_gap(size_t j, size_t n) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            trivially_relocate(m_data + j, m_data + m_size, m_data + j + n);
+        } else {
+            for (size_t i = m_size; i > j; i--) {
+                construct_at(&m_data[i + n - 1], std::move(m_data[i - 1]));
+                destroy_at(&m_data[i - 1]);
+            }
+        }
+    }
+
     // 构造函数
   public:
     vector() noexcept {
@@ -78,6 +115,13 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
         }
     }
 
+    vector(std::size_t n, default_init_t, const Alloc &allocator = Alloc())
+        : m_alloc(allocator) {
+        m_data = m_alloc.allocate(n);
+        m_cap = m_size = n;
+        default_init_n(m_data, n);
+    }
+
     template <
         _LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::random_access_iterator, It)>
     vector(It first, It last, const Alloc &allocator = Alloc())
@@ -222,21 +266,71 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
         m_size = n;
     }
 
-    void shrink_to_fit() noexcept {
-        auto old_data = m_data;
-        auto old_cap = m_cap;
-        m_cap = m_size;
-        if (m_size == 0) {
-            m_data = nullptr;
-        } else {
-            m_data = m_alloc.allocate(m_size);
+    // 与 resize 相同，但新增元素只做默认初始化：
+    // 适合随后立即被 read() 或解码器整体覆盖的 char/float 缓冲区
+    void resize_for_overwrite(size_t n) {
+        if (n < m_size) {
+            for (size_t i = n; i < m_size; i++) {
+                destroy_at(&m_data[i]);
+            }
+        } else if (n > m_size) {
+            reserve(n);
+            default_init_n(m_data + m_size, n - m_size);
         }
-        if (old_cap != 0) [[likely]] {
-            for (std::size_t i = 0; i != m_size; i++) {
-                construct_at(&m_data[i], std::move_if_noexcept(old_data[i]));
-                destroy_at(&old_data[i]);
+        m_size = n;
+    }
+
+    // 在末尾追加 n 个默认初始化的元素，返回指向第一个新元素的指针
+    T *append_for_overwrite(size_t n) {
+        size_t old_size = m_size;
+        if (m_size + n > m_cap)
+            reserve(m_size + n);
+        default_init_n(m_data + m_size, n);
+        m_size += n;
+        return m_data + old_size;
+    }
+
+    // 收缩只是请求：分配失败或元素拷贝抛出异常时保留原来的缓冲区
+    void shrink_to_fit() noexcept {
+        if (m_size == m_cap)
+            return;
+
+        try {
+            if constexpr (use_reallocate) {
+                if (m_size != 0) {
+                    m_data = m_alloc.reallocate(m_data, m_cap, m_size, m_size);
+                    m_cap = m_size;
+                    return;
+                }
             }
-            m_alloc.deallocate(old_data, old_cap);
+            T *new_data = nullptr;
+            if (m_size != 0) {
+                new_data = m_alloc.allocate(m_size);
+            }
+            if constexpr (is_trivially_relocatable_v<T>) {
+                trivially_relocate(m_data, m_data + m_size, new_data);
+            } else {
+                std::size_t built = 0;
+                try {
+                    for (; built != m_size; built++) {
+                        construct_at(&new_data[built],
+                                     std::move_if_noexcept(m_data[built]));
+                    }
+                } catch (...) {
+                    for (std::size_t i = 0; i != built; i++) {
+                        destroy_at(&new_data[i]);
+                    }
+                    m_alloc.deallocate(new_data, m_size);
+                    throw;
+                }
+                for (std::size_t i = 0; i != m_size; i++) {
+                    destroy_at(&m_data[i]);
+                }
+            }
+            m_alloc.deallocate(m_data, m_cap);
+            m_data = new_data;
+            m_cap = m_size;
+        } catch (...) {
         }
     }
 
@@ -244,7 +338,15 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
         if (n <= m_cap)
             return;
 
-        n = std::max(n, m_cap * 2);
+        n = Growth::next_capacity(m_cap, n, sizeof(T));
+
+        if constexpr (use_reallocate) {
+            if (m_cap != 0) {
+                m_data = m_alloc.reallocate(m_data, m_cap, n, m_size);
+                m_cap = n;
+                return;
+            }
+        }
 
         auto old_data = m_data;
         auto old_cap = m_cap;
@@ -258,11 +360,16 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
         }
 
         if (old_cap != 0) {
-            for (size_t i = 0; i < m_size; i++) {
-                construct_at(&m_data[i], std::move_if_noexcept(old_data[i]));
-            }
-            for (size_t i = 0; i < m_size; i++) {
-                destroy_at(&old_data[i]);
+            if constexpr (is_trivially_relocatable_v<T>) {
+                trivially_relocate(old_data, old_data + m_size, m_data);
+            } else {
+                for (size_t i = 0; i < m_size; i++) {
+                    construct_at(&m_data[i],
+                                 std::move_if_noexcept(old_data[i]));
+                }
+                for (size_t i = 0; i < m_size; i++) {
+                    destroy_at(&old_data[i]);
+                }
             }
             m_alloc.deallocate(old_data, old_cap);
         }
@@ -361,10 +468,7 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
     template <typename... Args> T *emplace(const T *it, Args &&...args) {
         size_t j = it - m_data;
         reserve(m_size + 1);
-        for (size_t i = m_size; i > j; i--) {
-            construct_at(&m_data[i], std::move(m_data[i - 1]));
-            destroy_at(&m_data[i - 1]);
-        }
+        open_gap(j, 1);
         ++m_size;
         construct_at(&m_data[j], std::forward<Args>(args)...);
         return m_data + j;
@@ -373,10 +477,7 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
     T *insert(const T *it, T &&val) {
         size_t j = it - m_data;
         reserve(m_size + 1);
-        for (size_t i = m_size; i > j; i--) {
-            construct_at(&m_data[i], std::move(m_data[i - 1]));
-            destroy_at(&m_data[i - 1]);
-        }
+        open_gap(j, 1);
         ++m_size;
         construct_at(&m_data[j], std::move(val));
         return m_data + j;
@@ -387,10 +488,7 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
         if (n == 0) [[unlikely]]
             return const_cast<T *>(it);
         reserve(m_size + n);
-        for (size_t i = m_size; i > j; i--) {
-            construct_at(&m_data[i + n - 1], std::move(m_data[i - 1]));
-            destroy_at(&m_data[i - 1]);
-        }
+        open_gap(j, n);
         m_size += n;
         for (size_t i = j; i < j + n; i++) {
             construct_at(&m_data[i], val);
@@ -406,10 +504,7 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
         if (n == 0) [[unlikely]]
             return const_cast<T *>(it);
         reserve(m_size + n);
-        for (size_t i = m_size; i > j; i--) {
-            construct_at(&m_data[i + n - 1], std::move(m_data[i - 1]));
-            destroy_at(&m_data[i - 1]);
-        }
+        open_gap(j, n);
         m_size += n;
         for (size_t i = j; i < j + n; i++) {
             construct_at(&m_data[i], *first);
@@ -427,28 +522,121 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
         destroy_at(&m_data[m_size]);
     }
 
-    T *erase(const T *it) noexcept(std::is_nothrow_move_assignable_v<T>) {
+    T *erase(const T *it) noexcept(is_trivially_relocatable_v<T> ||
+                                   std::is_nothrow_move_assignable_v<T>) {
         size_t i = it - m_data;
-        for (size_t j = i + 1; j < m_size; j++) {
-            m_data[j - 1] = std::move(m_data[j]);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            destroy_at(&m_data[i]);
+            trivially_relocate(m_data + i + 1, m_data + m_size, m_data + i);
+            --m_size;
+        } else {
+            for (size_t j = i + 1; j < m_size; j++) {
+                m_data[j - 1] = std::move(m_data[j]);
+            }
+            --m_size;
+            destroy_at(&m_data[m_size]);
         }
-        --m_size;
-        destroy_at(&m_data[m_size]);
         return const_cast<T *>(it);
     }
 
-    T *erase(T *first, T *last) noexcept(std::is_nothrow_move_assignable_v<T>) {
-        size_t diff = last - first;
-        for (size_t j = last - m_data; j < m_size; j++) {
-            m_data[j - diff] = std::move(m_data[j]);
+    T *erase(T *first, T *last) noexcept(is_trivially_relocatable_v<T> ||
+                                         std::is_nothrow_move_assignable_v<T>) {
+        if (first == last) {
+            return first;
         }
-        m_size -= diff;
-        for (size_t j = m_size; j < m_size + diff; j++) {
-            destroy_at(&m_data[j]);
+        size_t diff = last - first;
+        if constexpr (is_trivially_relocatable_v<T>) {
+            for (T *p = first; p != last; ++p) {
+                destroy_at(p);
+            }
+            trivially_relocate(last, m_data + m_size, first);
+            m_size -= diff;
+        } else {
+            for (size_t j = last - m_data; j < m_size; j++) {
+                m_data[j - diff] = std::move(m_data[j]);
+            }
+            m_size -= diff;
+            for (size_t j = m_size; j < m_size + diff; j++) {
+                destroy_at(&m_data[j]);
+            }
         }
         return const_cast<T *>(first);
     }
 
+    // 用最后一个元素填补被删除的位置，O(1)，但不保持元素顺序
+    T *unstable_erase(const T *it) noexcept(
+        is_trivially_relocatable_v<T> || std::is_nothrow_move_assignable_v<T>) {
+        T *pos = const_cast<T *>(it);
+        T *last = m_data + m_size - 1;
+        if constexpr (is_trivially_relocatable_v<T>) {
+            destroy_at(pos);
+            if (pos != last) {
+                trivially_relocate(last, last + 1, pos);
+            }
+        } else {
+            if (pos != last) {
+                *pos = std::move(*last);
+            }
+            destroy_at(last);
+        }
+        --m_size;
+        return pos;
+    }
+
+    // 同 unstable_erase，但把被删除的元素返回给调用者
+    T swap_remove(size_t i) {
+        T val = std::move(m_data[i]);
+        unstable_erase(m_data + i);
+        return val;
+    }
+
+    // 单趟删除所有满足 pred 的元素并压实，返回删除的个数，
+    // 每个元素只调用一次 pred。
+    // 可平凡搬迁类型按连续的保留段整段 memmove，否则逐个移动赋值
+    template <typename Pred> size_t erase_if(Pred pred) {
+        size_t old_size = m_size;
+        if constexpr (is_trivially_relocatable_v<T>) {
+            T *last = m_data + m_size;
+            T *out = m_data;
+            T *p = m_data;
+            T *run = p;
+            try {
+                while (true) {
+                    run = p;
+                    while (p != last && !pred(std::as_const(*p))) {
+                        ++p;
+                    }
+                    out = trivially_relocate(run, p, out);
+                    if (p == last)
+                        break;
+                    destroy_at(p);
+                    ++p;
+                }
+            } catch (...) {
+                // pred 抛出异常时 [run, last) 仍然完好，接回已压实的部分之后
+                out = trivially_relocate(run, last, out);
+                m_size = out - m_data;
+                throw;
+            }
+            m_size = out - m_data;
+        } else {
+            size_t w = 0;
+            for (size_t r = 0; r < m_size; r++) {
+                if (!pred(std::as_const(m_data[r]))) {
+                    if (w != r) {
+                        m_data[w] = std::move(m_data[r]);
+                    }
+                    ++w;
+                }
+            }
+            for (size_t j = w; j < m_size; j++) {
+                destroy_at(&m_data[j]);
+            }
+            m_size = w;
+        }
+        return old_size - m_size;
+    }
+
     // 内存分配
   public:
     void assign(size_t n, const T &default_val) {
@@ -487,6 +675,28 @@ template <typename T, typename Alloc = std::allocator<T>> class vector {
     _LIBPENGCXX_DEFINE_COMPARISON(vector);
 };
 
+template <typename T, typename Alloc = std::allocator<T>,
+          typename Growth = growth_2x>
+vector<T, Alloc, Growth> make_vector_for_overwrite(std::size_t n) {
+    return vector<T, Alloc, Growth>(n, default_init);
+}
+
+// 与 C++20 的 std::erase_if / std::erase 相同，返回删除的元素个数
+template <typename T, typename Alloc, typename Growth, typename Pred>
+std::size_t erase_if(vector<T, Alloc, Growth> &vec, Pred pred) {
+    return vec.erase_if(std::move(pred));
+}
+
+template <typename T, typename Alloc, typename Growth, typename U>
+std::size_t erase(vector<T, Alloc, Growth> &vec, const U &value) {
+    return vec.erase_if([&](const T &elem) { return elem == value; });
+}
+
+// vector 只持有指向堆内存的指针，按字节搬迁是安全的
+template <typename T, typename Growth>
+struct is_trivially_relocatable<vector<T, std::allocator<T>, Growth>>
+    : std::true_type {};
+
 } // namespace mstl
 
 #endif // !__VECTOR__
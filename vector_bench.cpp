@@ -0,0 +1,108 @@
+#include "vector.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+// 两个布局完全相同、行为类似 unique_ptr 的类型：移动时把源对象置空，
+// 析构时检查并释放。区别只在于 Fast 通过特化 is_trivially_relocatable
+// 选择加入了 memmove 路径
+
+struct Slow {
+    long a;
+    long *p;
+
+    Slow(long v) noexcept : a(v), p(nullptr) {}
+    Slow(Slow &&that) noexcept : a(that.a), p(that.p) { that.p = nullptr; }
+    Slow &operator=(Slow &&that) noexcept {
+        if (this != &that) {
+            delete p;
+            a = that.a;
+            p = that.p;
+            that.p = nullptr;
+        }
+        return *this;
+    }
+    ~Slow() noexcept { delete p; }
+};
+
+struct Fast : Slow {
+    using Slow::Slow;
+};
+
+template <> struct mstl::is_trivially_relocatable<Fast> : std::true_type {};
+
+template <typename F> static double measure(F &&f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+template <typename T> static long bench_push_back(std::size_t n) {
+    mstl::vector<T> v;
+    for (std::size_t i = 0; i < n; i++) {
+        v.push_back(T(i));
+    }
+    return v.back().a;
+}
+
+template <typename T>
+static long bench_insert_middle(std::size_t n, std::size_t times) {
+    mstl::vector<T> v;
+    v.reserve(n + times);
+    for (std::size_t i = 0; i < n; i++) {
+        v.push_back(T(i));
+    }
+    for (std::size_t i = 0; i < times; i++) {
+        v.insert(v.begin() + v.size() / 2, T(i));
+    }
+    for (std::size_t i = 0; i < times; i++) {
+        v.erase(v.begin() + v.size() / 2);
+    }
+    return v[v.size() / 2].a;
+}
+
+// 删除约一半的元素：逐个 erase 为 O(n^2)，erase_if 为单趟 O(n)
+template <typename T> static long bench_erase_loop(std::size_t n) {
+    mstl::vector<T> v;
+    for (std::size_t i = 0; i < n; i++) {
+        v.push_back(T(i));
+    }
+    for (std::size_t i = 0; i < v.size();) {
+        if (v[i].a % 2 == 0) {
+            v.erase(v.begin() + i);
+        } else {
+            i++;
+        }
+    }
+    return v.size();
+}
+
+template <typename T> static long bench_erase_if(std::size_t n) {
+    mstl::vector<T> v;
+    for (std::size_t i = 0; i < n; i++) {
+        v.push_back(T(i));
+    }
+    mstl::erase_if(v, [](T const &x) { return x.a % 2 == 0; });
+    return v.size();
+}
+
+template <typename T> static void run(const char *name) {
+    long sink = 0;
+    double t_push = measure([&] { sink += bench_push_back<T>(1 << 24); });
+    double t_insert =
+        measure([&] { sink += bench_insert_middle<T>(1 << 20, 200); });
+    printf("%-6s push_back x16M: %8.2f ms  insert/erase middle x200: %8.2f ms"
+           "  (sink=%ld)\n",
+           name, t_push, t_insert, sink);
+    double t_loop = measure([&] { sink += bench_erase_loop<T>(1 << 16); });
+    double t_if = measure([&] { sink += bench_erase_if<T>(1 << 16); });
+    printf("%-6s erase loop x64K: %8.2f ms  erase_if x64K: %8.2f ms"
+           "  (sink=%ld)\n",
+           name, t_loop, t_if, sink);
+}
+
+int main() {
+    run<Slow>("Slow");
+    run<Fast>("Fast");
+}
@@ -0,0 +1,55 @@
+#include "vector.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// 每个策略在单独的子进程中运行，峰值 RSS 由 wait4 取得，互不干扰
+
+template <typename Growth> static void workload(const char *name) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    // 一个大数组一直增长
+    mstl::vector<long, std::allocator<long>, Growth> big;
+    for (long i = 0; i < 25000000; i++) {
+        big.push_back(i);
+    }
+
+    // 大量中小数组交替增长
+    mstl::vector<mstl::vector<int, std::allocator<int>, Growth>> smalls(4096);
+    for (int round = 0; round < 600; round++) {
+        for (auto &v : smalls) {
+            v.push_back(round);
+        }
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    printf("%-22s %8.2f ms  big.cap=%-9zd small.cap=%-5zd", name, ms,
+           big.capacity(), smalls[0].capacity());
+    fflush(stdout);
+}
+
+template <typename Growth> static void run(const char *name) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        workload<Growth>(name);
+        _exit(0);
+    }
+    int status;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    printf("  peak RSS: %6ld MiB\n", usage.ru_maxrss / 1024);
+}
+
+int main() {
+    run<mstl::growth_2x>("growth_2x");
+    run<mstl::growth_1_5x>("growth_1_5x");
+    run<mstl::growth_size_class<mstl::growth_2x>>("size_class<2x>");
+    run<mstl::growth_size_class<mstl::growth_1_5x>>("size_class<1.5x>");
+    run<mstl::growth_page_aligned<mstl::growth_1_5x>>("page_aligned<1.5x>");
+}
@@ -2,6 +2,29 @@
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+
+// 打开 fail 之后每次分配都抛 bad_alloc
+template <typename T> struct failing_alloc {
+    using value_type = T;
+    static inline bool fail = false;
+
+    failing_alloc() = default;
+    template <typename U> failing_alloc(failing_alloc<U> const &) {}
+
+    T *allocate(std::size_t n) {
+        if (fail) {
+            throw std::bad_alloc();
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) {
+        std::allocator<T>().deallocate(p, n);
+    }
+};
 
 int main() {
     mstl::vector<int> arr; // data size cap
@@ -32,4 +55,80 @@ int main() {
     printf("arr.size() = %zd\n", arr.size());
     printf("bar.size() = %zd\n", bar.size());
     printf("sizeof(Vector) = %zd\n", sizeof(mstl::vector<int>));
+
+    // 可平凡搬迁类型走 memmove 路径，非平凡类型走逐元素移动
+    bar.erase(bar.begin() + 1, bar.begin() + 4);
+    bar.erase(bar.begin());
+    bar.insert(bar.begin() + 2, 3, -1);
+    for (size_t i = 0; i < bar.size(); i++) {
+        printf("bar[%zd] = %d\n", i, bar[i]);
+    }
+
+    mstl::vector<std::unique_ptr<int>> ptrs;
+    for (int i = 0; i < 10; i++) {
+        ptrs.push_back(std::make_unique<int>(i));
+    }
+    ptrs.emplace(ptrs.begin(), std::make_unique<int>(-1));
+    ptrs.erase(ptrs.begin() + 5);
+    ptrs.shrink_to_fit();
+    for (size_t i = 0; i < ptrs.size(); i++) {
+        printf("*ptrs[%zd] = %d\n", i, *ptrs[i]);
+    }
+
+    mstl::vector<std::string> strs{"a", "b", "c", "d"};
+    strs.insert(strs.begin() + 1, std::string("x"));
+    strs.erase(strs.begin() + 3);
+    strs.emplace_back(32, 'c');
+    strs.erase(strs.begin(), strs.begin());
+    for (size_t i = 0; i < strs.size(); i++) {
+        printf("strs[%zd] = %s\n", i, strs[i].c_str());
+    }
+
+    // 默认初始化：新增元素不清零，由调用者立即覆盖
+    auto buf = mstl::make_vector_for_overwrite<char>(4);
+    memcpy(buf.data(), "abcd", 4);
+    memcpy(buf.append_for_overwrite(3), "efg", 3);
+    buf.resize_for_overwrite(buf.size() + 1);
+    buf.back() = '\0';
+    printf("buf = %s, size = %zd\n", buf.data(), buf.size());
+    strs.resize_for_overwrite(5);
+    printf("strs.back().empty() = %d\n", strs.back().empty());
+    // 批量删除：单趟压实，返回删除个数
+    mstl::vector<int> nums{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    size_t removed = mstl::erase_if(nums, [](int x) { return x % 3 == 0; });
+    printf("erase_if removed %zd, size = %zd:", removed, nums.size());
+    for (size_t i = 0; i < nums.size(); i++) {
+        printf(" %d", nums[i]);
+    }
+    printf("\n");
+    printf("erase(nums, 5) = %zd\n", mstl::erase(nums, 5));
+
+    // 不保持顺序的 O(1) 删除：最后一个元素补到被删除的位置
+    nums.unstable_erase(nums.begin());
+    int taken = nums.swap_remove(1);
+    printf("swap_remove(1) = %d, nums:", taken);
+    for (size_t i = 0; i < nums.size(); i++) {
+        printf(" %d", nums[i]);
+    }
+    printf("\n");
+
+    mstl::erase_if(strs, [](const std::string &s) { return s.empty(); });
+    mstl::erase_if(ptrs, [](const std::unique_ptr<int> &p) { return *p & 1; });
+    strs.unstable_erase(strs.begin());
+    printf("strs.size() = %zd, ptrs.size() = %zd, *ptrs.back() = %d\n",
+           strs.size(), ptrs.size(), *ptrs.back());
+
+    // 收缩时分配失败：保留原来的缓冲区，元素不动
+    mstl::vector<std::string, failing_alloc<std::string>> names;
+    for (int i = 0; i < 5; i++) {
+        names.push_back(std::to_string(i));
+    }
+    size_t cap = names.capacity();
+    failing_alloc<std::string>::fail = true;
+    names.shrink_to_fit();
+    failing_alloc<std::string>::fail = false;
+    printf("after failed shrink: size = %zd, same cap = %d, back = %s\n",
+           names.size(), names.capacity() == cap, names.back().c_str());
+    names.shrink_to_fit();
+    printf("after shrink: cap = %zd\n", names.capacity()); // 5
 }